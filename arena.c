@@ -0,0 +1,49 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "arena.h"
+
+
+size_t ms_ArenaAlignUp(size_t size) {
+    return (size + MS_ARENA_ALIGN - 1) & ~(size_t)(MS_ARENA_ALIGN - 1);
+}
+
+/*Makes sure the arena can hold `size` bytes and empties it.
+ * The block is only reallocated when it has to grow.*/
+bool ms_ArenaReserve(ms_Arena *arena, size_t size) {
+    size = ms_ArenaAlignUp(size);
+    if (size > arena->cap) {
+        free(arena->base);
+        arena->base = aligned_alloc(MS_ARENA_ALIGN, size);
+        if (!arena->base) {
+            arena->cap = 0;
+            arena->used = 0;
+            return false;
+        }
+        arena->cap = size;
+    }
+    arena->used = 0;
+    return true;
+}
+
+/*Returns NULL if the reserved block is exhausted.*/
+void *ms_ArenaAlloc(ms_Arena *arena, size_t size) {
+    size = ms_ArenaAlignUp(size);
+    if (size > arena->cap - arena->used) {
+        return NULL;
+    }
+    void *ptr = arena->base + arena->used;
+    arena->used += size;
+    return ptr;
+}
+
+void ms_ArenaReset(ms_Arena *arena) {
+    arena->used = 0;
+}
+
+void ms_ArenaFree(ms_Arena *arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->cap = 0;
+    arena->used = 0;
+}
@@ -0,0 +1,26 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Bump allocator backing the board storage.
+ * One block is reserved up front; allocations are carved from it and released
+ * all at once with ms_ArenaReset, so setting up a board is a single malloc. */
+
+#define MS_ARENA_ALIGN 64
+
+typedef struct {
+    unsigned char *base;
+    size_t cap;
+    size_t used;
+} ms_Arena;
+
+bool ms_ArenaReserve(ms_Arena *arena, size_t size);
+void *ms_ArenaAlloc(ms_Arena *arena, size_t size);
+void ms_ArenaReset(ms_Arena *arena);
+void ms_ArenaFree(ms_Arena *arena);
+
+size_t ms_ArenaAlignUp(size_t size);
+
+#endif // ARENA_H
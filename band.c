@@ -0,0 +1,284 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "band.h"
+#include "count.h"
+
+
+/* A cell whose key fell into the window. */
+typedef struct {
+    uint64_t key;
+    uint64_t cell;
+} ms_BandKey;
+
+/* What one band found: the mines below the window and the keys inside it,
+ * kept in the band's slot of the candidates while they fit. */
+typedef struct {
+    size_t below;
+    size_t count;
+} ms_BandKeys;
+
+typedef struct {
+    ms_Game *game;
+    // the board's generator, jumped band + 1 times for band `band`
+    ms_Rng rng;
+    ms_Pos first;
+    // keys below `low` are mines, keys in [low, high] candidates
+    uint64_t low;
+    uint64_t high;
+    ms_BandKeys *bands;
+    // band b keeps its keys at candidates + b * slot
+    ms_BandKey *candidates;
+    size_t slot;
+} ms_BandPlacement;
+
+typedef struct {
+    ms_Game *game;
+    ms_CountKernel kernel;
+} ms_BandCounting;
+
+/*Takes bands off the current job until none are left.*/
+static void ms_BandDrain(ms_BandPool *pool) {
+    for (int band; (band = atomic_fetch_add(&pool->next_band, 1)) < pool->band_count;) {
+        pool->task(pool->context, band);
+    }
+}
+
+static void *ms_BandWorker(void *arg) {
+    ms_BandPool *pool = arg;
+    uint64_t seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->job == seen) {
+            pthread_cond_wait(&pool->posted, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->job;
+        pthread_mutex_unlock(&pool->lock);
+        ms_BandDrain(pool);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->working == 0) {
+            pthread_cond_signal(&pool->finished);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/*Starts `threads` workers, at most MS_BAND_MAX_THREADS. Returns false and
+ * leaves no thread running if one could not be started.*/
+bool ms_BandPoolStart(ms_BandPool *pool, int threads) {
+    *pool = (ms_BandPool) {0};
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->posted, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+    if (threads > MS_BAND_MAX_THREADS) {
+        threads = MS_BAND_MAX_THREADS;
+    }
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, ms_BandWorker, pool) != 0) {
+            ms_BandPoolStop(pool);
+            return false;
+        }
+        pool->thread_count++;
+    }
+    return true;
+}
+
+void ms_BandPoolStop(ms_BandPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->posted);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pool->thread_count = 0;
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->posted);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/*Runs `task` on bands [0, band_count) and returns once all of them are done.
+ * The calling thread takes bands too; without a pool it runs them all.*/
+void ms_BandRun(ms_BandPool *pool, ms_BandTask task, void *context, int band_count) {
+    if (!pool || pool->thread_count == 0) {
+        for (int band = 0; band < band_count; band++) {
+            task(context, band);
+        }
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->band_count = band_count;
+    atomic_store(&pool->next_band, 0);
+    pool->working = pool->thread_count;
+    pool->job++;
+    pthread_cond_broadcast(&pool->posted);
+    pthread_mutex_unlock(&pool->lock);
+
+    ms_BandDrain(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->working > 0) {
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/*Row after the last row of `band`.*/
+static inline int ms_BandEnd(const ms_Game *game, int band) {
+    int end = (band + 1) * MS_BAND_ROWS;
+    return end < game->rows ? end : game->rows;
+}
+
+static ms_Rng ms_BandRng(const ms_BandPlacement *placement, int band) {
+    ms_Rng rng = placement->rng;
+    for (int i = 0; i <= band; i++) {
+        ms_RngJump(&rng);
+    }
+    return rng;
+}
+
+/*Whether (x, y) is in the 3x3 block around the first click. Those cells still
+ * draw their key, so the keys of all other cells stay where they are.*/
+static inline bool ms_BandExcluded(ms_Pos first, int x, int y) {
+    return abs(x - first.x) <= 1 && abs(y - first.y) <= 1;
+}
+
+/*Draws a key for every cell of the band: cells below the window become mines,
+ * cells in it go to the band's candidates. A band only writes its own rows.*/
+static void ms_BandPlace(void *context, int band) {
+    ms_BandPlacement *placement = context;
+    ms_Game *game = placement->game;
+    ms_BandKeys *keys = &placement->bands[band];
+    ms_BandKey *slot = placement->candidates + band * placement->slot;
+    ms_Rng rng = ms_BandRng(placement, band);
+    keys->below = 0;
+    keys->count = 0;
+    int y1 = ms_BandEnd(game, band);
+    for (int y = band * MS_BAND_ROWS; y < y1; y++) {
+        uint64_t *row = game->mines + (size_t)y * game->stride;
+        memset(row, 0, game->stride * sizeof(uint64_t));
+        for (int x = 0; x < game->cols; x++) {
+            uint64_t key = ms_RngNext(&rng);
+            if (key > placement->high || ms_BandExcluded(placement->first, x, y)) {
+                continue;
+            }
+            if (key < placement->low) {
+                row[x >> 6] |= ms_BitMask(x);
+                keys->below++;
+            } else if (keys->count++ < placement->slot) {
+                slot[keys->count - 1] = (ms_BandKey) { .key = key, .cell = (uint64_t)y * game->cols + x };
+            }
+        }
+    }
+}
+
+/*Key at quantile `q` of the key range, clamped to it.*/
+static uint64_t ms_BandQuantile(double q) {
+    if (q <= 0) {
+        return 0;
+    }
+    return q >= 1 ? UINT64_MAX : (uint64_t)(q * 0x1p64);
+}
+
+static int ms_BandKeyCompare(const void *a, const void *b) {
+    const ms_BandKey *ka = a, *kb = b;
+    if (ka->key != kb->key) {
+        return ka->key < kb->key ? -1 : 1;
+    }
+    return ka->cell < kb->cell ? -1 : ka->cell > kb->cell;
+}
+
+/*Places the mines on the mine_count allowed cells with the smallest keys,
+ * see band.h.*/
+void ms_PlaceMinesBanded(ms_Game *game, ms_Pos first) {
+    if (game->mine_count == 0) {
+        return;
+    }
+    int band_count = ms_BandCount(game->rows);
+    ms_BandPlacement placement = {
+        .game = game,
+        .rng = game->rng,
+        .first = first,
+        .bands = calloc(band_count, sizeof(ms_BandKeys)),
+    };
+    assert(placement.bands && "out of memory");
+
+    size_t excluded = 0;
+    for (unsigned bits = ms_WindowInside(game, first.x, first.y); bits; bits &= bits - 1) {
+        excluded++;
+    }
+    double allowed = (double)game->rows * game->cols - excluded;
+    double q = game->mine_count / allowed;
+    // the mine_count-th smallest key lies within a few standard deviations of q
+    double margin = 8 * sqrt(game->mine_count * (1 - q)) / allowed + 16 / allowed;
+    // twice the keys a band finds in the window on average
+    placement.slot = (size_t)(4 * margin * MS_BAND_ROWS * game->cols) + 64;
+    if (placement.slot > (size_t)MS_BAND_ROWS * game->cols) {
+        placement.slot = (size_t)MS_BAND_ROWS * game->cols;
+    }
+    size_t candidate_count, need;
+    for (;;) {
+        placement.low = ms_BandQuantile(q - margin);
+        placement.high = ms_BandQuantile(q + margin);
+        placement.candidates = realloc(placement.candidates, band_count * placement.slot * sizeof(ms_BandKey));
+        assert(placement.candidates && "out of memory");
+        ms_BandRun(game->band_pool, ms_BandPlace, &placement, band_count);
+
+        size_t below = 0, fullest = 0;
+        candidate_count = 0;
+        for (int band = 0; band < band_count; band++) {
+            below += placement.bands[band].below;
+            candidate_count += placement.bands[band].count;
+            fullest = placement.bands[band].count > fullest ? placement.bands[band].count : fullest;
+        }
+        need = game->mine_count - below;
+        if (fullest > placement.slot) {
+            // a band ran out of room: the same window again with room for it
+            placement.slot = fullest;
+        } else if (below > (size_t)game->mine_count || need > candidate_count) {
+            // the window missed; a wider one catches it sooner or later
+            margin *= 8;
+        } else {
+            break;
+        }
+    }
+
+    ms_BandKey *candidates = placement.candidates;
+    candidate_count = 0;
+    for (int band = 0; band < band_count; band++) {
+        memmove(candidates + candidate_count, candidates + band * placement.slot,
+                placement.bands[band].count * sizeof(ms_BandKey));
+        candidate_count += placement.bands[band].count;
+    }
+    qsort(candidates, candidate_count, sizeof(ms_BandKey), ms_BandKeyCompare);
+    for (size_t i = 0; i < need; i++) {
+        int x = candidates[i].cell % game->cols;
+        game->mines[ms_WordIndex(game, x, candidates[i].cell / game->cols)] |= ms_BitMask(x);
+    }
+    free(candidates);
+    free(placement.bands);
+}
+
+/*Counts the rows of one band. ms_CountRows reads the mine rows next to the
+ * band itself, so bands need nothing from each other but finished mines.*/
+static void ms_BandCountRows(void *context, int band) {
+    ms_BandCounting *counting = context;
+    ms_Game *game = counting->game;
+    uint64_t scratch[MS_COUNT_SCRATCH_WORDS(MS_MAX_SIDE / 64)];
+    int y1 = ms_BandEnd(game, band);
+    ms_CountRows(counting->kernel, game->mines, game->counts, game->rows, game->cols, game->stride,
+                 band * MS_BAND_ROWS, y1, scratch);
+}
+
+void ms_CountNeighboursBanded(ms_Game *game) {
+    ms_BandCounting counting = { .game = game, .kernel = ms_BestCountKernel() };
+    ms_BandRun(game->band_pool, ms_BandCountRows, &counting, ms_BandCount(game->rows));
+}
@@ -0,0 +1,88 @@
+#ifndef BAND_H
+#define BAND_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+
+/* Row-band generation for large boards.
+ *
+ * Boards of MS_BAND_MIN_CELLS cells or more can be generated in bands of
+ * MS_BAND_ROWS rows. Every cell draws a 64-bit key from its band's generator,
+ * the board's generator jumped ahead by 2^128 steps once per band, so every
+ * band has its own substream no other band overlaps. The mines go to the
+ * mine_count allowed cells with the smallest keys: a uniformly random set, as
+ * with the single-stream placement, found in one pass that any number of
+ * threads can share out band by band. The mine_count-th smallest key is close
+ * to mine_count / cells of the key range, so a band turns the cells below a
+ * narrow window around that into mines and keeps the keys inside it; sorting
+ * the few kept keys of all bands places the mines still missing. Should the
+ * window miss, the pass runs again with a wider one.
+ *
+ * The pass draws a key for every cell where Floyd's sampling draws one per
+ * mine, so only dense boards take it (ms_BandedPlacement): from one mine per
+ * MS_BAND_CELLS_PER_MINE cells it is about as fast as Floyd's sampling on one
+ * thread and faster on more. The keys give another board for a seed than the
+ * single-stream placement, so the choice looks at the board alone, never at
+ * the threads.
+ *
+ * The counts of these boards are computed band by band too, however the mines
+ * were placed: a band reads the mine rows just above and below it from its
+ * neighbours, which all finished placing by then. Bands, keys and the sort
+ * order do not depend on the threads, so a seed gives the same board with any
+ * number of them.
+ *
+ * The threads come from an ms_BandPool set on the board (`band_pool`); the
+ * thread that asks for the board takes bands as well. Without a pool the bands
+ * run one after the other on that thread. */
+
+#define MS_BAND_ROWS           128
+#define MS_BAND_MIN_CELLS      (1 << 20)
+#define MS_BAND_MAX_THREADS    64
+// boards with a mine in at least every this many cells place them band by band
+#define MS_BAND_CELLS_PER_MINE 8
+
+typedef void (*ms_BandTask)(void *context, int band);
+
+/* Worker threads that run a task on every band of a job. Bands are handed out
+ * through `next_band`; `job` is bumped for every job and `working` counts the
+ * workers that have not finished it yet. */
+struct ms_BandPool {
+    pthread_t threads[MS_BAND_MAX_THREADS];
+    int thread_count;
+    pthread_mutex_t lock;
+    pthread_cond_t posted;
+    pthread_cond_t finished;
+    ms_BandTask task;
+    void *context;
+    int band_count;
+    _Atomic int next_band;
+    int working;
+    uint64_t job;
+    bool stop;
+};
+
+bool ms_BandPoolStart(ms_BandPool *pool, int threads);
+void ms_BandPoolStop(ms_BandPool *pool);
+void ms_BandRun(ms_BandPool *pool, ms_BandTask task, void *context, int band_count);
+
+void ms_PlaceMinesBanded(ms_Game *game, ms_Pos first);
+void ms_CountNeighboursBanded(ms_Game *game);
+
+static inline bool ms_BandedSize(int rows, int columns) {
+    return (size_t)rows * columns >= MS_BAND_MIN_CELLS;
+}
+
+/*Whether a board of this size and mine count places its mines band by band.*/
+static inline bool ms_BandedPlacement(int rows, int columns, int mines) {
+    return ms_BandedSize(rows, columns) && (size_t)mines * MS_BAND_CELLS_PER_MINE >= (size_t)rows * columns;
+}
+
+static inline int ms_BandCount(int rows) {
+    return (rows + MS_BAND_ROWS - 1) / MS_BAND_ROWS;
+}
+
+#endif // BAND_H
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "minesweeper.h"
+#include "band.h"
+#include "count.h"
+
+/* Banded generation benchmark.
+ * Generates large boards with the single-stream placement and then banded
+ * with 1, 2, 4, ... threads, up to the online cores (at least 4, so the
+ * thread count is always varied): the mines, then the neighbour counts on
+ * their own. Every banded run has to give the same board, with exactly
+ * mine_count mines, none around the first click and the counts the reference
+ * loop gives. The last line of a board tells which placement ms_InitGame
+ * picks for it. */
+
+#define BENCH_SEED   1234
+#define BENCH_REPEAT 3
+
+typedef struct {
+    int rows;
+    int cols;
+    int mines;
+} ms_BenchSize;
+
+typedef struct {
+    double generate;
+    double count;
+    uint64_t fingerprint;
+} ms_BenchRun;
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t ms_BenchHash(const ms_Game *game) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t words = (size_t)game->rows * game->stride;
+    for (size_t i = 0; i < words; i++) {
+        hash = (hash ^ game->mines[i]) * 0x100000001b3ULL;
+        for (int k = 0; k < 4; k++) {
+            hash = (hash ^ game->counts[4 * i + k]) * 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+/*Checks what every board has to hold whatever placed its mines.*/
+static bool ms_BenchCheck(ms_Game *game, ms_Pos first) {
+    size_t words = (size_t)game->rows * game->stride;
+    size_t mines = 0;
+    for (size_t i = 0; i < words; i++) {
+        mines += __builtin_popcountll(game->mines[i]);
+    }
+    if (mines != (size_t)game->mine_count) {
+        printf("MISMATCH: %zu mines instead of %d\n", mines, game->mine_count);
+        return false;
+    }
+    for (int y = first.y - 1; y <= first.y + 1; y++) {
+        for (int x = first.x - 1; x <= first.x + 1; x++) {
+            ms_Pos pos = { .x = x, .y = y };
+            if (ms_PosInside(game, &pos) && ms_IsMine(game, x, y)) {
+                printf("MISMATCH: a mine next to the first click\n");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*Best of BENCH_REPEAT runs; `pool` NULL and `banded` false is the
+ * single-stream placement.*/
+static ms_BenchRun ms_BenchGenerate(ms_Game *game, ms_BenchSize size, ms_BandPool *pool, bool banded) {
+    ms_BenchRun run = { .generate = 1e9, .count = 1e9 };
+    ms_Pos first = { .x = size.cols / 3, .y = size.rows / 3 };
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        ms_InitGame(game, size.rows, size.cols, size.mines, BENCH_SEED);
+        game->banded_mines = banded;
+        game->band_pool = pool;
+        double t0 = ms_Now();
+        ms_InitGameData(game, &first);
+        double t1 = ms_Now();
+        ms_CountNeighbours(game);
+        double t2 = ms_Now();
+        run.generate = t1 - t0 < run.generate ? t1 - t0 : run.generate;
+        run.count = t2 - t1 < run.count ? t2 - t1 : run.count;
+    }
+    run.fingerprint = ms_BenchHash(game);
+    return run;
+}
+
+int main() {
+    const ms_BenchSize sizes[] = {
+        { 4096, 4096, 3455000 },
+        { 10000, 10000, 1000000 },
+        { 10000, 10000, 20600000 },
+    };
+    int size_count = sizeof(sizes) / sizeof(sizes[0]);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = cores > 4 ? (int)cores : 4;
+    if (max_threads > MS_BAND_MAX_THREADS) {
+        max_threads = MS_BAND_MAX_THREADS;
+    }
+    bool ok = true;
+
+    printf("%ld online cores\n", cores);
+    printf("%-24s %-12s %14s %10s %12s %10s\n", "board", "placement", "generate ms", "speedup", "count ms", "speedup");
+    for (int s = 0; s < size_count; s++) {
+        ms_BenchSize size = sizes[s];
+        ms_Game game = {0};
+        char board[32];
+        snprintf(board, sizeof(board), "%dx%d/%d", size.rows, size.cols, size.mines);
+
+        ms_BenchRun serial = ms_BenchGenerate(&game, size, NULL, false);
+        printf("%-24s %-12s %14.1f %10s %12.1f %10s\n", board, "serial", serial.generate * 1e3, "",
+               serial.count * 1e3, "");
+
+        ms_BenchRun single = {0};
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            // the calling thread takes bands too
+            ms_BandPool pool;
+            if (!ms_BandPoolStart(&pool, threads - 1)) {
+                fprintf(stderr, "could not start %d threads\n", threads);
+                return 1;
+            }
+            ms_BenchRun run = ms_BenchGenerate(&game, size, &pool, true);
+            ms_BandPoolStop(&pool);
+
+            char label[32];
+            snprintf(label, sizeof(label), "%d thread%s", threads, threads == 1 ? "" : "s");
+            if (threads == 1) {
+                single = run;
+                ok = ms_BenchCheck(&game, (ms_Pos) { .x = size.cols / 3, .y = size.rows / 3 }) && ok;
+                ms_CountNeighboursReference(&game);
+                if (ms_BenchHash(&game) != run.fingerprint) {
+                    printf("MISMATCH: the banded counts differ from the reference\n");
+                    ok = false;
+                }
+            } else if (run.fingerprint != single.fingerprint) {
+                printf("MISMATCH: %d threads give another board than 1\n", threads);
+                ok = false;
+            }
+            printf("%-24s %-12s %14.1f %9.2fx %12.1f %9.2fx\n", board, label, run.generate * 1e3,
+                   single.generate / run.generate, run.count * 1e3, single.count / run.count);
+        }
+        printf("%-24s placed %s\n", board,
+               ms_BandedPlacement(size.rows, size.cols, size.mines) ? "band by band" : "single-stream");
+        ms_FreeGame(&game);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "minesweeper.h"
+#include "solver.h"
+
+/* Core engine benchmark (make bench).
+ * Times the engine's hot routines on fixed seeds, so two commits can be
+ * compared run for run:
+ *
+ *  - InitGameData: mine placement and neighbour counts for a first click in
+ *    the middle,
+ *  - ExpandZeros: opening the zero region of that first click,
+ *  - CheckGameWon: the incremental win check on a cleared board, next to the
+ *    full ScanGameWon,
+ *  - RevealFlag: clearing a placed board cell by cell with ms_RevealCell and
+ *    ms_FlagCell,
+ *  - Game: whole games through ms_ClickCell/ms_MarkCell, played by the solver
+ *    with a random guess whenever it is stuck.
+ *
+ * Heap allocations are counted by wrapping malloc & co at link time (see the
+ * Makefile), so allocs/op covers the engine library too.
+ * Prints a table and writes the same numbers as JSON to the file given with -o
+ * (bench.json by default). */
+
+typedef struct {
+    const char *name;
+    int rows;
+    int cols;
+    int mines;
+    // whole games to play, 0 to skip them
+    int games;
+} ms_BenchSize;
+
+typedef struct {
+    const char *routine;
+    const char *size;
+    size_t ops;
+    double seconds;
+    // work done besides the op count, e.g. cells opened
+    size_t items;
+    const char *item;
+    size_t allocs;
+} ms_BenchResult;
+
+// every op of every size touches roughly this many cells in total
+#define MS_BENCH_CELL_BUDGET 50000000
+#define MS_BENCH_MAX_OPS     200000
+#define MS_BENCH_MAX_RESULTS 64
+#define MS_BENCH_SEED        1234
+
+static size_t allocations = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    allocations++;
+    return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size) {
+    allocations++;
+    return __real_aligned_alloc(alignment, size);
+}
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t ms_BenchOps(const ms_BenchSize *size, size_t budget) {
+    size_t ops = budget / ((size_t)size->rows * size->cols);
+    return ops < 1 ? 1 : ops > MS_BENCH_MAX_OPS ? MS_BENCH_MAX_OPS : ops;
+}
+
+static ms_Pos ms_BenchFirst(const ms_BenchSize *size) {
+    return ms_PosXY(size->cols / 2, size->rows / 2);
+}
+
+static ms_BenchResult ms_BenchInitGameData(ms_Game *game, const ms_BenchSize *size) {
+    ms_BenchResult r = { .routine = "InitGameData", .size = size->name, .item = "cells" };
+    r.ops = ms_BenchOps(size, MS_BENCH_CELL_BUDGET);
+    ms_Pos first = ms_BenchFirst(size);
+    for (size_t i = 0; i < r.ops; i++) {
+        ms_InitGame(game, size->rows, size->cols, size->mines, MS_BENCH_SEED + i);
+        size_t before = allocations;
+        double t0 = ms_Now();
+        ms_InitGameData(game, &first);
+        r.seconds += ms_Now() - t0;
+        r.allocs += allocations - before;
+        r.items += (size_t)size->rows * size->cols;
+    }
+    return r;
+}
+
+static ms_BenchResult ms_BenchExpandZeros(ms_Game *game, const ms_BenchSize *size) {
+    ms_BenchResult r = { .routine = "ExpandZeros", .size = size->name, .item = "cells" };
+    r.ops = ms_BenchOps(size, MS_BENCH_CELL_BUDGET);
+    ms_Pos first = ms_BenchFirst(size);
+    for (size_t i = 0; i < r.ops; i++) {
+        ms_InitGame(game, size->rows, size->cols, size->mines, MS_BENCH_SEED + i);
+        ms_InitGameData(game, &first);
+        game->first_click_done = true;
+        size_t before = allocations;
+        double t0 = ms_Now();
+        ms_RevealDelta delta = ms_ExpandZeros(game, first);
+        r.seconds += ms_Now() - t0;
+        r.allocs += allocations - before;
+        r.items += delta.count;
+    }
+    return r;
+}
+
+/*Reveals every safe cell and flags every mine, row by row.*/
+static void ms_BenchClear(ms_Game *game) {
+    for (int y = 0; y < game->rows; y++) {
+        for (int x = 0; x < game->cols; x++) {
+            ms_Pos pos = { .x = x, .y = y };
+            if (ms_IsMine(game, x, y)) {
+                game->mines_left += ms_FlagCell(game, &pos);
+            } else {
+                ms_RevealCell(game, &pos);
+            }
+        }
+        // the delta would otherwise grow to the whole board
+        ms_ResetDelta(game);
+    }
+}
+
+static ms_BenchResult ms_BenchCheckGameWon(ms_Game *game, const ms_BenchSize *size, bool scan) {
+    ms_BenchResult r = { .routine = scan ? "ScanGameWon" : "CheckGameWon", .size = size->name, .item = "cells" };
+    r.ops = scan ? ms_BenchOps(size, 10 * MS_BENCH_CELL_BUDGET) : 10 * MS_BENCH_MAX_OPS;
+    ms_Pos first = ms_BenchFirst(size);
+    ms_InitGame(game, size->rows, size->cols, size->mines, MS_BENCH_SEED);
+    ms_InitGameData(game, &first);
+    game->first_click_done = true;
+    ms_BenchClear(game);
+    volatile size_t won = 0;
+    size_t before = allocations;
+    double t0 = ms_Now();
+    for (size_t i = 0; i < r.ops; i++) {
+        won += scan ? ms_ScanGameWon(game) : ms_CheckGameWon(game);
+    }
+    r.seconds = ms_Now() - t0;
+    r.allocs = allocations - before;
+    r.items = r.ops * size->rows * size->cols;
+    return r;
+}
+
+static ms_BenchResult ms_BenchRevealFlag(ms_Game *game, const ms_BenchSize *size) {
+    ms_BenchResult r = { .routine = "RevealFlag", .size = size->name, .item = "boards" };
+    size_t boards = ms_BenchOps(size, MS_BENCH_CELL_BUDGET);
+    ms_Pos first = ms_BenchFirst(size);
+    for (size_t i = 0; i < boards; i++) {
+        ms_InitGame(game, size->rows, size->cols, size->mines, MS_BENCH_SEED + i);
+        ms_InitGameData(game, &first);
+        game->first_click_done = true;
+        size_t before = allocations;
+        double t0 = ms_Now();
+        ms_BenchClear(game);
+        r.items += ms_CheckGameWon(game);
+        r.seconds += ms_Now() - t0;
+        r.allocs += allocations - before;
+        r.ops += (size_t)size->rows * size->cols;
+    }
+    return r;
+}
+
+/*Plays one game: the solver as long as it can, else flags what must be mines
+ * or guesses a random hidden cell. Returns the number of moves.*/
+static size_t ms_BenchPlay(ms_Game *game, ms_Solver *solver, ms_Rng *rng, ms_Pos first) {
+    ms_ClickCell(game, &first);
+    ms_SolverInit(solver, game);
+    ms_RevealDelta delta = ms_GameDelta(game);
+    ms_SolverUpdate(solver, game, delta.cells, delta.count);
+    size_t moves = 1;
+    while (game->state == ms_PLAYING) {
+        size_t before = solver->stats.moves;
+        if (ms_SolverStep(solver, game)) {
+            moves += solver->stats.moves - before;
+            continue;
+        }
+        ms_Pos pos;
+        if (game->mines_left > 0 && ms_HiddenCount(game) == (size_t)game->mines_left) {
+            // only mines are left hidden
+            for (pos.y = 0; pos.y < game->rows && game->state == ms_PLAYING; pos.y++) {
+                for (pos.x = 0; pos.x < game->cols && game->state == ms_PLAYING; pos.x++) {
+                    if (ms_IsHidden(game, pos.x, pos.y)) {
+                        ms_MarkCell(game, &pos);
+                        moves++;
+                    }
+                }
+            }
+            continue;
+        }
+        do {
+            pos = ms_PosXY(ms_RngBelow(rng, game->cols), ms_RngBelow(rng, game->rows));
+        } while (!ms_IsHidden(game, pos.x, pos.y));
+        ms_ClickCell(game, &pos);
+        delta = ms_GameDelta(game);
+        ms_SolverUpdate(solver, game, delta.cells, delta.count);
+        moves++;
+    }
+    return moves;
+}
+
+static ms_BenchResult ms_BenchGames(ms_Game *game, ms_Solver *solver, const ms_BenchSize *size) {
+    ms_BenchResult r = { .routine = "Game", .size = size->name, .item = "moves" };
+    r.ops = size->games;
+    ms_Pos first = ms_BenchFirst(size);
+    for (size_t i = 0; i < r.ops; i++) {
+        ms_Rng rng;
+        ms_RngSeed(&rng, MS_BENCH_SEED + i);
+        size_t before = allocations;
+        double t0 = ms_Now();
+        ms_InitGame(game, size->rows, size->cols, size->mines, MS_BENCH_SEED + i);
+        r.items += ms_BenchPlay(game, solver, &rng, first);
+        r.seconds += ms_Now() - t0;
+        r.allocs += allocations - before;
+    }
+    return r;
+}
+
+static void ms_PrintResult(const ms_BenchResult *r) {
+    char throughput[32];
+    snprintf(throughput, sizeof(throughput), "%.3g %s/s", r->items / r->seconds, r->item);
+    printf("%-13s %-10s %9zu %12.1f %12.0f %18s %10.3f\n", r->routine, r->size, r->ops,
+           r->seconds / r->ops * 1e9, r->ops / r->seconds, throughput, (double)r->allocs / r->ops);
+}
+
+static bool ms_WriteJson(const char *path, const ms_BenchResult *results, size_t count) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "{\n  \"seed\": %d,\n  \"results\": [\n", MS_BENCH_SEED);
+    for (size_t i = 0; i < count; i++) {
+        const ms_BenchResult *r = &results[i];
+        fprintf(file,
+                "    {\"routine\": \"%s\", \"size\": \"%s\", \"ops\": %zu, \"ns_per_op\": %.3f, "
+                "\"ops_per_sec\": %.3f, \"%s_per_sec\": %.3f, \"allocs_per_op\": %.6f}%s\n",
+                r->routine, r->size, r->ops, r->seconds / r->ops * 1e9, r->ops / r->seconds,
+                r->item, r->items / r->seconds, (double)r->allocs / r->ops, i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char **argv) {
+    const char *json = "bench.json";
+    int opt;
+    while ((opt = getopt(argc, argv, "o:")) != -1) {
+        if (opt != 'o') {
+            fprintf(stderr, "usage: %s [-o results.json]\n", argv[0]);
+            return 1;
+        }
+        json = optarg;
+    }
+
+    ms_BenchSize sizes[] = {
+        { "beginner",     BEGINNER_ROWS,     BEGINNER_COLUMNS,     BEGINNER_MINE_COUNT,     20000 },
+        { "intermediate", INTERMEDIATE_ROWS, INTERMEDIATE_COLUMNS, INTERMEDIATE_MINE_COUNT, 5000  },
+        { "expert",       EXPERT_ROWS,       EXPERT_COLUMNS,       EXPERT_MINE_COUNT,       2000  },
+        { "1000x1000",    1000,              1000,                 150000,                  1     },
+        { "4096x4096",    4096,              4096,                 2516582,                 0     },
+        // sparse enough that the first click opens most of the board
+        { "2000x2000",    2000,              2000,                 80000,                   0     },
+    };
+
+    ms_Game game = {0};
+    ms_Solver solver = {0};
+    ms_BenchResult results[MS_BENCH_MAX_RESULTS];
+    size_t count = 0;
+
+    printf("%-13s %-10s %9s %12s %12s %18s %10s\n",
+           "routine", "size", "ops", "ns/op", "ops/s", "throughput", "allocs/op");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const ms_BenchSize *size = &sizes[s];
+        size_t first = count;
+        results[count++] = ms_BenchInitGameData(&game, size);
+        results[count++] = ms_BenchExpandZeros(&game, size);
+        results[count++] = ms_BenchCheckGameWon(&game, size, false);
+        results[count++] = ms_BenchCheckGameWon(&game, size, true);
+        results[count++] = ms_BenchRevealFlag(&game, size);
+        if (size->games > 0) {
+            results[count++] = ms_BenchGames(&game, &solver, size);
+        }
+        for (size_t i = first; i < count; i++) {
+            ms_PrintResult(&results[i]);
+        }
+    }
+
+    ms_SolverFree(&solver);
+    ms_FreeGame(&game);
+    if (!ms_WriteJson(json, results, count)) {
+        fprintf(stderr, "%s: could not write results\n", json);
+        return 1;
+    }
+    printf("\nresults written to %s\n", json);
+    return 0;
+}
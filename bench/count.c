@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "minesweeper.h"
+#include "count.h"
+
+/* Neighbour-count benchmark.
+ * For every board size this generates boards the way ms_InitGameData does,
+ * checks each count kernel against the per-mine reference loop and reports
+ * how many boards per second each kernel sustains. */
+
+typedef struct {
+    const char *name;
+    int rows;
+    int cols;
+    int mines;
+    int boards;
+} ms_BenchSize;
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+    uint64_t seed = 1234;
+
+    ms_BenchSize sizes[] = {
+        { "beginner",  BEGINNER_ROWS, BEGINNER_COLUMNS, BEGINNER_MINE_COUNT, 200000 },
+        { "expert",    EXPERT_ROWS,   EXPERT_COLUMNS,   EXPERT_MINE_COUNT,   100000 },
+        { "1000x1000", 1000,          1000,             206250,              20     },
+    };
+
+    ms_Game game = {0};
+    ms_Game ref = {0};
+    bool ok = true;
+
+    printf("%-10s %-10s %14s %14s %14s\n", "size", "kernel", "count ns/board", "count boards/s", "gen boards/s");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        ms_BenchSize *size = &sizes[s];
+        ms_Pos first = { .x = size->cols / 2, .y = size->rows / 2 };
+
+        // mine placement alone, so the generation rate can be reported per kernel
+        double placement = 0;
+        for (int b = 0; b < size->boards; b++) {
+            ms_InitGame(&game, size->rows, size->cols, size->mines, seed++);
+            double t0 = ms_Now();
+            ms_InitGameData(&game, &first);
+            placement += ms_Now() - t0;
+        }
+        placement /= size->boards;
+
+        ms_InitGame(&ref, size->rows, size->cols, size->mines, 0);
+        size_t words = (size_t)game.rows * game.stride;
+        memcpy(ref.mines, game.mines, words * sizeof(uint64_t));
+        ms_CountNeighboursReference(&ref);
+
+        for (int k = -1; k < ms_KERNEL_COUNT; k++) {
+            if (k >= 0 && !ms_CountKernelSupported(k)) {
+                continue;
+            }
+            double t0 = ms_Now();
+            for (int b = 0; b < size->boards; b++) {
+                if (k < 0) {
+                    ms_CountNeighboursReference(&game);
+                } else {
+                    ms_CountNeighboursWith(&game, k);
+                }
+            }
+            double count = (ms_Now() - t0) / size->boards;
+
+            bool same = memcmp(game.counts, ref.counts, 4 * words * sizeof(uint64_t)) == 0;
+            ok = ok && same;
+            printf("%-10s %-10s %14.0f %14.0f %14.0f%s\n",
+                   size->name, k < 0 ? "reference" : ms_CountKernelName(k),
+                   count * 1e9, 1.0 / count, 1.0 / (placement + count),
+                   same ? "" : "  MISMATCH");
+        }
+    }
+
+    ms_FreeGame(&game);
+    ms_FreeGame(&ref);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "minesweeper.h"
+#include "hint.h"
+#include "prob.h"
+
+/* Hint latency benchmark.
+ * A bot plays every board by its hints alone: it reveals safe cells and
+ * guesses, and flags proven mines. Each hint is timed and filed under the
+ * share of safe cells revealed when it was asked for. The first hint of
+ * every progress bucket is also asked of engines set up from scratch on that
+ * board, which is what a hint costs without the incremental engine.
+ * A safe hint on a mine or a mine hint on a safe cell is an error. */
+
+#define BENCH_SEED    1234
+#define BENCH_BUCKETS 5
+
+typedef struct {
+    int rows;
+    int cols;
+    int mines;
+    int boards;
+} ms_BenchSize;
+
+typedef struct {
+    double *times;
+    size_t count;
+    size_t cap;
+    double rescan;
+    size_t rescans;
+} ms_BenchBucket;
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int ms_CompareTime(const void *a, const void *b) {
+    double ta = *(const double *)a, tb = *(const double *)b;
+    return (ta > tb) - (ta < tb);
+}
+
+static int ms_BenchProgress(const ms_Game *game) {
+    if (!game->first_click_done) {
+        return 0;
+    }
+    size_t safe = (size_t)game->rows * game->cols - game->mine_count;
+    int bucket = (int)((safe - game->hidden_safe) * BENCH_BUCKETS / safe);
+    return bucket < BENCH_BUCKETS ? bucket : BENCH_BUCKETS - 1;
+}
+
+/*Plays one board by its hints. Returns the number of wrong hints.*/
+static int ms_BenchPlay(ms_Game *game, ms_BenchBucket *buckets, ms_HintEngine *hints, ms_ProbEngine *prob,
+                        ms_HintEngine *fresh_hints, ms_ProbEngine *fresh_prob) {
+    int wrong = 0;
+    bool timed_rescan[BENCH_BUCKETS] = {0};
+    ms_HintInit(hints, game);
+    ms_ProbInit(prob, game);
+    while (game->state == ms_PLAYING) {
+        int bucket = ms_BenchProgress(game);
+        double t0 = ms_Now();
+        ms_Hint hint = ms_HintNext(hints, prob, game);
+        double took = ms_Now() - t0;
+        ms_BenchBucket *b = &buckets[bucket];
+        b->times = ms_Grow(b->times, &b->cap, b->count + 1, sizeof(double));
+        b->times[b->count++] = took;
+
+        if (!timed_rescan[bucket] && game->first_click_done) {
+            timed_rescan[bucket] = true;
+            t0 = ms_Now();
+            ms_HintInit(fresh_hints, game);
+            ms_ProbInit(fresh_prob, game);
+            ms_HintNext(fresh_hints, fresh_prob, game);
+            b->rescan += ms_Now() - t0;
+            b->rescans++;
+        }
+
+        if (hint.kind == ms_HINT_NONE) {
+            break;
+        }
+        bool mine = game->first_click_done && ms_IsMine(game, hint.pos.x, hint.pos.y);
+        if ((hint.kind == ms_HINT_SAFE && mine) || (hint.kind == ms_HINT_MINE && !mine)) {
+            wrong++;
+        }
+        if (hint.kind == ms_HINT_MINE) {
+            ms_MarkCell(game, &hint.pos);
+            uint32_t cell = hint.pos.y * game->cols + hint.pos.x;
+            ms_HintUpdate(hints, game, &cell, 1);
+            ms_ProbUpdate(prob, game, &cell, 1);
+        } else {
+            ms_ClickCell(game, &hint.pos);
+            ms_RevealDelta delta = ms_GameDelta(game);
+            ms_HintUpdate(hints, game, delta.cells, delta.count);
+            ms_ProbUpdate(prob, game, delta.cells, delta.count);
+        }
+    }
+    return wrong;
+}
+
+int main() {
+    const ms_BenchSize sizes[] = {
+        { 16, 30, 99, 2000 },
+        { 256, 256, 10000, 20 },
+        { 1000, 1000, 150000, 2 },
+    };
+    int size_count = sizeof(sizes) / sizeof(sizes[0]);
+    ms_HintEngine hints = {0}, fresh_hints = {0};
+    ms_ProbEngine prob = {0}, fresh_prob = {0};
+    bool ok = true;
+
+    printf("%-20s %-9s %10s %10s %10s %10s %12s\n", "board", "progress", "hints", "mean us", "p99 us", "max us",
+           "rescan us");
+    for (int s = 0; s < size_count; s++) {
+        ms_BenchSize size = sizes[s];
+        ms_BenchBucket buckets[BENCH_BUCKETS] = {0};
+        ms_Game game = {0};
+        int wrong = 0, won = 0;
+        for (int b = 0; b < size.boards; b++) {
+            ms_InitGame(&game, size.rows, size.cols, size.mines, BENCH_SEED + b);
+            wrong += ms_BenchPlay(&game, buckets, &hints, &prob, &fresh_hints, &fresh_prob);
+            won += game.state == ms_GAME_WON;
+        }
+
+        char board[32];
+        snprintf(board, sizeof(board), "%dx%d/%d", size.rows, size.cols, size.mines);
+        for (int k = 0; k < BENCH_BUCKETS; k++) {
+            ms_BenchBucket *b = &buckets[k];
+            if (b->count == 0) {
+                continue;
+            }
+            qsort(b->times, b->count, sizeof(double), ms_CompareTime);
+            double sum = 0;
+            for (size_t i = 0; i < b->count; i++) {
+                sum += b->times[i];
+            }
+            char progress[32];
+            snprintf(progress, sizeof(progress), "%d-%d%%", k * 100 / BENCH_BUCKETS, (k + 1) * 100 / BENCH_BUCKETS);
+            printf("%-20s %-9s %10zu %10.2f %10.2f %10.1f %12.1f\n", board, progress, b->count,
+                   sum / b->count * 1e6, b->times[(size_t)(b->count * 0.99)] * 1e6, b->times[b->count - 1] * 1e6,
+                   b->rescans ? b->rescan / b->rescans * 1e6 : NAN);
+            free(b->times);
+        }
+        printf("%-20s %d of %d boards won\n", board, won, size.boards);
+        if (wrong > 0) {
+            printf("MISMATCH: %d hints were wrong\n", wrong);
+            ok = false;
+        }
+        ms_FreeGame(&game);
+    }
+    ms_HintFree(&hints);
+    ms_HintFree(&fresh_hints);
+    ms_ProbFree(&prob);
+    ms_ProbFree(&fresh_prob);
+    return ok ? 0 : 1;
+}
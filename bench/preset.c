@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "minesweeper.h"
+#include "count.h"
+#include "preset.h"
+
+/* Preset kernel benchmark.
+ * Runs every preset once with its specialised kernels and once with the
+ * generic code (game.preset forced to ms_CUSTOM) on the same seeds:
+ * neighbour counts, the zero region of the first click, the full win scan,
+ * and whole headless games in which a bot clicks random hidden cells until it
+ * wins or hits a mine. Both runs have to end in the same boards. */
+
+#define BENCH_BOARDS 50000
+#define BENCH_REPEAT 32
+#define BENCH_GAMES  200000
+#define BENCH_SEED   1234
+
+typedef struct {
+    double count;
+    double expand;
+    double scan;
+    double games;
+    uint64_t fingerprint;
+} ms_BenchRun;
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void ms_BenchInit(ms_Game *game, ms_Difficulty difficulty, bool generic, uint64_t seed) {
+    ms_InitDifficulty(game, difficulty, seed);
+    if (generic) {
+        game->preset = ms_CUSTOM;
+    }
+}
+
+static uint64_t ms_BenchHash(uint64_t hash, const ms_Game *game) {
+    size_t words = (size_t)game->rows * game->stride;
+    for (size_t i = 0; i < words; i++) {
+        hash = (hash ^ game->revealed[i] ^ (game->flagged[i] << 1) ^ (game->counts[4 * i] << 2)) * 0x100000001b3ULL;
+    }
+    return hash ^ game->state;
+}
+
+static ms_BenchRun ms_BenchPreset(ms_Game *game, ms_Difficulty difficulty, bool generic) {
+    ms_BenchRun run = { .fingerprint = 0xcbf29ce484222325ULL };
+    ms_BenchInit(game, difficulty, generic, BENCH_SEED);
+    ms_Pos first = { .x = game->cols / 2, .y = game->rows / 2 };
+
+    for (int b = 0; b < BENCH_BOARDS; b++) {
+        ms_BenchInit(game, difficulty, generic, BENCH_SEED + b);
+        ms_InitGameData(game, &first);
+        game->first_click_done = true;
+        // counting and scanning change nothing, so they repeat to outlast the clock
+        double t0 = ms_Now();
+        for (int k = 0; k < BENCH_REPEAT; k++) {
+            ms_CountNeighbours(game);
+        }
+        double t1 = ms_Now();
+        ms_ExpandZeros(game, first);
+        double t2 = ms_Now();
+        bool won = false;
+        for (int k = 0; k < BENCH_REPEAT; k++) {
+            won ^= ms_ScanGameWon(game);
+        }
+        run.count += (t1 - t0) / BENCH_REPEAT;
+        run.expand += t2 - t1;
+        run.scan += (ms_Now() - t2) / BENCH_REPEAT;
+        run.fingerprint = ms_BenchHash(run.fingerprint, game) ^ won;
+    }
+
+    uint64_t rng = BENCH_SEED;
+    double t0 = ms_Now();
+    for (int g = 0; g < BENCH_GAMES; g++) {
+        ms_BenchInit(game, difficulty, generic, BENCH_SEED + g);
+        ms_ClickCell(game, &first);
+        while (game->state == ms_PLAYING) {
+            ms_Pos pos;
+            do {
+                rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+                pos = ms_PosXY((rng >> 33) % game->cols, (rng >> 17) % game->rows);
+            } while (ms_IsRevealed(game, pos.x, pos.y));
+            ms_ClickCell(game, &pos);
+        }
+        run.fingerprint = ms_BenchHash(run.fingerprint, game);
+    }
+    run.games = ms_Now() - t0;
+    return run;
+}
+
+int main() {
+    const char *names[] = { "beginner", "intermediate", "expert" };
+    ms_Game game = {0};
+    bool ok = true;
+
+    printf("%-13s %-12s %12s %12s %12s %12s\n",
+           "preset", "kernels", "count ns", "expand ns", "scan ns", "games/s");
+    for (ms_Difficulty d = ms_BEGINNER; d < ms_CUSTOM; d++) {
+        ms_BenchRun runs[2];
+        for (int generic = 1; generic >= 0; generic--) {
+            ms_BenchRun *run = &runs[generic];
+            *run = ms_BenchPreset(&game, d, generic);
+            printf("%-13s %-12s %12.1f %12.1f %12.1f %12.0f\n", names[d], generic ? "generic" : "specialised",
+                   run->count / BENCH_BOARDS * 1e9, run->expand / BENCH_BOARDS * 1e9,
+                   run->scan / BENCH_BOARDS * 1e9, BENCH_GAMES / run->games);
+        }
+        printf("%-13s %-12s %11.2fx %11.2fx %11.2fx %11.2fx%s\n", names[d], "speedup",
+               runs[1].count / runs[0].count, runs[1].expand / runs[0].expand,
+               runs[1].scan / runs[0].scan, runs[1].games / runs[0].games,
+               runs[0].fingerprint == runs[1].fingerprint ? "" : "  MISMATCH");
+        ok = ok && runs[0].fingerprint == runs[1].fingerprint;
+    }
+
+    ms_FreeGame(&game);
+    return ok ? 0 : 1;
+}
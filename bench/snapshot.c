@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "minesweeper.h"
+#include "snapshot.h"
+
+/* Snapshot benchmark on a 2048x2048 board.
+ * Compares ms_TakeSnapshot with copying the revealed and flagged planes, then
+ * times snapshot + move + restore cycles from a board in mid game, where
+ * every move is a click on a safe cell or a flag on a mine, and reports how
+ * many journal bytes a move costs. Every restore is checked against a full
+ * copy of the board. */
+
+#define BENCH_ROWS      2048
+#define BENCH_COLUMNS   2048
+#define BENCH_MINES     864000
+#define BENCH_SNAPSHOTS 10000000
+#define BENCH_COPIES    2000
+#define BENCH_MOVES     200000
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+    ms_Game game = {0};
+    ms_InitGame(&game, BENCH_ROWS, BENCH_COLUMNS, BENCH_MINES, 1234);
+    ms_Pos first = { .x = BENCH_COLUMNS / 2, .y = BENCH_ROWS / 2 };
+    ms_ClickCell(&game, &first);
+
+    // mid game: every safe cell of the top half revealed
+    for (int y = 0; y < BENCH_ROWS / 2; y++) {
+        for (int x = 0; x < BENCH_COLUMNS; x++) {
+            ms_Pos pos = { .x = x, .y = y };
+            if (!ms_IsMine(&game, x, y)) {
+                ms_RevealCell(&game, &pos);
+            }
+        }
+    }
+    ms_ResetDelta(&game);
+
+    size_t words = (size_t)game.rows * game.stride;
+    uint64_t *revealed = malloc(words * sizeof(uint64_t));
+    uint64_t *flagged = malloc(words * sizeof(uint64_t));
+    uint64_t *copy = malloc(2 * words * sizeof(uint64_t));
+    memcpy(revealed, game.revealed, words * sizeof(uint64_t));
+    memcpy(flagged, game.flagged, words * sizeof(uint64_t));
+
+    printf("%-18s %14s %12s %14s\n", "operation", "ops/s", "ns/op", "bytes/op");
+
+    double t0 = ms_Now();
+    for (int i = 0; i < BENCH_SNAPSHOTS; i++) {
+        ms_Snapshot snapshot = ms_TakeSnapshot(&game);
+        __asm__ volatile("" : : "g"(&snapshot) : "memory");
+    }
+    double took = (ms_Now() - t0) / BENCH_SNAPSHOTS;
+    printf("%-18s %14.0f %12.1f %14d\n", "snapshot", 1.0 / took, took * 1e9, 0);
+
+    t0 = ms_Now();
+    for (int i = 0; i < BENCH_COPIES; i++) {
+        memcpy(copy, game.revealed, words * sizeof(uint64_t));
+        memcpy(copy + words, game.flagged, words * sizeof(uint64_t));
+        __asm__ volatile("" : : "g"(copy) : "memory");
+    }
+    took = (ms_Now() - t0) / BENCH_COPIES;
+    printf("%-18s %14.0f %12.1f %14zu\n", "full copy", 1.0 / took, took * 1e9, 2 * words * sizeof(uint64_t));
+
+    // moves on cells still hidden, the same sequence for both runs
+    ms_Pos *moves = malloc(BENCH_MOVES * sizeof(ms_Pos));
+    uint64_t rng = 42;
+    for (int i = 0; i < BENCH_MOVES; i++) {
+        do {
+            rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+            moves[i] = (ms_Pos) { .x = (rng >> 20) % BENCH_COLUMNS, .y = (rng >> 44) % BENCH_ROWS };
+        } while (ms_IsRevealed(&game, moves[i].x, moves[i].y));
+    }
+
+    bool ok = true;
+    size_t journaled = 0;
+    double move_time = 0;
+    t0 = ms_Now();
+    for (int i = 0; i < BENCH_MOVES; i++) {
+        ms_Snapshot snapshot = ms_TakeSnapshot(&game);
+        double m0 = ms_Now();
+        if (ms_IsMine(&game, moves[i].x, moves[i].y)) {
+            ms_MarkCell(&game, &moves[i]);
+        } else {
+            ms_ClickCell(&game, &moves[i]);
+        }
+        move_time += ms_Now() - m0;
+        journaled += ms_JournalBytes(&game);
+        ok = ok && ms_RestoreSnapshot(&game, &snapshot);
+    }
+    took = (ms_Now() - t0) / BENCH_MOVES;
+    move_time /= BENCH_MOVES;
+    printf("%-18s %14.0f %12.1f %14zu\n", "move + undo", 1.0 / took, took * 1e9, journaled / BENCH_MOVES);
+    printf("%-18s %14.0f %12.1f %14s\n", "  of which move", 1.0 / move_time, move_time * 1e9, "-");
+
+    ok = ok && memcmp(revealed, game.revealed, words * sizeof(uint64_t)) == 0
+            && memcmp(flagged, game.flagged, words * sizeof(uint64_t)) == 0
+            && ms_CheckGameWon(&game) == ms_ScanGameWon(&game);
+    if (!ok) {
+        printf("MISMATCH: the board differs after undoing every move\n");
+    }
+
+    free(moves);
+    free(copy);
+    free(flagged);
+    free(revealed);
+    ms_FreeGame(&game);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "minesweeper.h"
+#include "solver.h"
+
+/* Solver benchmark.
+ * Plays boards from a click in the middle until the solver wins, loses (which
+ * would be a solver bug) or has to guess, and reports how many boards it
+ * solves per second and the average time per move. */
+
+typedef struct {
+    const char *name;
+    int rows;
+    int cols;
+    int mines;
+    int boards;
+} ms_BenchSize;
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+    uint64_t seed = argc > 1 ? strtoull(argv[1], NULL, 0) : 1;
+
+    ms_BenchSize sizes[] = {
+        { "beginner",     BEGINNER_ROWS,     BEGINNER_COLUMNS,     BEGINNER_MINE_COUNT,     20000 },
+        { "intermediate", INTERMEDIATE_ROWS, INTERMEDIATE_COLUMNS, INTERMEDIATE_MINE_COUNT, 20000 },
+        { "expert",       EXPERT_ROWS,       EXPERT_COLUMNS,       EXPERT_MINE_COUNT,       20000 },
+        { "1000x1000",    1000,              1000,                 150000,                  5     },
+    };
+
+    ms_Game game = {0};
+    ms_Solver solver = {0};
+    bool ok = true;
+
+    printf("%-12s %8s %8s %8s %14s %12s %10s\n",
+           "size", "boards", "solved", "lost", "solved/s", "ns/move", "aborted");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        ms_BenchSize *size = &sizes[s];
+        ms_Pos first = { .x = size->cols / 2, .y = size->rows / 2 };
+        int solved = 0;
+        int lost = 0;
+        size_t moves = 0;
+        size_t aborted = 0;
+
+        double t0 = ms_Now();
+        for (int b = 0; b < size->boards; b++) {
+            ms_InitGame(&game, size->rows, size->cols, size->mines, seed++);
+            ms_SolverInit(&solver, &game);
+            ms_ClickCell(&game, &first);
+            ms_RevealDelta delta = ms_GameDelta(&game);
+            ms_SolverUpdate(&solver, &game, delta.cells, delta.count);
+
+            switch (ms_SolverPlay(&solver, &game)) {
+                case ms_GAME_WON: solved++; break;
+                case ms_GAME_OVER: lost++; break;
+                case ms_PLAYING: break;
+            }
+            moves += solver.stats.moves + 1;
+            aborted += solver.stats.aborted;
+        }
+        double elapsed = ms_Now() - t0;
+
+        ok = ok && lost == 0;
+        printf("%-12s %8d %8d %8d %14.0f %12.0f %10zu\n",
+               size->name, size->boards, solved, lost,
+               solved / elapsed, elapsed / moves * 1e9, aborted);
+    }
+
+    ms_SolverFree(&solver);
+    ms_FreeGame(&game);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "minesweeper.h"
+#include "world.h"
+
+/* Endless board benchmark.
+ * A bot plays a long session on a strip three chunks tall: it walks east for
+ * half the moves and back west for the rest, clicking random cells around
+ * itself, and flags a cell instead when it holds a mine, so it never loses.
+ * The same session runs with chunk caches of several sizes. Small caches have
+ * to store and restore the chunks behind the bot; every run has to end in the
+ * same board. */
+
+#define BENCH_SEED            1234
+#define BENCH_MOVES           400000
+#define BENCH_MOVES_PER_CHUNK 400
+#define BENCH_BAND_CHUNKS     3
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*Cell of move `i`: around the bot, which moves a cell every
+ * BENCH_MOVES_PER_CHUNK / MS_CHUNK_SIZE moves.*/
+static ms_Pos ms_BenchMove(int i, uint64_t *rng) {
+    int steps = i < BENCH_MOVES / 2 ? i : BENCH_MOVES - i;
+    int walker = steps * MS_CHUNK_SIZE / BENCH_MOVES_PER_CHUNK;
+    *rng = *rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    int span = BENCH_BAND_CHUNKS * MS_CHUNK_SIZE;
+    return (ms_Pos) {
+        .x = walker - span / 2 + (int)((*rng >> 33) % span),
+        .y = (int)((*rng >> 17) % span),
+    };
+}
+
+static uint64_t ms_BenchHash(ms_World *world) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    int chunks = BENCH_MOVES / 2 / BENCH_MOVES_PER_CHUNK + BENCH_BAND_CHUNKS;
+    for (int cx = -BENCH_BAND_CHUNKS; cx <= chunks; cx++) {
+        for (int cy = 0; cy < BENCH_BAND_CHUNKS; cy++) {
+            const ms_Chunk *chunk = ms_WorldChunk(world, cx, cy);
+            for (int r = 0; r < MS_CHUNK_SIZE; r++) {
+                hash = (hash ^ chunk->revealed[r] ^ (chunk->flagged[r] << 1)) * 0x100000001b3ULL;
+            }
+        }
+    }
+    return hash ^ world->revealed_count ^ world->state;
+}
+
+int main() {
+    const int caches[] = { 16, 64, 256, 4096 };
+    int cache_count = sizeof(caches) / sizeof(caches[0]);
+    uint64_t expected = 0;
+    bool ok = true;
+
+    printf("%-8s %12s %10s %10s %10s %10s %12s %12s\n", "chunks", "moves/s", "ns/move",
+           "generated", "stored", "restored", "memory KiB", "store KiB");
+    for (int c = 0; c < cache_count; c++) {
+        ms_World world = {0};
+        if (!ms_WorldInit(&world, BENCH_SEED, MS_WORLD_DEFAULT_MINES, caches[c])) {
+            fprintf(stderr, "could not set up the world\n");
+            return 1;
+        }
+        uint64_t rng = BENCH_SEED;
+        double t0 = ms_Now();
+        for (int i = 0; i < BENCH_MOVES; i++) {
+            ms_Pos pos = ms_BenchMove(i, &rng);
+            // the first click is always safe, later ones are checked
+            if (world.started && ms_WorldAt(&world, pos.x, pos.y).value == MINE) {
+                if (!ms_WorldAt(&world, pos.x, pos.y).flagged) {
+                    ms_WorldMark(&world, &pos);
+                }
+            } else {
+                ms_WorldClick(&world, &pos);
+            }
+        }
+        double took = (ms_Now() - t0) / BENCH_MOVES;
+        printf("%-8d %12.0f %10.1f %10llu %10llu %10llu %12zu %12llu\n", caches[c], 1.0 / took, took * 1e9,
+               (unsigned long long)world.stats.generated, (unsigned long long)world.stats.stored,
+               (unsigned long long)world.stats.restored, ms_WorldBytes(&world) / 1024,
+               (unsigned long long)world.store_size / 1024);
+
+        uint64_t hash = ms_BenchHash(&world);
+        if (c == 0) {
+            expected = hash;
+            printf("revealed %llu cells, %lld flags, %s\n", (unsigned long long)world.revealed_count,
+                   (long long)world.flag_count, world.state == ms_PLAYING ? "still playing" : "lost");
+        } else if (hash != expected) {
+            printf("MISMATCH: the board differs from the %d chunk run\n", caches[0]);
+            ok = false;
+        }
+        ms_WorldFree(&world);
+    }
+    return ok ? 0 : 1;
+}
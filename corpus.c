@@ -0,0 +1,145 @@
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "corpus.h"
+#include "arena.h"
+
+_Static_assert(sizeof(ms_CorpusHeader) == MS_CORPUS_HEADER_SIZE, "corpus header must be 64 bytes");
+_Static_assert(sizeof(ms_CorpusRecord) == 64, "corpus record header must be 64 bytes");
+
+
+static size_t ms_CorpusRecordSize(int rows, int columns) {
+    size_t words = (size_t)rows * ((columns + 63) / 64);
+    return sizeof(ms_CorpusRecord) + ms_ArenaAlignUp(words * sizeof(uint64_t));
+}
+
+/*Creates the corpus file at `path` for boards of one size. Returns false if
+ * the size is not one ms_InitGame accepts or the file can not be written.*/
+bool ms_CorpusCreate(ms_CorpusWriter *writer, const char *path, int rows, int columns, int mines) {
+    *writer = (ms_CorpusWriter) {0};
+    if (rows <= 0 || columns <= 0 || rows > MS_MAX_SIDE || columns > MS_MAX_SIDE ||
+        mines < 0 || (size_t)mines + 9 > (size_t)rows * columns)
+    {
+        return false;
+    }
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        return false;
+    }
+    memcpy(writer->header.magic, MS_CORPUS_MAGIC, 4);
+    writer->header.version = MS_CORPUS_VERSION;
+    writer->header.rows = rows;
+    writer->header.cols = columns;
+    writer->header.stride = (columns + 63) / 64;
+    writer->header.mines = mines;
+    writer->header.record_size = ms_CorpusRecordSize(rows, columns);
+    return fwrite(&writer->header, sizeof(writer->header), 1, writer->file) == 1;
+}
+
+/*Appends the mines of `game`, which has the corpus' size and had its first
+ * click at `first`.*/
+bool ms_CorpusAppend(ms_CorpusWriter *writer, const ms_Game *game, ms_Pos first) {
+    if (!writer->file || game->rows != (int)writer->header.rows || game->cols != (int)writer->header.cols ||
+        game->mine_count != (int)writer->header.mines)
+    {
+        return false;
+    }
+    ms_CorpusRecord record = {
+        .seed = game->seed,
+        .first_x = first.x,
+        .first_y = first.y,
+    };
+    size_t plane = (size_t)game->rows * game->stride * sizeof(uint64_t);
+    static const uint8_t zeros[MS_ARENA_ALIGN] = {0};
+    size_t padding = writer->header.record_size - sizeof(record) - plane;
+    if (fwrite(&record, sizeof(record), 1, writer->file) != 1 ||
+        fwrite(game->mines, 1, plane, writer->file) != plane ||
+        fwrite(zeros, 1, padding, writer->file) != padding)
+    {
+        return false;
+    }
+    writer->header.count++;
+    return true;
+}
+
+/*Writes the final record count and closes the file.*/
+bool ms_CorpusFinish(ms_CorpusWriter *writer) {
+    if (!writer->file) {
+        return false;
+    }
+    bool ok = fseek(writer->file, 0, SEEK_SET) == 0 &&
+              fwrite(&writer->header, sizeof(writer->header), 1, writer->file) == 1;
+    ok = fclose(writer->file) == 0 && ok;
+    *writer = (ms_CorpusWriter) {0};
+    return ok;
+}
+
+/*Maps the corpus at `path` and checks its header against the file size.*/
+bool ms_CorpusOpen(ms_Corpus *corpus, const char *path) {
+    *corpus = (ms_Corpus) {0};
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= MS_CORPUS_HEADER_SIZE) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    corpus->data = data;
+    corpus->size = st.st_size;
+    corpus->header = data;
+
+    const ms_CorpusHeader *h = corpus->header;
+    bool valid = memcmp(h->magic, MS_CORPUS_MAGIC, 4) == 0 && h->version == MS_CORPUS_VERSION &&
+                 h->rows > 0 && h->rows <= MS_MAX_SIDE && h->cols > 0 && h->cols <= MS_MAX_SIDE &&
+                 (size_t)h->mines + 9 <= (size_t)h->rows * h->cols && h->stride == (h->cols + 63) / 64 &&
+                 h->record_size == ms_CorpusRecordSize(h->rows, h->cols) &&
+                 h->count <= (corpus->size - MS_CORPUS_HEADER_SIZE) / h->record_size;
+    if (!valid) {
+        ms_CorpusClose(corpus);
+        return false;
+    }
+    corpus->count = h->count;
+    madvise(data, corpus->size, MADV_SEQUENTIAL);
+    return true;
+}
+
+void ms_CorpusClose(ms_Corpus *corpus) {
+    if (corpus->data) {
+        munmap((void *)corpus->data, corpus->size);
+    }
+    *corpus = (ms_Corpus) {0};
+}
+
+const ms_CorpusRecord *ms_CorpusAt(const ms_Corpus *corpus, size_t index) {
+    if (index >= corpus->count) {
+        return NULL;
+    }
+    return (const ms_CorpusRecord *)(corpus->data + MS_CORPUS_HEADER_SIZE + index * corpus->header->record_size);
+}
+
+/*Sets `game` up with board `index` of the corpus without copying its mines:
+ * the board reads them straight from the mapping, which has to stay open while
+ * the board is in use. `first` receives the recorded first click, which the
+ * caller still has to play. Returns false for a first click off the board.*/
+bool ms_CorpusLoad(const ms_Corpus *corpus, size_t index, ms_Game *game, ms_Pos *first) {
+    const ms_CorpusRecord *record = ms_CorpusAt(corpus, index);
+    const ms_CorpusHeader *h = corpus->header;
+    // the click is played without bounds checks, so a damaged record stops here
+    if (!record || record->first_x >= h->cols || record->first_y >= h->rows ||
+        !ms_InitGame(game, h->rows, h->cols, h->mines, record->seed))
+    {
+        return false;
+    }
+    ms_AttachMines(game, (const uint64_t *)(record + 1));
+    *first = ms_PosXY(record->first_x, record->first_y);
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "minesweeper.h"
+
+/* Board corpus: many boards of one size in a single file, read through a
+ * memory mapping.
+ *
+ * The file starts with a 64-byte ms_CorpusHeader (dimensions, mine count,
+ * record size and count), followed by `count` records of `record_size` bytes
+ * each, so record i sits at MS_CORPUS_HEADER_SIZE + i * record_size. A record
+ * is a 64-byte ms_CorpusRecord (seed and first click) followed by the mines
+ * plane in the game's own layout: `rows * stride` 64-bit words, one bit per
+ * cell. Records are 64-byte aligned, so ms_CorpusLoad can point a board
+ * straight at the plane in the mapping.
+ *
+ * The header and records are stored in host byte order. */
+
+#define MS_CORPUS_MAGIC       "MSBC"
+#define MS_CORPUS_VERSION     1
+#define MS_CORPUS_HEADER_SIZE 64
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t stride;
+    uint32_t mines;
+    uint64_t record_size;
+    uint64_t count;
+    uint8_t reserved[24];
+} ms_CorpusHeader;
+
+typedef struct {
+    uint64_t seed;
+    uint32_t first_x;
+    uint32_t first_y;
+    uint8_t reserved[48];
+} ms_CorpusRecord;
+
+/* Appends boards to a corpus file. The count in the header is written by
+ * ms_CorpusFinish. */
+typedef struct {
+    FILE *file;
+    ms_CorpusHeader header;
+} ms_CorpusWriter;
+
+/* A mapped corpus. */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    const ms_CorpusHeader *header;
+    size_t count;
+} ms_Corpus;
+
+bool ms_CorpusCreate(ms_CorpusWriter *writer, const char *path, int rows, int columns, int mines);
+bool ms_CorpusAppend(ms_CorpusWriter *writer, const ms_Game *game, ms_Pos first);
+bool ms_CorpusFinish(ms_CorpusWriter *writer);
+
+bool ms_CorpusOpen(ms_Corpus *corpus, const char *path);
+void ms_CorpusClose(ms_Corpus *corpus);
+const ms_CorpusRecord *ms_CorpusAt(const ms_Corpus *corpus, size_t index);
+bool ms_CorpusLoad(const ms_Corpus *corpus, size_t index, ms_Game *game, ms_Pos *first);
+
+#endif // CORPUS_H
@@ -0,0 +1,350 @@
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MS_HAVE_X86 1
+#else
+#define MS_HAVE_X86 0
+#endif
+
+#include "count.h"
+#include "preset.h"
+#include "band.h"
+
+
+/*Vertical pass: u = above + below, t = above + row + below, as 2-bit
+ * bit-sliced numbers. t is stored with a zero guard word on either side so the
+ * horizontal pass can read one word past each end of the row.*/
+static void ms_ColumnSumsScalar(const uint64_t *above, const uint64_t *row, const uint64_t *below,
+                                uint64_t *t0, uint64_t *t1, uint64_t *u0, uint64_t *u1, int from, int stride) {
+    for (int i = from; i < stride; i++) {
+        uint64_t a = above[i], c = row[i], b = below[i];
+        uint64_t s0 = a ^ b;
+        uint64_t s1 = a & b;
+        u0[i] = s0;
+        u1[i] = s1;
+        t0[i + 1] = s0 ^ c;
+        t1[i + 1] = s1 | (s0 & c);
+    }
+}
+
+/*Horizontal pass for words [from, stride): count = t(x-1) + t(x+1) + u(x),
+ * spread into nibbles.*/
+static void ms_RowCountsScalar(const uint64_t *t0, const uint64_t *t1, const uint64_t *u0, const uint64_t *u1,
+                               uint64_t *out, int from, int stride) {
+    for (int i = from; i < stride; i++) {
+        uint64_t l0 = (t0[i + 1] << 1) | (t0[i] >> 63);
+        uint64_t l1 = (t1[i + 1] << 1) | (t1[i] >> 63);
+        uint64_t r0 = (t0[i + 1] >> 1) | (t0[i + 2] << 63);
+        uint64_t r1 = (t1[i + 1] >> 1) | (t1[i + 2] << 63);
+
+        // s = l + r (0..6)
+        uint64_t c = l0 & r0;
+        uint64_t s0 = l0 ^ r0;
+        uint64_t s1 = l1 ^ r1 ^ c;
+        uint64_t s2 = (l1 & r1) | (c & (l1 ^ r1));
+
+        // n = s + u (0..8)
+        uint64_t c0 = s0 & u0[i];
+        uint64_t n0 = s0 ^ u0[i];
+        uint64_t n1 = s1 ^ u1[i] ^ c0;
+        uint64_t c1 = (s1 & u1[i]) | (c0 & (s1 ^ u1[i]));
+        uint64_t n2 = s2 ^ c1;
+        uint64_t n3 = s2 & c1;
+
+        for (int k = 0; k < 4; k++) {
+            int shift = 16 * k;
+            out[4 * i + k] = ms_Spread16(n0 >> shift)
+                           | ms_Spread16(n1 >> shift) << 1
+                           | ms_Spread16(n2 >> shift) << 2
+                           | ms_Spread16(n3 >> shift) << 3;
+        }
+    }
+}
+
+#if MS_HAVE_X86
+
+__attribute__((target("sse2")))
+static inline __m128i ms_Spread16SSE2(__m128i x, int shift) {
+    x = _mm_and_si128(_mm_srli_epi64(x, shift), _mm_set1_epi64x(0xFFFF));
+    x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 24)), _mm_set1_epi64x(0x000000FF000000FFLL));
+    x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 12)), _mm_set1_epi64x(0x000F000F000F000FLL));
+    x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 6)),  _mm_set1_epi64x(0x0303030303030303LL));
+    x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 3)),  _mm_set1_epi64x(0x1111111111111111LL));
+    return x;
+}
+
+__attribute__((target("sse2")))
+static int ms_ColumnSumsSSE2(const uint64_t *above, const uint64_t *row, const uint64_t *below,
+                             uint64_t *t0, uint64_t *t1, uint64_t *u0, uint64_t *u1, int stride) {
+    int i = 0;
+    for (; i + 2 <= stride; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(above + i));
+        __m128i c = _mm_loadu_si128((const __m128i *)(row + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(below + i));
+        __m128i s0 = _mm_xor_si128(a, b);
+        __m128i s1 = _mm_and_si128(a, b);
+        _mm_storeu_si128((__m128i *)(u0 + i), s0);
+        _mm_storeu_si128((__m128i *)(u1 + i), s1);
+        _mm_storeu_si128((__m128i *)(t0 + i + 1), _mm_xor_si128(s0, c));
+        _mm_storeu_si128((__m128i *)(t1 + i + 1), _mm_or_si128(s1, _mm_and_si128(s0, c)));
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+static int ms_RowCountsSSE2(const uint64_t *t0, const uint64_t *t1, const uint64_t *u0, const uint64_t *u1,
+                            uint64_t *out, int stride) {
+    int i = 0;
+    for (; i + 2 <= stride; i += 2) {
+        __m128i t0c = _mm_loadu_si128((const __m128i *)(t0 + i + 1));
+        __m128i t1c = _mm_loadu_si128((const __m128i *)(t1 + i + 1));
+        __m128i l0 = _mm_or_si128(_mm_slli_epi64(t0c, 1), _mm_srli_epi64(_mm_loadu_si128((const __m128i *)(t0 + i)), 63));
+        __m128i l1 = _mm_or_si128(_mm_slli_epi64(t1c, 1), _mm_srli_epi64(_mm_loadu_si128((const __m128i *)(t1 + i)), 63));
+        __m128i r0 = _mm_or_si128(_mm_srli_epi64(t0c, 1), _mm_slli_epi64(_mm_loadu_si128((const __m128i *)(t0 + i + 2)), 63));
+        __m128i r1 = _mm_or_si128(_mm_srli_epi64(t1c, 1), _mm_slli_epi64(_mm_loadu_si128((const __m128i *)(t1 + i + 2)), 63));
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(u0 + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(u1 + i));
+
+        __m128i c = _mm_and_si128(l0, r0);
+        __m128i s0 = _mm_xor_si128(l0, r0);
+        __m128i s1 = _mm_xor_si128(_mm_xor_si128(l1, r1), c);
+        __m128i s2 = _mm_or_si128(_mm_and_si128(l1, r1), _mm_and_si128(c, _mm_xor_si128(l1, r1)));
+
+        __m128i c0 = _mm_and_si128(s0, v0);
+        __m128i n0 = _mm_xor_si128(s0, v0);
+        __m128i n1 = _mm_xor_si128(_mm_xor_si128(s1, v1), c0);
+        __m128i c1 = _mm_or_si128(_mm_and_si128(s1, v1), _mm_and_si128(c0, _mm_xor_si128(s1, v1)));
+        __m128i n2 = _mm_xor_si128(s2, c1);
+        __m128i n3 = _mm_and_si128(s2, c1);
+
+        __m128i o[4];
+        for (int k = 0; k < 4; k++) {
+            int shift = 16 * k;
+            o[k] = _mm_or_si128(
+                _mm_or_si128(ms_Spread16SSE2(n0, shift), _mm_slli_epi64(ms_Spread16SSE2(n1, shift), 1)),
+                _mm_or_si128(_mm_slli_epi64(ms_Spread16SSE2(n2, shift), 2), _mm_slli_epi64(ms_Spread16SSE2(n3, shift), 3)));
+        }
+        // lane j of o[k] belongs at out[4 * (i + j) + k]
+        _mm_storeu_si128((__m128i *)(out + 4 * i),     _mm_unpacklo_epi64(o[0], o[1]));
+        _mm_storeu_si128((__m128i *)(out + 4 * i + 2), _mm_unpacklo_epi64(o[2], o[3]));
+        _mm_storeu_si128((__m128i *)(out + 4 * i + 4), _mm_unpackhi_epi64(o[0], o[1]));
+        _mm_storeu_si128((__m128i *)(out + 4 * i + 6), _mm_unpackhi_epi64(o[2], o[3]));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i ms_Spread16AVX2(__m256i x, int shift) {
+    x = _mm256_and_si256(_mm256_srli_epi64(x, shift), _mm256_set1_epi64x(0xFFFF));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 24)), _mm256_set1_epi64x(0x000000FF000000FFLL));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 12)), _mm256_set1_epi64x(0x000F000F000F000FLL));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 6)),  _mm256_set1_epi64x(0x0303030303030303LL));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 3)),  _mm256_set1_epi64x(0x1111111111111111LL));
+    return x;
+}
+
+__attribute__((target("avx2")))
+static int ms_ColumnSumsAVX2(const uint64_t *above, const uint64_t *row, const uint64_t *below,
+                             uint64_t *t0, uint64_t *t1, uint64_t *u0, uint64_t *u1, int stride) {
+    int i = 0;
+    for (; i + 4 <= stride; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(above + i));
+        __m256i c = _mm256_loadu_si256((const __m256i *)(row + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(below + i));
+        __m256i s0 = _mm256_xor_si256(a, b);
+        __m256i s1 = _mm256_and_si256(a, b);
+        _mm256_storeu_si256((__m256i *)(u0 + i), s0);
+        _mm256_storeu_si256((__m256i *)(u1 + i), s1);
+        _mm256_storeu_si256((__m256i *)(t0 + i + 1), _mm256_xor_si256(s0, c));
+        _mm256_storeu_si256((__m256i *)(t1 + i + 1), _mm256_or_si256(s1, _mm256_and_si256(s0, c)));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int ms_RowCountsAVX2(const uint64_t *t0, const uint64_t *t1, const uint64_t *u0, const uint64_t *u1,
+                            uint64_t *out, int stride) {
+    int i = 0;
+    for (; i + 4 <= stride; i += 4) {
+        __m256i t0c = _mm256_loadu_si256((const __m256i *)(t0 + i + 1));
+        __m256i t1c = _mm256_loadu_si256((const __m256i *)(t1 + i + 1));
+        __m256i l0 = _mm256_or_si256(_mm256_slli_epi64(t0c, 1), _mm256_srli_epi64(_mm256_loadu_si256((const __m256i *)(t0 + i)), 63));
+        __m256i l1 = _mm256_or_si256(_mm256_slli_epi64(t1c, 1), _mm256_srli_epi64(_mm256_loadu_si256((const __m256i *)(t1 + i)), 63));
+        __m256i r0 = _mm256_or_si256(_mm256_srli_epi64(t0c, 1), _mm256_slli_epi64(_mm256_loadu_si256((const __m256i *)(t0 + i + 2)), 63));
+        __m256i r1 = _mm256_or_si256(_mm256_srli_epi64(t1c, 1), _mm256_slli_epi64(_mm256_loadu_si256((const __m256i *)(t1 + i + 2)), 63));
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)(u0 + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(u1 + i));
+
+        __m256i c = _mm256_and_si256(l0, r0);
+        __m256i s0 = _mm256_xor_si256(l0, r0);
+        __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(l1, r1), c);
+        __m256i s2 = _mm256_or_si256(_mm256_and_si256(l1, r1), _mm256_and_si256(c, _mm256_xor_si256(l1, r1)));
+
+        __m256i c0 = _mm256_and_si256(s0, v0);
+        __m256i n0 = _mm256_xor_si256(s0, v0);
+        __m256i n1 = _mm256_xor_si256(_mm256_xor_si256(s1, v1), c0);
+        __m256i c1 = _mm256_or_si256(_mm256_and_si256(s1, v1), _mm256_and_si256(c0, _mm256_xor_si256(s1, v1)));
+        __m256i n2 = _mm256_xor_si256(s2, c1);
+        __m256i n3 = _mm256_and_si256(s2, c1);
+
+        __m256i o[4];
+        for (int k = 0; k < 4; k++) {
+            int shift = 16 * k;
+            o[k] = _mm256_or_si256(
+                _mm256_or_si256(ms_Spread16AVX2(n0, shift), _mm256_slli_epi64(ms_Spread16AVX2(n1, shift), 1)),
+                _mm256_or_si256(_mm256_slli_epi64(ms_Spread16AVX2(n2, shift), 2), _mm256_slli_epi64(ms_Spread16AVX2(n3, shift), 3)));
+        }
+        // 4x4 transpose: lane j of o[k] belongs at out[4 * (i + j) + k]
+        __m256i a = _mm256_unpacklo_epi64(o[0], o[1]);
+        __m256i b = _mm256_unpackhi_epi64(o[0], o[1]);
+        __m256i c2 = _mm256_unpacklo_epi64(o[2], o[3]);
+        __m256i d = _mm256_unpackhi_epi64(o[2], o[3]);
+        _mm256_storeu_si256((__m256i *)(out + 4 * i),      _mm256_permute2x128_si256(a, c2, 0x20));
+        _mm256_storeu_si256((__m256i *)(out + 4 * i + 4),  _mm256_permute2x128_si256(b, d, 0x20));
+        _mm256_storeu_si256((__m256i *)(out + 4 * i + 8),  _mm256_permute2x128_si256(a, c2, 0x31));
+        _mm256_storeu_si256((__m256i *)(out + 4 * i + 12), _mm256_permute2x128_si256(b, d, 0x31));
+    }
+    return i;
+}
+
+#endif // MS_HAVE_X86
+
+/*Computes the counts of rows [y0, y1) of a rows x cols board. Rows y0-1 and
+ * y1 are read as halo rows when they exist, so disjoint row ranges can be
+ * counted independently. `scratch` needs MS_COUNT_SCRATCH_WORDS(stride) words.*/
+void ms_CountRows(ms_CountKernel kernel, const uint64_t *mines, uint64_t *counts,
+                  int rows, int cols, int stride, int y0, int y1, uint64_t *scratch) {
+    uint64_t *t0 = scratch;
+    uint64_t *t1 = t0 + stride + 2;
+    uint64_t *u0 = t1 + stride + 2;
+    uint64_t *u1 = u0 + stride;
+    uint64_t *zero = u1 + stride;
+    memset(zero, 0, stride * sizeof(uint64_t));
+    t0[0] = t1[0] = t0[stride + 1] = t1[stride + 1] = 0;
+
+    // nibbles past the last column are kept at zero
+    int rest = cols - (stride - 1) * 64;
+    uint64_t tail = rest >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << rest) - 1;
+    uint64_t tail_nibbles[4];
+    for (int k = 0; k < 4; k++) {
+        tail_nibbles[k] = ms_Spread16(tail >> (16 * k)) * 0xF;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        const uint64_t *row = mines + (size_t)y * stride;
+        const uint64_t *above = y > 0 ? row - stride : zero;
+        const uint64_t *below = y + 1 < rows ? row + stride : zero;
+        uint64_t *out = counts + (size_t)y * stride * 4;
+
+        int done = 0;
+        switch (kernel) {
+#if MS_HAVE_X86
+            case ms_KERNEL_AVX2:
+                done = ms_ColumnSumsAVX2(above, row, below, t0, t1, u0, u1, stride);
+                break;
+            case ms_KERNEL_SSE2:
+                done = ms_ColumnSumsSSE2(above, row, below, t0, t1, u0, u1, stride);
+                break;
+#endif
+            default:
+                break;
+        }
+        ms_ColumnSumsScalar(above, row, below, t0, t1, u0, u1, done, stride);
+
+        done = 0;
+        switch (kernel) {
+#if MS_HAVE_X86
+            case ms_KERNEL_AVX2:
+                done = ms_RowCountsAVX2(t0, t1, u0, u1, out, stride);
+                break;
+            case ms_KERNEL_SSE2:
+                done = ms_RowCountsSSE2(t0, t1, u0, u1, out, stride);
+                break;
+#endif
+            default:
+                break;
+        }
+        ms_RowCountsScalar(t0, t1, u0, u1, out, done, stride);
+
+        for (int k = 0; k < 4; k++) {
+            out[4 * (stride - 1) + k] &= tail_nibbles[k];
+        }
+    }
+}
+
+void ms_CountNeighboursWith(ms_Game *game, ms_CountKernel kernel) {
+    ms_CountRows(kernel, game->mines, game->counts, game->rows, game->cols, game->stride,
+                 0, game->rows, game->count_scratch);
+}
+
+/*Counts with the board's preset kernel if it has one, else the widest kernel
+ * the CPU supports.*/
+void ms_CountNeighbours(ms_Game *game) {
+    if (game->preset != ms_CUSTOM) {
+        ms_PresetKernelTable[game->preset].count(game);
+        return;
+    }
+    if (game->band_pool && ms_BandedSize(game->rows, game->cols)) {
+        ms_CountNeighboursBanded(game);
+        return;
+    }
+    ms_CountNeighboursWith(game, ms_BestCountKernel());
+}
+
+/*The original per-mine loop: bumps the count of all 8 neighbours of every mine.
+ * Kept as the ground truth the kernels are checked against.*/
+void ms_CountNeighboursReference(ms_Game *game) {
+    memset(game->counts, 0, (size_t)game->rows * game->stride * 4 * sizeof(uint64_t));
+    for (int y = 0; y < game->rows; y++) {
+        for (int w = 0; w < game->stride; w++) {
+            uint64_t bits = game->mines[(size_t)y * game->stride + w];
+            while (bits) {
+                ms_Pos mine = { .x = w * 64 + __builtin_ctzll(bits), .y = y };
+                bits &= bits - 1;
+                // mark neighbours
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        if (dy == 0 && dx == 0) {
+                            continue;
+                        }
+                        ms_Pos new_pos = { .x = mine.x + dx, .y = mine.y + dy };
+                        // check out-of-bounds
+                        if (!ms_PosInside(game, &new_pos)) {
+                            continue;
+                        }
+                        size_t i = ms_WordIndex(game, new_pos.x, new_pos.y) * 4 + ((new_pos.x & 63) >> 4);
+                        game->counts[i] += (uint64_t)1 << ((new_pos.x & 15) * 4);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool ms_CountKernelSupported(ms_CountKernel kernel) {
+    switch (kernel) {
+        case ms_KERNEL_SCALAR: return true;
+#if MS_HAVE_X86
+        case ms_KERNEL_SSE2: return __builtin_cpu_supports("sse2");
+        case ms_KERNEL_AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+/*Picks the widest kernel the CPU we are running on supports.*/
+ms_CountKernel ms_BestCountKernel() {
+    if (ms_CountKernelSupported(ms_KERNEL_AVX2)) return ms_KERNEL_AVX2;
+    if (ms_CountKernelSupported(ms_KERNEL_SSE2)) return ms_KERNEL_SSE2;
+    return ms_KERNEL_SCALAR;
+}
+
+const char *ms_CountKernelName(ms_CountKernel kernel) {
+    switch (kernel) {
+        case ms_KERNEL_SCALAR: return "scalar";
+        case ms_KERNEL_SSE2: return "sse2";
+        case ms_KERNEL_AVX2: return "avx2";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef COUNT_H
+#define COUNT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+
+/* Neighbour-count kernels.
+ * All kernels derive the `counts` plane from the `mines` plane a row at a time:
+ * the rows above and below are added bitwise (bit-sliced adders, 64 cells per
+ * word), the column sums are shifted one cell left and right and added again.
+ * The SIMD variants run the same adder network on 2 (SSE2) or 4 (AVX2) words
+ * at once. Every kernel produces exactly the counts the per-mine reference
+ * loop does. */
+
+typedef enum {
+    ms_KERNEL_SCALAR = 0,
+    ms_KERNEL_SSE2,
+    ms_KERNEL_AVX2,
+    ms_KERNEL_COUNT,
+} ms_CountKernel;
+
+/* Scratch words one ms_CountRows call needs for a row of `stride` words. */
+#define MS_COUNT_SCRATCH_WORDS(stride) (5 * (size_t)(stride) + 4)
+
+/*Moves bit i of the low 16 bits of `x` to bit 4*i.*/
+static inline uint64_t ms_Spread16(uint64_t x) {
+    x &= 0xFFFF;
+    x = (x | (x << 24)) & 0x000000FF000000FFULL;
+    x = (x | (x << 12)) & 0x000F000F000F000FULL;
+    x = (x | (x << 6))  & 0x0303030303030303ULL;
+    x = (x | (x << 3))  & 0x1111111111111111ULL;
+    return x;
+}
+
+void ms_CountNeighbours(ms_Game *game);
+void ms_CountNeighboursWith(ms_Game *game, ms_CountKernel kernel);
+void ms_CountNeighboursReference(ms_Game *game);
+
+void ms_CountRows(ms_CountKernel kernel, const uint64_t *mines, uint64_t *counts,
+                  int rows, int cols, int stride, int y0, int y1, uint64_t *scratch);
+
+ms_CountKernel ms_BestCountKernel();
+bool ms_CountKernelSupported(ms_CountKernel kernel);
+const char *ms_CountKernelName(ms_CountKernel kernel);
+
+#endif // COUNT_H
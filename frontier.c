@@ -0,0 +1,175 @@
+#include <stdlib.h>
+
+#include "frontier.h"
+
+
+static void ms_FrontierSet(uint64_t *plane, const ms_Frontier *frontier, int x, int y) {
+    plane[(size_t)y * frontier->stride + (x >> 6)] |= ms_BitMask(x);
+}
+
+static void ms_FrontierClear(uint64_t *plane, const ms_Frontier *frontier, int x, int y) {
+    plane[(size_t)y * frontier->stride + (x >> 6)] &= ~ms_BitMask(x);
+}
+
+static bool ms_FrontierTest(const uint64_t *plane, const ms_Frontier *frontier, int x, int y) {
+    return plane[(size_t)y * frontier->stride + (x >> 6)] & ms_BitMask(x);
+}
+
+/*Allocates the frontier for `game` and builds it from the current board.
+ * Memory is reused when the frontier is initialised again for a board that is
+ * not bigger. Returns false if memory runs out.*/
+bool ms_FrontierInit(ms_Frontier *frontier, const ms_Game *game) {
+    size_t plane = ms_ArenaAlignUp((size_t)game->rows * game->stride * sizeof(uint64_t));
+    if (!ms_ArenaReserve(&frontier->arena, 3 * plane)) {
+        return false;
+    }
+    frontier->active = ms_ArenaAlloc(&frontier->arena, plane);
+    frontier->listed = ms_ArenaAlloc(&frontier->arena, plane);
+    frontier->queued = ms_ArenaAlloc(&frontier->arena, plane);
+    frontier->rows = game->rows;
+    frontier->cols = game->cols;
+    frontier->stride = game->stride;
+    ms_FrontierRebuild(frontier, game);
+    return true;
+}
+
+void ms_FrontierFree(ms_Frontier *frontier) {
+    ms_ArenaFree(&frontier->arena);
+    free(frontier->cells);
+    free(frontier->dirty);
+    *frontier = (ms_Frontier) {0};
+}
+
+/*Hidden cells of bitplane word `w` in row `y`, or nothing outside the board.*/
+static uint64_t ms_HiddenWord(const ms_Game *game, int y, int w) {
+    if (y < 0 || y >= game->rows || w < 0 || w >= game->stride) {
+        return 0;
+    }
+    size_t i = (size_t)y * game->stride + w;
+    return ~(game->revealed[i] | game->flagged[i]) & ms_RowMask(game, w);
+}
+
+/*Hidden cells in the rows y-1, y and y+1 of word `w`.*/
+static uint64_t ms_HiddenColumn(const ms_Game *game, int y, int w) {
+    return ms_HiddenWord(game, y - 1, w) | ms_HiddenWord(game, y, w) | ms_HiddenWord(game, y + 1, w);
+}
+
+/*Recomputes the whole frontier with word operations and marks every frontier
+ * cell dirty. Used when a move changed too many cells to touch them one by one.*/
+void ms_FrontierRebuild(ms_Frontier *frontier, const ms_Game *game) {
+    frontier->count = 0;
+    frontier->dirty_count = 0;
+    for (int y = 0; y < game->rows; y++) {
+        uint64_t prev = 0;
+        uint64_t cur = ms_HiddenColumn(game, y, 0);
+        for (int w = 0; w < game->stride; w++) {
+            uint64_t next = ms_HiddenColumn(game, y, w + 1);
+            // cells with a hidden cell in their 3x3 block
+            uint64_t near = cur | (cur << 1) | (cur >> 1) | (prev >> 63) | (next << 63);
+            size_t i = (size_t)y * game->stride + w;
+            uint64_t active = game->revealed[i] & ~game->mines[i] & near & ms_RowMask(game, w);
+            frontier->active[i] = active;
+            frontier->listed[i] = active;
+            frontier->queued[i] = active;
+
+            size_t n = frontier->count + __builtin_popcountll(active);
+            frontier->cells = ms_Grow(frontier->cells, &frontier->cap, n, sizeof(uint32_t));
+            frontier->dirty = ms_Grow(frontier->dirty, &frontier->dirty_cap, n, sizeof(uint32_t));
+            while (active) {
+                int x = w * 64 + __builtin_ctzll(active);
+                active &= active - 1;
+                uint32_t cell = (uint32_t)((size_t)y * game->cols + x);
+                frontier->cells[frontier->count++] = cell;
+                frontier->dirty[frontier->dirty_count++] = cell;
+            }
+            prev = cur;
+            cur = next;
+        }
+    }
+}
+
+static bool ms_HasHiddenNeighbour(const ms_Game *game, int x, int y) {
+    return ms_WindowHidden(game, x, y) != 0;
+}
+
+/*Re-evaluates a single cell and queues it if it is on the frontier.*/
+static void ms_FrontierUpdate(ms_Frontier *frontier, const ms_Game *game, int x, int y) {
+    bool active = ms_IsRevealed(game, x, y) && !ms_IsMine(game, x, y) &&
+                  ms_HasHiddenNeighbour(game, x, y);
+    if (!active) {
+        ms_FrontierClear(frontier->active, frontier, x, y);
+        return;
+    }
+    ms_FrontierSet(frontier->active, frontier, x, y);
+    if (!ms_FrontierTest(frontier->listed, frontier, x, y)) {
+        ms_FrontierSet(frontier->listed, frontier, x, y);
+        frontier->cells = ms_Grow(frontier->cells, &frontier->cap, frontier->count + 1, sizeof(uint32_t));
+        frontier->cells[frontier->count++] = (uint32_t)((size_t)y * frontier->cols + x);
+    }
+    ms_FrontierQueue(frontier, x, y);
+}
+
+/*Updates the frontier after cell (x, y) was revealed or its flag toggled:
+ * only the cell and its neighbours can change.*/
+void ms_FrontierTouch(ms_Frontier *frontier, const ms_Game *game, int x, int y) {
+    for (unsigned bits = ms_WindowInside(game, x, y); bits; bits &= bits - 1) {
+        int k = __builtin_ctz(bits);
+        ms_FrontierUpdate(frontier, game, x + k % 3 - 1, y + k / 3 - 1);
+    }
+}
+
+/*ms_FrontierTouch for a list of linear cell indices, e.g. a move's delta.*/
+void ms_FrontierTouchCells(ms_Frontier *frontier, const ms_Game *game, const uint32_t *cells, size_t count) {
+    // touching costs ~30 window reads per cell, a rebuild about one word per 64 cells
+    if (count > (size_t)game->rows * game->stride) {
+        ms_FrontierRebuild(frontier, game);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        ms_FrontierTouch(frontier, game, cells[i] % game->cols, cells[i] / game->cols);
+    }
+}
+
+/*Drops the cells that left the frontier from `cells` and returns how many are
+ * left.*/
+size_t ms_FrontierCompact(ms_Frontier *frontier) {
+    size_t kept = 0;
+    for (size_t i = 0; i < frontier->count; i++) {
+        uint32_t cell = frontier->cells[i];
+        int x = cell % frontier->cols;
+        int y = cell / frontier->cols;
+        if (ms_FrontierHas(frontier, x, y)) {
+            frontier->cells[kept++] = cell;
+        } else {
+            ms_FrontierClear(frontier->listed, frontier, x, y);
+        }
+    }
+    frontier->count = kept;
+    return kept;
+}
+
+/*Puts a frontier cell on the dirty list, unless it is already there.*/
+void ms_FrontierQueue(ms_Frontier *frontier, int x, int y) {
+    if (!ms_FrontierHas(frontier, x, y) || ms_FrontierTest(frontier->queued, frontier, x, y)) {
+        return;
+    }
+    ms_FrontierSet(frontier->queued, frontier, x, y);
+    frontier->dirty = ms_Grow(frontier->dirty, &frontier->dirty_cap, frontier->dirty_count + 1, sizeof(uint32_t));
+    frontier->dirty[frontier->dirty_count++] = (uint32_t)((size_t)y * frontier->cols + x);
+}
+
+/*Takes the next dirty cell that is still on the frontier. Returns false once
+ * the dirty list is empty.*/
+bool ms_FrontierPop(ms_Frontier *frontier, uint32_t *cell) {
+    while (frontier->dirty_count) {
+        uint32_t next = frontier->dirty[--frontier->dirty_count];
+        int x = next % frontier->cols;
+        int y = next / frontier->cols;
+        ms_FrontierClear(frontier->queued, frontier, x, y);
+        if (ms_FrontierHas(frontier, x, y)) {
+            *cell = next;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,60 @@
+#ifndef FRONTIER_H
+#define FRONTIER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+
+/* The frontier of a board: revealed, safe cells that still have a hidden
+ * neighbour, i.e. one that is neither revealed nor flagged. These are the only
+ * cells a player can reason from.
+ *
+ * The frontier is built once per board and afterwards only updated around the
+ * cells a move changed (ms_FrontierTouchCells with the move's delta), so its
+ * users never rescan the grid.
+ *
+ * `active` is a bitplane in the game's layout. `cells` lists the active cells
+ * in no particular order; cells that left the frontier are dropped lazily by
+ * ms_FrontierCompact, `listed` marks the cells present in the list.
+ * `dirty` is a work list of frontier cells whose neighbourhood changed since
+ * they were last popped, deduplicated through `queued`. */
+typedef struct {
+    uint64_t *active;
+    uint64_t *listed;
+    uint64_t *queued;
+    uint32_t *cells;
+    size_t count;
+    size_t cap;
+    uint32_t *dirty;
+    size_t dirty_count;
+    size_t dirty_cap;
+    int rows;
+    int cols;
+    int stride;
+    ms_Arena arena;
+} ms_Frontier;
+
+bool ms_FrontierInit(ms_Frontier *frontier, const ms_Game *game);
+void ms_FrontierFree(ms_Frontier *frontier);
+void ms_FrontierRebuild(ms_Frontier *frontier, const ms_Game *game);
+void ms_FrontierTouch(ms_Frontier *frontier, const ms_Game *game, int x, int y);
+void ms_FrontierTouchCells(ms_Frontier *frontier, const ms_Game *game, const uint32_t *cells, size_t count);
+size_t ms_FrontierCompact(ms_Frontier *frontier);
+
+void ms_FrontierQueue(ms_Frontier *frontier, int x, int y);
+bool ms_FrontierPop(ms_Frontier *frontier, uint32_t *cell);
+
+
+/*True if the cell is neither revealed nor flagged.*/
+static inline bool ms_IsHidden(const ms_Game *game, int x, int y) {
+    size_t i = ms_WordIndex(game, x, y);
+    return !((game->revealed[i] | game->flagged[i]) & ms_BitMask(x));
+}
+
+static inline bool ms_FrontierHas(const ms_Frontier *frontier, int x, int y) {
+    return frontier->active[(size_t)y * frontier->stride + (x >> 6)] & ms_BitMask(x);
+}
+
+#endif // FRONTIER_H
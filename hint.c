@@ -0,0 +1,137 @@
+#include <math.h>
+
+#include "hint.h"
+
+
+/*Sets the engine up for the current state of `game`, which may already be in
+ * progress. Returns false if memory runs out; the next hint tries again.*/
+bool ms_HintInit(ms_HintEngine *hints, const ms_Game *game) {
+    hints->cursor = 0;
+    hints->reset = !ms_SolverInit(&hints->solver, game);
+    return !hints->reset;
+}
+
+void ms_HintFree(ms_HintEngine *hints) {
+    ms_SolverFree(&hints->solver);
+    *hints = (ms_HintEngine) {0};
+}
+
+/*Feeds the cells a move revealed or (un)flagged to the engine. A cell the
+ * move left hidden and unflagged lost its flag.*/
+void ms_HintUpdate(ms_HintEngine *hints, const ms_Game *game, const uint32_t *cells, size_t count) {
+    // the solver starts over from the board at the next hint anyway
+    if (hints->reset) {
+        return;
+    }
+    ms_SolverUpdate(&hints->solver, game, cells, count);
+    for (size_t i = 0; i < count; i++) {
+        if (ms_IsHidden(game, cells[i] % game->cols, cells[i] / game->cols)) {
+            hints->reset = true;
+        }
+    }
+}
+
+/*Drops the decided cells on top of the solver's lists that the player has
+ * played since, safe cells also once flagged. Hints come from the top, so
+ * cells played further down only go once they come up; until then they cost
+ * nothing.*/
+static void ms_HintPrune(ms_Solver *solver, const ms_Game *game) {
+    while (solver->safe_count > 0) {
+        uint32_t cell = solver->safe[solver->safe_count - 1];
+        int x = cell % game->cols;
+        if (!ms_IsRevealed(game, x, cell / game->cols) && !ms_IsFlagged(game, x, cell / game->cols)) {
+            break;
+        }
+        solver->known_safe[ms_WordIndex(game, x, cell / game->cols)] &= ~ms_BitMask(x);
+        solver->safe_count--;
+    }
+    while (solver->mine_count > 0) {
+        uint32_t cell = solver->mines[solver->mine_count - 1];
+        int x = cell % game->cols;
+        if (!ms_IsFlagged(game, x, cell / game->cols)) {
+            break;
+        }
+        solver->known_mine[ms_WordIndex(game, x, cell / game->cols)] &= ~ms_BitMask(x);
+        solver->mine_count--;
+    }
+}
+
+/*Finds a hidden, unflagged cell whose probability is that of the interior:
+ * off the frontier, or in a component too big to search.*/
+static bool ms_HintFindInterior(ms_HintEngine *hints, const ms_ProbEngine *prob, const ms_Game *game, ms_Pos *out) {
+    size_t words = (size_t)game->rows * game->stride;
+    for (size_t n = 0; n < words; n++) {
+        size_t i = hints->cursor + n < words ? hints->cursor + n : hints->cursor + n - words;
+        int y = i / game->stride;
+        int w = i % game->stride;
+        uint64_t bits = ~(game->revealed[i] | game->flagged[i]) & ms_RowMask(game, w);
+        while (bits) {
+            int x = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            uint32_t id = prob->component[(size_t)y * game->cols + x];
+            if (id == 0 || !prob->components[id - 1].exact) {
+                hints->cursor = i;
+                *out = ms_PosXY(x, y);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*The hidden cell least likely to be a mine: the best frontier cell of the
+ * searched components, or any interior cell if the interior is safer.*/
+static ms_Hint ms_HintGuess(ms_HintEngine *hints, ms_ProbEngine *prob, const ms_Game *game) {
+    ms_ProbCompute(prob, game);
+    ms_Hint best = { .kind = ms_HINT_NONE, .risk = INFINITY };
+    for (size_t i = 0; i < prob->component_cap; i++) {
+        const ms_ProbComponent *c = &prob->components[i];
+        if (!c->alive || !c->exact) {
+            continue;
+        }
+        for (int v = 0; v < c->var_count; v++) {
+            if (c->var_prob[v] < best.risk) {
+                best.kind = ms_HINT_GUESS;
+                best.pos = ms_PosXY(c->cells[v] % game->cols, c->cells[v] / game->cols);
+                best.risk = c->var_prob[v];
+            }
+        }
+    }
+    ms_Pos pos;
+    if (prob->interior < best.risk && ms_HintFindInterior(hints, prob, game, &pos)) {
+        best = (ms_Hint) { .kind = ms_HINT_GUESS, .pos = pos, .risk = prob->interior };
+    }
+    // the search can prove what the solver's node budget cut short
+    if (best.kind == ms_HINT_GUESS && best.risk == 0) {
+        best.kind = ms_HINT_SAFE;
+    }
+    return best;
+}
+
+/*Returns the next hint for `game`; `prob` has to have seen the same moves as
+ * the engine. ms_HINT_NONE once the game is over.*/
+ms_Hint ms_HintNext(ms_HintEngine *hints, ms_ProbEngine *prob, const ms_Game *game) {
+    if (game->state != ms_PLAYING) {
+        return (ms_Hint) { .kind = ms_HINT_NONE };
+    }
+    if (!game->first_click_done) {
+        // the first click never hits a mine
+        return (ms_Hint) { .kind = ms_HINT_SAFE, .pos = ms_PosXY(game->cols / 2, game->rows / 2) };
+    }
+    ms_Solver *solver = &hints->solver;
+    if (hints->reset) {
+        if (!ms_HintInit(hints, game)) {
+            return (ms_Hint) { .kind = ms_HINT_NONE };
+        }
+    }
+    ms_HintPrune(solver, game);
+    if (ms_SolverDeduce(solver, game) > 0) {
+        if (solver->safe_count > 0) {
+            uint32_t cell = solver->safe[solver->safe_count - 1];
+            return (ms_Hint) { .kind = ms_HINT_SAFE, .pos = ms_PosXY(cell % game->cols, cell / game->cols) };
+        }
+        uint32_t cell = solver->mines[solver->mine_count - 1];
+        return (ms_Hint) { .kind = ms_HINT_MINE, .pos = ms_PosXY(cell % game->cols, cell / game->cols), .risk = 1 };
+    }
+    return ms_HintGuess(hints, prob, game);
+}
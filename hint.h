@@ -0,0 +1,57 @@
+#ifndef HINT_H
+#define HINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+#include "prob.h"
+#include "solver.h"
+
+/* Hints for the player.
+ *
+ * A hint is, in this order of preference: a hidden cell that is provably
+ * safe, a hidden cell that is provably a mine and not flagged yet, or, when
+ * nothing can be proven, the hidden cell least likely to be a mine.
+ *
+ * Proofs come from a solver (solver.h) the engine keeps next to the game:
+ * moves only touch its frontier, and asking for a hint runs its rules on the
+ * numbers around the cells changed since the last hint. Cells it decided
+ * earlier stay decided until they are played, so a hint after a move that
+ * played the last one costs no more than that move's neighbourhood. The
+ * guess comes from the game's probability engine (prob.h), which is just as
+ * incremental.
+ *
+ * Like the solver, the engine takes flags to be mines. Removing a flag may
+ * take back what was proven from it, so the solver starts over from the board
+ * at the next hint. */
+
+typedef enum {
+    ms_HINT_NONE = 0,
+    ms_HINT_SAFE,
+    ms_HINT_MINE,
+    ms_HINT_GUESS,
+} ms_HintKind;
+
+typedef struct {
+    ms_HintKind kind;
+    ms_Pos pos;
+    // probability that the cell is a mine
+    float risk;
+} ms_Hint;
+
+/* `cursor` is the word the search for a hidden cell off the frontier resumes
+ * from, so repeated guesses do not rescan the revealed part of the board. */
+typedef struct {
+    ms_Solver solver;
+    bool reset;
+    size_t cursor;
+} ms_HintEngine;
+
+bool ms_HintInit(ms_HintEngine *hints, const ms_Game *game);
+void ms_HintFree(ms_HintEngine *hints);
+void ms_HintUpdate(ms_HintEngine *hints, const ms_Game *game, const uint32_t *cells, size_t count);
+ms_Hint ms_HintNext(ms_HintEngine *hints, ms_ProbEngine *prob, const ms_Game *game);
+
+#endif // HINT_H
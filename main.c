@@ -1,18 +1,33 @@
 #include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "raylib.h"
 
+#include "minesweeper.h"
+#include "band.h"
+#include "hint.h"
+#include "noguess.h"
+#include "prob.h"
+#include "profile.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "world.h"
+
 #define GAME_MENU_HEIGHT        60
 #define GAME_STATUS_HEIGHT 60
 
 #define MENU_WIDTH 400
-#define MENU_HEIGHT 300
+#define MENU_HEIGHT 400
 
 #define FONT_SIZE          32
 #define MENU_FONT_SIZE     24
@@ -20,47 +35,74 @@
 
 #define BEGINNER_GRID_SIZE   40
 #define BEGINNER_FONT_SIZE FONT_SIZE
-#define BEGINNER_ROWS         9
-#define BEGINNER_COLUMNS      9
-#define BEGINNER_MINE_COUNT  10
 
 #define INTERMEDIATE_FONT_SIZE   32
 #define INTERMEDIATE_GRID_SIZE   36
-#define INTERMEDIATE_ROWS        16
-#define INTERMEDIATE_COLUMNS     16
-#define INTERMEDIATE_MINE_COUNT  40
 
 #define EXPERT_FONT_SIZE   30
 #define EXPERT_GRID_SIZE   30
-#define EXPERT_ROWS        16
-#define EXPERT_COLUMNS     30
-#define EXPERT_MINE_COUNT  99
+
+#define CUSTOM_FONT_SIZE   EXPERT_FONT_SIZE
+#define CUSTOM_GRID_SIZE   EXPERT_GRID_SIZE
+
+// custom board used when no size is given on the command line
+#define CUSTOM_ROWS        100
+#define CUSTOM_COLUMNS     100
+#define CUSTOM_MINE_COUNT  2000
+
+// cells the endless board shows at first, before it is fit to the monitor
+#define ENDLESS_ROWS       24
+#define ENDLESS_COLUMNS    40
+#define ENDLESS_FONT_SIZE  EXPERT_FONT_SIZE
+#define ENDLESS_GRID_SIZE  EXPERT_GRID_SIZE
 
 #define PADDING            10
 
+// menu entries: the difficulties in order, then the endless board
+#define MENU_ITEMS         5
+#define MENU_ENDLESS       4
+
 #define GAME_START_Y       ((GAME_MENU_HEIGHT) + (PADDING))
 #define GAME_START_X       (PADDING)
 
+#define GRID_LINE_THICKNESS 3
+// room around the cells of the board texture for the outer grid lines
+#define BOARD_PAD           2
 
-#define MINE               -1
+#define GLYPH_FLAG          9
+#define GLYPH_COUNT         10
 
+// boards whose texture would be larger than this are drawn cell by cell
+#define BOARD_CACHE_MAX_SIDE 4096
+// smallest on-screen cell when drawing cell by cell, bounds the visible cells
+#define MIN_CELL_PIXELS     8
+#define MAX_ZOOM            4.0f
+#define ZOOM_STEP           1.25f
+// room left on the monitor around a window for large boards
+#define MONITOR_MARGIN      80
 
-#define ARRAY_LEN(arr) (sizeof(arr) / sizeof((arr)[0]))
+// every game is recorded here, one file per board seed
+#define REPLAY_DIR          "replays"
 
+// cells smaller than this show the probability tint without the percentage
+#define PROB_TEXT_MIN_CELL  24
+// outline of the cell the H key points at
+#define HINT_THICKNESS      3
 
-typedef struct {
-    int  value;
-    bool flagged;
-    bool revealed;
-} ms_Cell;
+// the F3 overlay summarizes this many recent frames, one graph bar each
+#define PROFILE_WINDOW      240
+#define PROFILE_FONT_SIZE   10
+#define PROFILE_ROW_HEIGHT  12
+#define PROFILE_GRAPH_HEIGHT 60
+// frame time at the top of the graph, twice the 60 fps budget
+#define PROFILE_GRAPH_MAX_NS 33333333
+
+// the idle loop wakes this long after a timer second, so the new second shows
+#define WAKE_MARGIN         0.002
+
+
+#define ARRAY_LEN(arr) (sizeof(arr) / sizeof((arr)[0]))
 
-typedef struct {
-    ms_Cell game_data[EXPERT_ROWS * EXPERT_COLUMNS];
-    int rows;
-    int cols;
-    int mines_left;
-    bool first_click_done;
-} ms_Game;
 
 typedef struct {
     int width;
@@ -69,21 +111,58 @@ typedef struct {
     int font_size;
 } ms_RenderConfig;
 
+/* Cells [x0, x1) x [y0, y1). */
 typedef struct {
-    int x, y;
-} ms_Pos;
+    int x0, y0;
+    int x1, y1;
+} ms_CellRange;
+
+typedef struct {
+    int rows;
+    int cols;
+    int mines;
+} ms_CustomBoard;
 
 typedef enum {
     ms_ScreenMenu = 0,
     ms_ScreenGame,
 } ms_GameScreen;
 
+/* What the G key shows on top of the board. */
 typedef enum {
-    ms_PLAYING,
-    ms_GAME_OVER,
-    ms_GAME_WON,
-    ms_NEW_GAME,
-} ms_GameState;
+    ms_DebugOff = 0,
+    ms_DebugMines,
+    ms_DebugProbabilities,
+    ms_DebugViewCount,
+} ms_DebugView;
+
+/* The board is drawn once into `target` and afterwards only the cells a move
+ * changed are redrawn, so a frame is a single blit. Digits and the flag come
+ * from `glyphs`, rendered and measured once per font size.
+ * Boards too large for one texture leave `target` unloaded (width 0) and are
+ * drawn straight to the screen, visible cells only. */
+typedef struct {
+    RenderTexture2D target;
+    RenderTexture2D glyphs;
+    Rectangle glyph_rects[GLYPH_COUNT];
+    int width;
+    int height;
+    int font_size;
+    bool redraw_all;
+} ms_BoardCache;
+
+/* While the loop waits for input, this thread wakes it when the game timer
+ * reaches its next second: it posts an empty event at `deadline`
+ * (CLOCK_MONOTONIC), if one is armed. */
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    struct timespec deadline;
+    bool armed;
+    bool stop;
+    bool running;
+} ms_WakeTimer;
 
 typedef struct {
     char* name;
@@ -93,52 +172,140 @@ typedef struct {
     Color highlight;
 } ms_MenuItem;
 
-typedef enum {
-    ms_BEGINNER = 0,
-    ms_INTERMEDIATE,
-    ms_EXPERT,
-} ms_Difficulty;
-
-ms_GameState game_state = ms_PLAYING;
 ms_GameScreen current_screen = ms_ScreenMenu;
-bool show_debug = false;
+ms_DebugView debug_view = ms_DebugOff;
+// first clicks on preset boards get a board the solver clears without guessing
+bool no_guess = false;
+// the first click of the board found no no-guess board ready and got a random one
+bool no_guess_missed = false;
+ms_BoardPool board_pool = {0};
+// generates and counts large custom boards band by band
+ms_BandPool band_pool;
 
 ms_Game game = {0};
+// the board of the endless mode, which replaces `game` while it is played
+ms_World world = {0};
+bool endless = false;
 ms_RenderConfig config = {0};
+ms_BoardCache board_cache = {0};
+// set up for a board the first time the overlay or a hint needs it, kept up
+// to date with every move after that, computed only while the overlay is shown
+ms_ProbEngine prob = {0};
+bool prob_ready = false;
+// set up on the first H of a board and following every move after that; H
+// shows its next hint until the next move
+ms_HintEngine hints = {0};
+bool hints_ready = false;
+ms_Hint hint = {0};
+// opened on the first move of a game
+ms_Recorder recorder = {0};
+// one snapshot per move that changed the board, U takes the last one back
+ms_Snapshot *undo = NULL;
+size_t undo_count = 0;
+size_t undo_cap = 0;
+// times every frame; F3 shows the overlay
+ms_Profiler profiler = {0};
+bool show_profile = false;
+ms_WakeTimer wake_timer = {0};
+
+// raylib's desktop backend is GLFW, which it links in without wrapping this
+// call; weak so a raylib that hides it still links, and then the timer keeps
+// the loop running instead
+extern void glfwPostEmptyEvent(void) __attribute__((weak));
+ms_CustomBoard custom = { CUSTOM_ROWS, CUSTOM_COLUMNS, CUSTOM_MINE_COUNT };
+// world coordinates are board pixels, cell (x, y) starts at (x, y) * grid_size
+Camera2D camera = {0};
 
-void ms_InitGame(int rows, int columns, int mines);
 void ms_InitBeginnerGame();
 void ms_InitIntermediateGame();
 void ms_InitExpertGame();
-
-void ms_InitGameData(ms_Pos *first_click_pos);
-void ms_DrawGrid();
-void ms_DrawGameState();
+void ms_InitCustomGame();
+void ms_InitEndlessGame();
+void ms_InitSelectedGame(ms_Difficulty difficulty);
+void ms_SetupBoardView();
+void ms_FitToMonitor();
+
+void ms_ResetCamera();
+void ms_UpdateCamera();
+void ms_ClampCamera();
+float ms_GetMinZoom();
+Rectangle ms_GetViewport();
+ms_CellRange ms_GetVisibleCells();
+
+void ms_LoadBoardCache();
+void ms_LoadGlyphs();
+void ms_UnloadBoardCache();
+void ms_RefreshBoardCache(const uint32_t *cells, size_t count);
+void ms_ApplyMove(const uint32_t *cells, size_t count);
+bool ms_PrepareProb();
+void ms_ShowProbabilities();
+void ms_RecordPlayerMove(ms_MoveKind kind, ms_Pos *pos, float game_time);
+void ms_PushUndo();
+void ms_KeepUndo();
+void ms_Undo(float game_time);
+void ms_DrawBoard();
+void ms_DrawGrid(ms_CellRange range);
+void ms_DrawGameState(ms_CellRange range);
+void ms_DrawCell(int x, int y);
+void ms_DrawCellContent(ms_Cell cell, bool show_all, int posX, int posY);
+void ms_DrawWorld(ms_CellRange range);
+void ms_DrawProbability(int x, int y, int posX, int posY);
+void ms_DrawHint();
+void ms_DrawGlyph(int glyph, int posX, int posY, Color color);
 void ms_DrawGameMenu(float game_time);
+void ms_DrawProfiler();
+
+void ms_WakeStart();
+void ms_WakeStop();
+void ms_WakeAfter(double seconds);
+void ms_WakeCancel();
+void ms_UpdateIdleMode(bool animating, bool timer_running, double timer);
 void ms_DrawItem(ms_MenuItem* item, bool selected, bool active);
-void ms_InitMenuItems(ms_MenuItem items[3], int beginn_Y);
-ms_Cell* ms_RevealCell(ms_Pos *pos);
-int ms_FlagCell(ms_Pos *pos);
-void ms_ExpandZeros(ms_Pos pos);
+void ms_InitMenuItems(ms_MenuItem items[MENU_ITEMS], int beginn_Y);
 
 bool ms_GetMouseGridPos(ms_Pos* pos);
-bool ms_CheckGameWon();
+ms_GameState ms_GetGameState();
 int ms_GetGameStatusStartY();
-bool ms_PosEqual(ms_Pos *p1, ms_Pos *p2);
-bool ms_PosIsNeighbour(ms_Pos *origin, ms_Pos *pos);
-ms_Cell *ms_AtPos(ms_Pos *pos);
-ms_Cell *ms_AtXY(int x, int y);
 
 int ms_GetTotalGameWindowWidth();
 int ms_GetTotalGameWindowHeight();
 
-inline ms_Pos ms_PosXY(int x, int y);
 
+int main(int argc, char **argv) {
+    // frame times are written here at exit
+    const char *profile_path = NULL;
+    bool valid = true;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:")) != -1) {
+        switch (opt) {
+            case 'p': profile_path = optarg; break;
+            default: valid = false; break;
+        }
+    }
+    char **args = argv + optind;
+    int arg_count = argc - optind;
+    if (arg_count == 3) {
+        custom.cols = atoi(args[0]);
+        custom.rows = atoi(args[1]);
+        custom.mines = atoi(args[2]);
+    }
+    // the engine validates the size, check it once before opening a window
+    if (!valid || (arg_count != 0 && arg_count != 3) ||
+        !ms_InitGame(&game, custom.rows, custom.cols, custom.mines, 0) ||
+        !ms_ProfilerInit(&profiler))
+    {
+        fprintf(stderr, "usage: %s [-p profile.csv] [columns rows mines]\n", argv[0]);
+        return 1;
+    }
 
-int main() {
     InitWindow(MENU_WIDTH, MENU_HEIGHT, "Minesweeper");
     SetExitKey(KEY_Q);
     SetTargetFPS(60);
+    ms_WakeStart();
+    bool banding = ms_BandPoolStart(&band_pool, sysconf(_SC_NPROCESSORS_ONLN) - 1);
+    // searches while the game starts up, so N finds boards ready; workers with
+    // full rings sleep, and one core stays free for the game itself
+    ms_PoolStart(&board_pool, sysconf(_SC_NPROCESSORS_ONLN) - 1, ms_RngSeedFromTime());
 
     // game menu
 
@@ -154,10 +321,11 @@ int main() {
     int submenu_title_Y = current_Y;
     current_Y += MENU_FONT_SIZE + 40;
 
-    ms_MenuItem items[3] = {0};
+    ms_MenuItem items[MENU_ITEMS] = {0};
     ms_InitMenuItems(items, current_Y);
     bool locked_in = false;
 
+    int selected_item = ms_BEGINNER;
     ms_Difficulty selected_difficulty = ms_BEGINNER;
 
     float highlight_timer = 0.0f;
@@ -165,13 +333,23 @@ int main() {
 
     // gameplay
 
-    srand(time(NULL));
-
     ms_Pos grid_pos = {0};
     bool mouse_inside_grid = false;
     float game_time = 0.f;
 
+    // GetFrameTime() lags a frame behind, so after waiting for input it would
+    // not include the wait yet; timers advance by the wall time between frames
+    double last_frame = GetTime();
+
     while (!WindowShouldClose()) {
+        double now = GetTime();
+        float frame_time = now - last_frame;
+        last_frame = now;
+        ms_ProfileFrame(&profiler);
+        ms_ProfileBegin(&profiler, ms_PHASE_INPUT);
+        if (IsKeyPressed(KEY_F3)) {
+            show_profile = !show_profile;
+        }
         switch (current_screen) {
             case ms_ScreenMenu:
                 {
@@ -180,7 +358,7 @@ int main() {
                         if (mouseY >= items[i].y-MENU_FONT_SIZE/2 &&
                             mouseY <= items[i].y + MENU_FONT_SIZE*2)
                         {
-                            selected_difficulty = i;
+                            selected_item = i;
                         }
                     }
                     if (IsKeyPressed(KEY_ENTER) ||
@@ -189,15 +367,13 @@ int main() {
                         highlight_timer = highligh_duration;
                         locked_in = true;
                     }
-                    if (locked_in) highlight_timer -= GetFrameTime();
+                    if (locked_in) highlight_timer -= frame_time;
                     if (highlight_timer < 0) {
-                        switch (selected_difficulty) {
-                            case ms_BEGINNER: ms_InitBeginnerGame(); break;
-                            case ms_INTERMEDIATE: ms_InitIntermediateGame(); break;
-                            case ms_EXPERT: ms_InitExpertGame(); break;
-                            // TODO: add support for custom values
-                            default: assert(0 && "unreachable");
+                        endless = selected_item == MENU_ENDLESS;
+                        if (!endless) {
+                            selected_difficulty = selected_item;
                         }
+                        ms_InitSelectedGame(selected_difficulty);
                         highlight_timer = 0;
                         locked_in = false;
 
@@ -213,7 +389,7 @@ int main() {
                             (monitor_height - ms_GetTotalGameWindowHeight()) / 2
                         );
                         current_screen = ms_ScreenGame;
-                        game_state = ms_PLAYING;
+                        game_time = 0;
                     }
                 } break;
             case ms_ScreenGame:
@@ -231,62 +407,104 @@ int main() {
                         break;
                     }
                     if (IsKeyPressed(KEY_R)) {
-                        game_state = ms_NEW_GAME;
+                        ms_ProfileBegin(&profiler, ms_PHASE_UPDATE);
+                        ms_InitSelectedGame(selected_difficulty);
+                        ms_ProfileEnd(&profiler);
+                        game_time = 0;
                     }
-                    if (IsKeyPressed(KEY_G)) {
-                        show_debug = !show_debug;
+                    // endless boards have no debug views and no undo
+                    if (IsKeyPressed(KEY_G) && !endless) {
+                        ms_ProfileBegin(&profiler, ms_PHASE_UPDATE);
+                        debug_view = (debug_view + 1) % ms_DebugViewCount;
+                        if (debug_view == ms_DebugProbabilities) {
+                            ms_ShowProbabilities();
+                        }
+                        board_cache.redraw_all = true;
+                        ms_RefreshBoardCache(NULL, 0);
+                        ms_ProfileEnd(&profiler);
                     }
-                    switch (game_state) {
+                    if (IsKeyPressed(KEY_N)) {
+                        no_guess = !no_guess;
+                    }
+                    if (IsKeyPressed(KEY_H) && !endless) {
+                        ms_ProfileBegin(&profiler, ms_PHASE_UPDATE);
+                        if (!hints_ready) {
+                            hints_ready = ms_HintInit(&hints, &game);
+                        }
+                        // without the memory for the engines there is no hint
+                        if (hints_ready && ms_PrepareProb()) {
+                            hint = ms_HintNext(&hints, &prob, &game);
+                        }
+                        ms_ProfileEnd(&profiler);
+                    }
+                    if (IsKeyPressed(KEY_U) && !endless) {
+                        ms_ProfileBegin(&profiler, ms_PHASE_UPDATE);
+                        ms_Undo(game_time);
+                        ms_ProfileEnd(&profiler);
+                    }
+                    ms_UpdateCamera();
+                    switch (ms_GetGameState()) {
                         case ms_PLAYING:
                             {
-                                game_time += GetFrameTime();
+                                game_time += frame_time;
                                 mouse_inside_grid = ms_GetMouseGridPos(&grid_pos);
-                                if (mouse_inside_grid) {
+                                if (mouse_inside_grid && endless) {
                                     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                                        if (!game.first_click_done) {
-                                            ms_InitGameData(&grid_pos);
-                                            game.first_click_done = true;
-                                        }
-                                        ms_Cell *cell = ms_RevealCell(&grid_pos);
-                                        if (cell) {
-                                            if (cell->value == 0) {
-                                                ms_ExpandZeros(grid_pos);
-                                            } else if (cell->value == MINE) {
-                                                game_state = ms_GAME_OVER;
+                                        ms_ProfileBegin(&profiler, ms_PHASE_UPDATE);
+                                        ms_WorldClick(&world, &grid_pos);
+                                        ms_ProfileEnd(&profiler);
+                                    }
+                                    if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) ||
+                                        IsKeyPressed(KEY_M))
+                                    {
+                                        ms_ProfileBegin(&profiler, ms_PHASE_UPDATE);
+                                        ms_WorldMark(&world, &grid_pos);
+                                        ms_ProfileEnd(&profiler);
+                                    }
+                                } else if (mouse_inside_grid) {
+                                    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                                        ms_ProfileBegin(&profiler, ms_PHASE_UPDATE);
+                                        // the debug view shows every value, which only exist after the first click
+                                        board_cache.redraw_all |= debug_view != ms_DebugOff && !game.first_click_done;
+                                        ms_PushUndo();
+                                        if (no_guess && !game.first_click_done) {
+                                            no_guess_missed =
+                                                !ms_InitNoGuess(&board_pool, &game, selected_difficulty, &grid_pos);
+                                            if (!no_guess_missed) {
+                                                ms_RecordPlayerMove(ms_MOVE_NOGUESS, &grid_pos, game_time);
                                             }
                                         }
+                                        ms_RecordPlayerMove(ms_MOVE_REVEAL, &grid_pos, game_time);
+                                        ms_ClickCell(&game, &grid_pos);
+                                        ms_KeepUndo();
+                                        ms_RevealDelta delta = ms_GameDelta(&game);
+                                        ms_ApplyMove(delta.cells, delta.count);
+                                        ms_ProfileEnd(&profiler);
                                     }
                                     if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) ||
                                         IsKeyPressed(KEY_M))
                                     {
-                                        game.mines_left += ms_FlagCell(&grid_pos);
-                                    }
-                                    if (ms_CheckGameWon()) {
-                                        game_state = ms_GAME_WON;
+                                        ms_ProfileBegin(&profiler, ms_PHASE_UPDATE);
+                                        ms_PushUndo();
+                                        ms_RecordPlayerMove(ms_MOVE_FLAG, &grid_pos, game_time);
+                                        ms_MarkCell(&game, &grid_pos);
+                                        ms_KeepUndo();
+                                        uint32_t cell = grid_pos.y * game.cols + grid_pos.x;
+                                        ms_ApplyMove(&cell, 1);
+                                        ms_ProfileEnd(&profiler);
                                     }
                                 }
                             } break;
                         case ms_GAME_OVER:
                         case ms_GAME_WON:
-                            {
-                                if (IsKeyPressed(KEY_R)) {
-                                    game_state = ms_NEW_GAME;
-                                }
-                            } break;
-                        case ms_NEW_GAME:
-                            {
-                                switch (selected_difficulty) {
-                                    case ms_BEGINNER: ms_InitBeginnerGame(); break;
-                                    case ms_INTERMEDIATE: ms_InitIntermediateGame(); break;
-                                    case ms_EXPERT: ms_InitExpertGame(); break;
-                                    default: assert(0 && "unreachable");
-                                }
-                            } break;
+                            break;
                     }
                 } break;
             default: assert(0 && "unreachable");
         }
+        ms_ProfileEnd(&profiler);
 
+        ms_ProfileBegin(&profiler, ms_PHASE_DRAW_UI);
         BeginDrawing();
         ClearBackground(RAYWHITE);
 
@@ -302,23 +520,39 @@ int main() {
                              (MENU_WIDTH-sub_title_size)/2,
                              submenu_title_Y,
                              MENU_FONT_SIZE, DARKGRAY);
-                    for (size_t i = 0; i < 3; i++) {
-                        ms_DrawItem(&items[i], selected_difficulty == i, highlight_timer > 0);
+                    for (size_t i = 0; i < ARRAY_LEN(items); i++) {
+                        ms_DrawItem(&items[i], selected_item == (int)i, highlight_timer > 0);
                     }
                 } break;
             case ms_ScreenGame:
                 {
                     ms_DrawGameMenu(game_time);
-                    ms_DrawGrid();
-                    ms_DrawGameState();
-                    switch(game_state) {
+                    ms_ProfileBegin(&profiler, ms_PHASE_DRAW_BOARD);
+                    Rectangle viewport = ms_GetViewport();
+                    BeginScissorMode(viewport.x, viewport.y, viewport.width, viewport.height);
+                    BeginMode2D(camera);
+                    ms_DrawBoard();
+                    ms_DrawHint();
+                    if (ms_GetGameState() == ms_PLAYING && mouse_inside_grid) {
+                        ms_Cell cell = endless ? ms_WorldAt(&world, grid_pos.x, grid_pos.y) : ms_AtPos(&game, &grid_pos);
+                        if (!cell.revealed && !cell.flagged) {
+                            DrawRectangle(grid_pos.x*config.grid_size, grid_pos.y*config.grid_size, config.grid_size, config.grid_size, LIGHTGRAY);
+                        }
+                    }
+                    EndMode2D();
+                    EndScissorMode();
+                    ms_ProfileEnd(&profiler);
+                    switch(ms_GetGameState()) {
                         case ms_PLAYING:
                             {
-                                if (mouse_inside_grid) {
-                                    ms_Cell* cell = ms_AtPos(&grid_pos);
-                                    if (!cell->revealed && !cell->flagged) {
-                                        DrawRectangle(GAME_START_X+grid_pos.x*config.grid_size, GAME_START_Y+grid_pos.y*config.grid_size, config.grid_size, config.grid_size, LIGHTGRAY);
-                                    }
+                                if (no_guess && !endless && selected_difficulty != ms_CUSTOM) {
+                                    char* msg = no_guess_missed ? "Random board (none ready)" : "No-guess mode";
+                                    int text_size = MeasureText(msg, SUB_MENU_FONT_SIZE);
+                                    DrawText(
+                                        msg,
+                                        (config.width - text_size) / 2,
+                                        ms_GetGameStatusStartY(),
+                                        SUB_MENU_FONT_SIZE, DARKGRAY);
                                 }
                             } break;
                         case ms_GAME_OVER:
@@ -341,19 +575,44 @@ int main() {
                                     ms_GetGameStatusStartY(),
                                     FONT_SIZE, GREEN);
                             } break;
-                        case ms_NEW_GAME:
-                            {
-                                game_time = 0;
-                                game_state = ms_PLAYING;
-                            } break;
                     }
                 } break;
             default: assert(0 && "unreachable");
         }
+        if (show_profile) {
+            ms_DrawProfiler();
+        }
+        ms_ProfileEnd(&profiler);
+
+        // the menu highlight and the profiler graph move every frame, the
+        // timer once a second, and everything else only on input
+        ms_UpdateIdleMode(locked_in || show_profile,
+                          current_screen == ms_ScreenGame && ms_GetGameState() == ms_PLAYING,
+                          game_time);
 
+        ms_ProfileBegin(&profiler, ms_PHASE_PRESENT);
         EndDrawing();
+        ms_ProfileEnd(&profiler);
     }
 
+    if (profile_path && !ms_ProfileWriteCsv(&profiler, profile_path)) {
+        fprintf(stderr, "%s: could not write the frame times\n", profile_path);
+    }
+    ms_WakeStop();
+    if (board_pool.rings) {
+        ms_PoolStop(&board_pool);
+    }
+    if (banding) {
+        ms_BandPoolStop(&band_pool);
+    }
+    ms_RecorderStop(&recorder);
+    ms_UnloadBoardCache();
+    ms_ProbFree(&prob);
+    ms_HintFree(&hints);
+    ms_FreeGame(&game);
+    ms_WorldFree(&world);
+    free(undo);
+    ms_ProfilerFree(&profiler);
     CloseWindow();
     return 0;
 }
@@ -362,9 +621,16 @@ int main() {
  * otherwise returns false.*/
 bool ms_GetMouseGridPos(ms_Pos* grid_pos) {
     Vector2 mouse_pos = GetMousePosition();
-    mouse_pos.y -= GAME_START_Y;
-    mouse_pos.x -= GAME_START_X;
+    if (!CheckCollisionPointRec(mouse_pos, ms_GetViewport())) {
+        return false;
+    }
+    mouse_pos = GetScreenToWorld2D(mouse_pos, camera);
 
+    if (endless) {
+        grid_pos->y = floorf(mouse_pos.y / config.grid_size);
+        grid_pos->x = floorf(mouse_pos.x / config.grid_size);
+        return true;
+    }
     if (mouse_pos.y < 0 || mouse_pos.y >= game.rows * config.grid_size || mouse_pos.x < 0 || mouse_pos.x >= game.cols * config.grid_size) {
         return false;
     }
@@ -374,86 +640,484 @@ bool ms_GetMouseGridPos(ms_Pos* grid_pos) {
     return true;
 }
 
-void ms_DrawGameState() {
-    for (int y = 0; y < game.rows; y++) {
-        for (int x = 0; x < game.cols; x++) {
-            ms_Cell *cell = ms_AtXY(x, y);
-            int posX = GAME_START_X + x * config.grid_size;
-            int posY = GAME_START_Y + y * config.grid_size;
-            if (show_debug || cell->revealed) {
-                if (cell->value == MINE) {
-                    DrawCircle( posX + config.grid_size/2, posY + config.grid_size/2, (float)config.grid_size/3, RED);
-                } else {
-                    char val[2] = {0};
-                    sprintf(val, "%d", cell->value);
-                    int text_size = MeasureText(val, config.font_size);
-                    DrawText(
-                        val,
-                        posX + (config.grid_size - text_size) / 2,
-                        posY + (config.grid_size - config.font_size) / 2,
-                        config.font_size, DARKGRAY);
-                }
+ms_GameState ms_GetGameState() {
+    return endless ? world.state : game.state;
+}
+
+/*(Re)creates the board texture and glyph atlas when the board size or font
+ * changed, and schedules a full redraw.*/
+void ms_LoadBoardCache() {
+    int width = game.cols * config.grid_size + 2 * BOARD_PAD;
+    int height = game.rows * config.grid_size + 2 * BOARD_PAD;
+    if (width > BOARD_CACHE_MAX_SIDE || height > BOARD_CACHE_MAX_SIDE) {
+        width = 0;
+        height = 0;
+    }
+    if (width != board_cache.width || height != board_cache.height) {
+        if (board_cache.width) {
+            UnloadRenderTexture(board_cache.target);
+        }
+        if (width) {
+            board_cache.target = LoadRenderTexture(width, height);
+        }
+        board_cache.width = width;
+        board_cache.height = height;
+    }
+    ms_LoadGlyphs();
+
+    board_cache.redraw_all = true;
+    ms_RefreshBoardCache(NULL, 0);
+}
+
+/*Renders the digits and the flag into the glyph atlas when the font changed.*/
+void ms_LoadGlyphs() {
+    if (config.font_size != board_cache.font_size) {
+        if (board_cache.font_size) {
+            UnloadRenderTexture(board_cache.glyphs);
+        }
+        const char *texts[GLYPH_COUNT] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "M" };
+        int atlas_width = 0;
+        for (int i = 0; i < GLYPH_COUNT; i++) {
+            int text_size = MeasureText(texts[i], config.font_size);
+            // render textures are stored upside down, hence the negative height
+            board_cache.glyph_rects[i] = (Rectangle) {
+                .x = atlas_width, .y = 0, .width = text_size, .height = -config.font_size,
+            };
+            atlas_width += text_size + 1;
+        }
+        board_cache.glyphs = LoadRenderTexture(atlas_width, config.font_size);
+        BeginTextureMode(board_cache.glyphs);
+        ClearBackground(BLANK);
+        for (int i = 0; i < GLYPH_COUNT; i++) {
+            DrawText(texts[i], board_cache.glyph_rects[i].x, 0, config.font_size, WHITE);
+        }
+        EndTextureMode();
+        board_cache.font_size = config.font_size;
+    }
+}
+
+void ms_UnloadBoardCache() {
+    if (board_cache.width) {
+        UnloadRenderTexture(board_cache.target);
+    }
+    if (board_cache.font_size) {
+        UnloadRenderTexture(board_cache.glyphs);
+    }
+    board_cache = (ms_BoardCache) {0};
+}
+
+/*Brings the board texture up to date: redraws `cells` (linear indices), or the
+ * whole board if a full redraw is pending.*/
+void ms_RefreshBoardCache(const uint32_t *cells, size_t count) {
+    if (!board_cache.width || (!board_cache.redraw_all && count == 0)) {
+        return;
+    }
+    // cells are drawn in world coordinates, shifted by the room for the outer lines
+    Camera2D texture_camera = { .offset = { BOARD_PAD, BOARD_PAD }, .zoom = 1.0f };
+    BeginTextureMode(board_cache.target);
+    BeginMode2D(texture_camera);
+    if (board_cache.redraw_all) {
+        ms_CellRange all = { .x0 = 0, .y0 = 0, .x1 = game.cols, .y1 = game.rows };
+        ClearBackground(RAYWHITE);
+        ms_DrawGrid(all);
+        ms_DrawGameState(all);
+        board_cache.redraw_all = false;
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            ms_DrawCell(cells[i] % game.cols, cells[i] / game.cols);
+        }
+    }
+    EndMode2D();
+    EndTextureMode();
+}
+
+/*Feeds the cells a move changed to the probability and hint engines and
+ * redraws them. A move can shift the probability of any hidden cell, so the
+ * probability view redraws the whole board.*/
+void ms_ApplyMove(const uint32_t *cells, size_t count) {
+    if (prob_ready) {
+        ms_ProbUpdate(&prob, &game, cells, count);
+    }
+    if (hints_ready) {
+        ms_HintUpdate(&hints, &game, cells, count);
+    }
+    hint.kind = ms_HINT_NONE;
+    if (debug_view == ms_DebugProbabilities) {
+        ms_ShowProbabilities();
+        board_cache.redraw_all = true;
+    }
+    ms_RefreshBoardCache(cells, count);
+}
+
+/*Sets the probability engine up for the current board unless it already
+ * follows it. Returns false if memory runs out.*/
+bool ms_PrepareProb() {
+    if (!prob_ready) {
+        prob_ready = ms_ProbInit(&prob, &game);
+    }
+    return prob_ready;
+}
+
+/*Computes the probabilities the overlay shows. A board too big to compute
+ * them for turns the overlay off.*/
+void ms_ShowProbabilities() {
+    if (!ms_PrepareProb()) {
+        debug_view = ms_DebugOff;
+        return;
+    }
+    ms_ProbCompute(&prob, &game);
+}
+
+/*Appends a move of the player to the replay of the current game, starting
+ * the replay file on its first move. A move without a cell (`pos` NULL)
+ * repeats the cell of the move before. Recording is best effort: a replay
+ * that can not be written is skipped.*/
+void ms_RecordPlayerMove(ms_MoveKind kind, ms_Pos *pos, float game_time) {
+    if (!recorder.file) {
+        char path[64];
+        mkdir(REPLAY_DIR, 0755);
+        snprintf(path, sizeof(path), REPLAY_DIR "/%016llx.msr", (unsigned long long)game.seed);
+        if (!ms_RecorderStart(&recorder, path, &game)) {
+            return;
+        }
+    }
+    ms_ReplayMove move = {
+        .kind = kind,
+        .cell = pos ? (uint32_t)(pos->y * game.cols + pos->x) : recorder.last_cell,
+        .time = game_time * 1000,
+        .seed = game.seed,
+    };
+    ms_RecordMove(&recorder, move);
+}
+
+/*Snapshots the board before a move of the player.*/
+void ms_PushUndo() {
+    undo = ms_Grow(undo, &undo_cap, undo_count + 1, sizeof(*undo));
+    undo[undo_count++] = ms_TakeSnapshot(&game);
+}
+
+/*Drops the snapshot of a move that changed nothing, so undo never takes back
+ * a click on a revealed cell. The replay does the same when it plays undo.*/
+void ms_KeepUndo() {
+    if (!ms_SnapshotChanged(&game, &undo[undo_count - 1])) {
+        undo_count--;
+    }
+}
+
+/*Takes back the last move that changed the board, also after it lost the
+ * game, and redraws the board. The probability and hint engines start over
+ * from the restored board.*/
+void ms_Undo(float game_time) {
+    if (undo_count == 0 || !ms_RestoreSnapshot(&game, &undo[--undo_count])) {
+        return;
+    }
+    ms_RecordPlayerMove(ms_MOVE_UNDO, NULL, game_time);
+    prob_ready = false;
+    hints_ready = false;
+    hint.kind = ms_HINT_NONE;
+    if (debug_view == ms_DebugProbabilities) {
+        ms_ShowProbabilities();
+    }
+    board_cache.redraw_all = true;
+    ms_RefreshBoardCache(NULL, 0);
+}
+
+/*Tints a hidden cell from green (safe) to red (mine) by its probability and
+ * prints it as a percentage when the cell is large enough.*/
+void ms_DrawProbability(int x, int y, int posX, int posY) {
+    float p = ms_ProbAt(&prob, &game, x, y);
+    if (isnan(p)) {
+        return;
+    }
+    int line = GRID_LINE_THICKNESS / 2 + 1;
+    Color tint = { .r = 255 * p, .g = 200 * (1 - p), .b = 0, .a = 96 };
+    DrawRectangle(posX + line, posY + line, config.grid_size - 2 * line, config.grid_size - 2 * line, tint);
+    if (config.grid_size >= PROB_TEXT_MIN_CELL) {
+        const char *text = TextFormat("%d", (int)roundf(p * 100));
+        int font_size = config.font_size / 2;
+        DrawText(text, posX + (config.grid_size - MeasureText(text, font_size)) / 2,
+                 posY + (config.grid_size - font_size) / 2, font_size, DARKGRAY);
+    }
+}
+
+/*Outlines the cell of the last hint: green if it is safe, red if it is a mine
+ * to flag, orange for the safest guess.*/
+void ms_DrawHint() {
+    if (hint.kind == ms_HINT_NONE || endless) {
+        return;
+    }
+    Color color = hint.kind == ms_HINT_SAFE ? GREEN : hint.kind == ms_HINT_MINE ? RED : ORANGE;
+    Rectangle rect = {
+        .x = hint.pos.x * config.grid_size,
+        .y = hint.pos.y * config.grid_size,
+        .width = config.grid_size,
+        .height = config.grid_size,
+    };
+    DrawRectangleLinesEx(rect, HINT_THICKNESS, color);
+}
+
+/*Draws the board in world coordinates, expects to be called inside BeginMode2D.*/
+void ms_DrawBoard() {
+    if (endless) {
+        ms_DrawWorld(ms_GetVisibleCells());
+        return;
+    }
+    if (board_cache.width) {
+        Rectangle source = { .x = 0, .y = 0, .width = board_cache.width, .height = -board_cache.height };
+        Vector2 position = { .x = -BOARD_PAD, .y = -BOARD_PAD };
+        DrawTextureRec(board_cache.target.texture, source, position, WHITE);
+        return;
+    }
+    ms_CellRange visible = ms_GetVisibleCells();
+    ms_DrawGrid(visible);
+    ms_DrawGameState(visible);
+}
+
+void ms_DrawGlyph(int glyph, int posX, int posY, Color color) {
+    Rectangle rect = board_cache.glyph_rects[glyph];
+    Vector2 position = {
+        .x = posX + (config.grid_size - (int)rect.width) / 2,
+        .y = posY + (config.grid_size - config.font_size) / 2,
+    };
+    DrawTextureRec(board_cache.glyphs.texture, rect, position, color);
+}
+
+/*Draws the content of one cell at its world position, wiping what was there.*/
+void ms_DrawCell(int x, int y) {
+    int posX = x * config.grid_size;
+    int posY = y * config.grid_size;
+    // cell interior, clear of the grid lines on either side
+    int line = GRID_LINE_THICKNESS / 2 + 1;
+    DrawRectangle(posX + line, posY + line, config.grid_size - 2 * line, config.grid_size - 2 * line, RAYWHITE);
+
+    ms_Cell cell = ms_AtXY(&game, x, y);
+    if (debug_view == ms_DebugProbabilities && !cell.revealed && !cell.flagged) {
+        ms_DrawProbability(x, y, posX, posY);
+    }
+    ms_DrawCellContent(cell, debug_view == ms_DebugMines, posX, posY);
+}
+
+/*Draws the value of a revealed cell, or of any cell with `show_all`, and
+ * otherwise its flag.*/
+void ms_DrawCellContent(ms_Cell cell, bool show_all, int posX, int posY) {
+    if (show_all || cell.revealed) {
+        if (cell.value == MINE) {
+            DrawCircle( posX + config.grid_size/2, posY + config.grid_size/2, (float)config.grid_size/3, RED);
+        } else {
+            ms_DrawGlyph(cell.value, posX, posY, DARKGRAY);
+        }
+    }
+    if (!show_all && cell.flagged) {
+        ms_DrawGlyph(GLYPH_FLAG, posX, posY, RED);
+    }
+}
+
+/*Draws the cells of `range` of the endless board in world coordinates,
+ * loading the chunks that scrolled into view.*/
+void ms_DrawWorld(ms_CellRange range) {
+    ms_DrawGrid(range);
+    for (int y = range.y0; y < range.y1; y++) {
+        int ly = y & (MS_CHUNK_SIZE - 1);
+        for (int cx = ms_ChunkOf(range.x0); cx <= ms_ChunkOf(range.x1 - 1); cx++) {
+            const ms_Chunk *chunk = ms_WorldChunk(&world, cx, ms_ChunkOf(y));
+            int x0 = cx * MS_CHUNK_SIZE;
+            // only the cells that draw something, clipped to the range
+            uint64_t bits = chunk->revealed[ly] | chunk->flagged[ly];
+            if (x0 < range.x0) {
+                bits &= ~(uint64_t)0 << (range.x0 - x0);
             }
-            if (!show_debug && cell->flagged) {
-                char* flag = "M";
-                int text_size = MeasureText(flag, config.font_size);
-                DrawText(
-                    flag,
-                    posX + (config.grid_size - text_size) / 2,
-                    posY + (config.grid_size - config.font_size) / 2,
-                    config.font_size, RED);
+            if (x0 + MS_CHUNK_SIZE > range.x1) {
+                bits &= ((uint64_t)1 << (range.x1 - x0)) - 1;
+            }
+            while (bits) {
+                int lx = __builtin_ctzll(bits);
+                bits &= bits - 1;
+                ms_Cell cell = {
+                    .value = ms_ChunkValue(chunk, lx, ly),
+                    .flagged = (chunk->flagged[ly] >> lx) & 1,
+                    .revealed = (chunk->revealed[ly] >> lx) & 1,
+                };
+                ms_DrawCellContent(cell, false, (x0 + lx) * config.grid_size, y * config.grid_size);
             }
         }
     }
 }
 
-void ms_DrawGrid() {
-    for (int i = 0; i < game.cols + 1; i++) {
-        Vector2 startPosV = { .x = GAME_START_X + i * config.grid_size, .y = GAME_START_Y };
-        Vector2 endPosV = { .x = GAME_START_X + i * config.grid_size, .y = GAME_START_Y + game.rows * config.grid_size };
-        DrawLineEx(startPosV, endPosV, 3, BLACK);
-    }
-    for (int i = 0; i < game.rows + 1; i++) {
-        Vector2 startPosH = { .x = GAME_START_X, .y = GAME_START_Y + i * config.grid_size };
-        Vector2 endPosH = { .x = GAME_START_X + game.cols * config.grid_size, .y = GAME_START_Y + i * config.grid_size };
-        DrawLineEx(startPosH, endPosH, 3, BLACK);
-    }
-}
-
-void ms_ExpandZeros(ms_Pos pos) {
-    ms_Pos queue[EXPERT_ROWS * EXPERT_COLUMNS] = { pos };
-    int index = 0;
-
-    while (index >= 0) {
-        ms_Pos cur = queue[index--];
-        ms_Cell* cell = ms_AtPos(&cur);
-        cell->revealed = true;
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                if (dy == 0 && dx == 0) {
-                    continue;
-                }
-                ms_Pos new_pos = { .x = cur.x + dx, .y = cur.y + dy };
-                if (new_pos.y < 0 || new_pos.y >= game.rows || new_pos.x < 0 || new_pos.x >= game.cols) {
-                    continue;
-                }
-                ms_Cell* cell = ms_AtPos(&new_pos);
-                if (!cell->revealed && !cell->flagged && cell->value == 0) {
-                    queue[++index] = new_pos;
-                }
-                if (!cell->flagged) {
-                    cell->revealed = true;
-                }
+void ms_DrawGameState(ms_CellRange range) {
+    if (range.x0 >= range.x1) {
+        return;
+    }
+    int w0 = range.x0 / 64;
+    int w1 = (range.x1 - 1) / 64;
+    for (int y = range.y0; y < range.y1; y++) {
+        for (int w = w0; w <= w1; w++) {
+            size_t i = (size_t)y * game.stride + w;
+            // only visit cells that draw something
+            uint64_t bits = debug_view != ms_DebugOff ? ms_RowMask(&game, w) : game.revealed[i] | game.flagged[i];
+            if (w * 64 < range.x0) {
+                bits &= ~(uint64_t)0 << (range.x0 & 63);
+            }
+            if (w * 64 + 64 > range.x1) {
+                bits &= ((uint64_t)1 << (range.x1 & 63)) - 1;
+            }
+            while (bits) {
+                int x = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                ms_DrawCell(x, y);
             }
         }
     }
 }
 
+/*Draws the grid lines around the cells of `range` in world coordinates.*/
+void ms_DrawGrid(ms_CellRange range) {
+    int top = range.y0 * config.grid_size;
+    int bottom = range.y1 * config.grid_size;
+    int left = range.x0 * config.grid_size;
+    int right = range.x1 * config.grid_size;
+    for (int i = range.x0; i <= range.x1; i++) {
+        Vector2 startPosV = { .x = i * config.grid_size, .y = top };
+        Vector2 endPosV = { .x = i * config.grid_size, .y = bottom };
+        DrawLineEx(startPosV, endPosV, GRID_LINE_THICKNESS, BLACK);
+    }
+    for (int i = range.y0; i <= range.y1; i++) {
+        Vector2 startPosH = { .x = left, .y = i * config.grid_size };
+        Vector2 endPosH = { .x = right, .y = i * config.grid_size };
+        DrawLineEx(startPosH, endPosH, GRID_LINE_THICKNESS, BLACK);
+    }
+}
+
+/*Screen rectangle the board is shown in.*/
+Rectangle ms_GetViewport() {
+    return (Rectangle) {
+        .x = GAME_START_X,
+        .y = GAME_START_Y,
+        .width = config.width - 2 * PADDING,
+        .height = config.height - 2 * PADDING,
+    };
+}
+
+/*Returns the cells that are at least partly inside the viewport.*/
+ms_CellRange ms_GetVisibleCells() {
+    Rectangle viewport = ms_GetViewport();
+    float left = camera.target.x;
+    float top = camera.target.y;
+    float right = left + viewport.width / camera.zoom;
+    float bottom = top + viewport.height / camera.zoom;
+
+    ms_CellRange range = {
+        .x0 = floorf(left / config.grid_size),
+        .y0 = floorf(top / config.grid_size),
+        .x1 = (int)floorf(right / config.grid_size) + 1,
+        .y1 = (int)floorf(bottom / config.grid_size) + 1,
+    };
+    // the endless board goes on in every direction
+    if (endless) {
+        return range;
+    }
+    if (range.x0 < 0) range.x0 = 0;
+    if (range.y0 < 0) range.y0 = 0;
+    if (range.x1 > game.cols) range.x1 = game.cols;
+    if (range.y1 > game.rows) range.y1 = game.rows;
+    return range;
+}
+
+/*Smallest zoom allowed: the whole board, but never past 1. Boards drawn cell
+ * by cell stop at MIN_CELL_PIXELS so the visible cell count stays bounded.*/
+float ms_GetMinZoom() {
+    if (endless) {
+        return (float)MIN_CELL_PIXELS / config.grid_size;
+    }
+    Rectangle viewport = ms_GetViewport();
+    float fit_x = viewport.width / (game.cols * config.grid_size);
+    float fit_y = viewport.height / (game.rows * config.grid_size);
+    float zoom = fit_x < fit_y ? fit_x : fit_y;
+    if (zoom > 1.0f) {
+        zoom = 1.0f;
+    }
+    if (!board_cache.width && zoom < (float)MIN_CELL_PIXELS / config.grid_size) {
+        zoom = (float)MIN_CELL_PIXELS / config.grid_size;
+    }
+    return zoom;
+}
+
+/*Keeps the zoom in range and the board inside the viewport; a board smaller
+ * than the viewport is centered.*/
+void ms_ClampCamera() {
+    float min_zoom = ms_GetMinZoom();
+    if (camera.zoom < min_zoom) camera.zoom = min_zoom;
+    if (camera.zoom > MAX_ZOOM) camera.zoom = MAX_ZOOM;
+    if (endless) {
+        return;
+    }
+
+    Rectangle viewport = ms_GetViewport();
+    float view_width = viewport.width / camera.zoom;
+    float view_height = viewport.height / camera.zoom;
+    float board_width = game.cols * config.grid_size;
+    float board_height = game.rows * config.grid_size;
+
+    if (view_width >= board_width) {
+        camera.target.x = (board_width - view_width) / 2;
+    } else if (camera.target.x < 0) {
+        camera.target.x = 0;
+    } else if (camera.target.x > board_width - view_width) {
+        camera.target.x = board_width - view_width;
+    }
+    if (view_height >= board_height) {
+        camera.target.y = (board_height - view_height) / 2;
+    } else if (camera.target.y < 0) {
+        camera.target.y = 0;
+    } else if (camera.target.y > board_height - view_height) {
+        camera.target.y = board_height - view_height;
+    }
+}
+
+void ms_ResetCamera() {
+    camera = (Camera2D) {
+        .offset = { .x = GAME_START_X, .y = GAME_START_Y },
+        .target = { .x = 0, .y = 0 },
+        .rotation = 0.0f,
+        .zoom = 1.0f,
+    };
+    if (endless) {
+        // cell (0, 0) in the middle
+        Rectangle viewport = ms_GetViewport();
+        camera.target.x = (config.grid_size - viewport.width) / 2;
+        camera.target.y = (config.grid_size - viewport.height) / 2;
+    }
+    ms_ClampCamera();
+}
+
+/*Mouse wheel zooms around the cursor, dragging with the middle button pans.*/
+void ms_UpdateCamera() {
+    Vector2 mouse_pos = GetMousePosition();
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0 && CheckCollisionPointRec(mouse_pos, ms_GetViewport())) {
+        Vector2 anchor = GetScreenToWorld2D(mouse_pos, camera);
+        camera.zoom *= wheel > 0 ? ZOOM_STEP : 1.0f / ZOOM_STEP;
+        ms_ClampCamera();
+        // keep the point under the cursor in place
+        camera.target.x = anchor.x - (mouse_pos.x - camera.offset.x) / camera.zoom;
+        camera.target.y = anchor.y - (mouse_pos.y - camera.offset.y) / camera.zoom;
+    }
+    if (IsMouseButtonDown(MOUSE_MIDDLE_BUTTON)) {
+        Vector2 delta = GetMouseDelta();
+        camera.target.x -= delta.x / camera.zoom;
+        camera.target.y -= delta.y / camera.zoom;
+    }
+    ms_ClampCamera();
+}
+
 void ms_DrawGameMenu(float game_time) {
     const int BUF_LEN = 64;
     char msg[BUF_LEN];
 
-    snprintf(msg, BUF_LEN, "Mines Left: %d", game.mines_left);
+    if (endless) {
+        snprintf(msg, BUF_LEN, "Revealed: %llu", (unsigned long long)world.revealed_count);
+    } else {
+        snprintf(msg, BUF_LEN, "Mines Left: %d", game.mines_left);
+    }
     DrawText(msg, PADDING, PADDING, MENU_FONT_SIZE, BLUE);
 
     snprintf(msg, BUF_LEN, "Time: %03ld", (long)game_time);
@@ -469,55 +1133,142 @@ void ms_DrawGameMenu(float game_time) {
         SUB_MENU_FONT_SIZE, DARKGRAY);
 }
 
-void ms_InitGameData(ms_Pos *first_click_pos) {
-    ms_Pos mines[EXPERT_MINE_COUNT] = {0};
-    for (size_t i = 0; i < (size_t)game.mines_left; i++) {
-        ms_Pos pos;
-        do {
-            pos.x = rand() % game.cols;
-            pos.y = rand() % game.rows;
-        } while(ms_PosIsNeighbour(&pos, first_click_pos) || ms_AtPos(&pos)->value == MINE);
-        mines[i] = pos;
-        ms_AtPos(&pos)->value = MINE;
-    }
-    for (size_t i = 0; i < (size_t)game.mines_left; i++) {
-        ms_Pos mine = mines[i];
-        // mark neighbours
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                if (dy == 0 && dx == 0) {
-                    continue;
-                }
-                ms_Pos new_pos = { .x = mine.x + dx, .y = mine.y + dy };
-                // check out-of-bounds
-                if (new_pos.y < 0 || new_pos.y >= game.rows || new_pos.x < 0 || new_pos.x >= game.cols) {
-                    continue;
-                }
-                ms_Cell *cell = ms_AtPos(&new_pos);
-                if (cell->value == MINE) {
-                    continue;
-                }
-                cell->value++;
-            }
+/*Draws min/avg/p99 of every frame phase over the last PROFILE_WINDOW frames
+ * in milliseconds, and a graph of their frame times against the 60 fps
+ * budget.*/
+void ms_DrawProfiler() {
+    static ms_FrameSample frames[PROFILE_WINDOW];
+    static uint32_t scratch[PROFILE_WINDOW];
+    ms_ProfileStats stats[ms_PHASE_COUNT + 1];
+    size_t count = ms_ProfileSnapshot(&profiler, frames, PROFILE_WINDOW);
+    ms_ProfileSummarize(frames, count, stats, scratch);
+
+    const int column = 50;
+    int width = PROFILE_WINDOW + 2 * PADDING;
+    int height = (ms_PHASE_COUNT + 2) * PROFILE_ROW_HEIGHT + PROFILE_GRAPH_HEIGHT + 3 * PADDING;
+    int x = PADDING;
+    int y = PADDING;
+    DrawRectangle(x, y, width, height, Fade(BLACK, 0.75f));
+    x += PADDING;
+    y += PADDING;
+
+    const char *headers[] = { "ms", "min", "avg", "p99" };
+    for (size_t i = 0; i < ARRAY_LEN(headers); i++) {
+        DrawText(headers[i], x + i * column, y, PROFILE_FONT_SIZE, LIGHTGRAY);
+    }
+    for (int p = 0; p <= ms_PHASE_COUNT; p++) {
+        y += PROFILE_ROW_HEIGHT;
+        Color color = p == ms_PHASE_COUNT ? YELLOW : WHITE;
+        DrawText(p == ms_PHASE_COUNT ? "frame" : ms_PhaseNames[p], x, y, PROFILE_FONT_SIZE, color);
+        uint32_t values[] = { stats[p].min, stats[p].avg, stats[p].p99 };
+        for (size_t i = 0; i < ARRAY_LEN(values); i++) {
+            DrawText(TextFormat("%.2f", values[i] / 1e6), x + (i + 1) * column, y, PROFILE_FONT_SIZE, color);
         }
     }
+
+    // one bar per frame, newest on the right
+    int bottom = y + PROFILE_ROW_HEIGHT + PADDING + PROFILE_GRAPH_HEIGHT;
+    int budget = bottom - PROFILE_GRAPH_HEIGHT / 2;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t ns = ms_ProfileFrameTime(&frames[i]);
+        int bar = (uint64_t)(ns < PROFILE_GRAPH_MAX_NS ? ns : PROFILE_GRAPH_MAX_NS) * PROFILE_GRAPH_HEIGHT / PROFILE_GRAPH_MAX_NS;
+        Color color = bottom - bar < budget ? RED : GREEN;
+        int bar_x = x + PROFILE_WINDOW - (int)count + (int)i;
+        DrawLine(bar_x, bottom, bar_x, bottom - bar, color);
+    }
+    DrawLine(x, budget, x + PROFILE_WINDOW, budget, Fade(WHITE, 0.5f));
 }
 
-/*Returns true if game is won, false if not.*/
-bool ms_CheckGameWon() {
-    for (int y = 0; y < game.rows; y++) {
-        for (int x = 0; x < game.cols; x++) {
-            ms_Cell *cell = ms_AtXY(x, y);
-            if (cell->revealed) {
-                continue;
-            }
-            if (cell->value == MINE && cell->flagged) {
-                continue;
-            }
-            return false;
+static void *ms_WakeMain(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&wake_timer.lock);
+    while (!wake_timer.stop) {
+        if (!wake_timer.armed) {
+            pthread_cond_wait(&wake_timer.changed, &wake_timer.lock);
+        } else if (pthread_cond_timedwait(&wake_timer.changed, &wake_timer.lock,
+                                          &wake_timer.deadline) == ETIMEDOUT &&
+                   wake_timer.armed)
+        {
+            wake_timer.armed = false;
+            pthread_mutex_unlock(&wake_timer.lock);
+            glfwPostEmptyEvent();
+            pthread_mutex_lock(&wake_timer.lock);
         }
     }
-    return true;
+    pthread_mutex_unlock(&wake_timer.lock);
+    return NULL;
+}
+
+/*Starts the wake thread. Without it (or without glfwPostEmptyEvent) the loop
+ * keeps running while the timer does.*/
+void ms_WakeStart() {
+    if (!glfwPostEmptyEvent) {
+        return;
+    }
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&wake_timer.lock, NULL);
+    pthread_cond_init(&wake_timer.changed, &attr);
+    pthread_condattr_destroy(&attr);
+    wake_timer.running = pthread_create(&wake_timer.thread, NULL, ms_WakeMain, NULL) == 0;
+}
+
+void ms_WakeStop() {
+    if (!wake_timer.running) {
+        return;
+    }
+    pthread_mutex_lock(&wake_timer.lock);
+    wake_timer.stop = true;
+    pthread_cond_signal(&wake_timer.changed);
+    pthread_mutex_unlock(&wake_timer.lock);
+    pthread_join(wake_timer.thread, NULL);
+    pthread_cond_destroy(&wake_timer.changed);
+    pthread_mutex_destroy(&wake_timer.lock);
+    wake_timer = (ms_WakeTimer) {0};
+}
+
+/*Wakes the loop `seconds` from now, replacing the previous deadline.*/
+void ms_WakeAfter(double seconds) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    long ns = deadline.tv_nsec + (long)(fmod(seconds, 1.0) * 1e9);
+    deadline.tv_sec += (time_t)seconds + ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+
+    pthread_mutex_lock(&wake_timer.lock);
+    wake_timer.deadline = deadline;
+    wake_timer.armed = true;
+    pthread_cond_signal(&wake_timer.changed);
+    pthread_mutex_unlock(&wake_timer.lock);
+}
+
+void ms_WakeCancel() {
+    pthread_mutex_lock(&wake_timer.lock);
+    wake_timer.armed = false;
+    pthread_mutex_unlock(&wake_timer.lock);
+}
+
+/*Chooses how the next EndDrawing waits: a frame interval while something
+ * animates, otherwise until input arrives or, with `timer_running`, until the
+ * timer shown in the game menu reaches its next second.*/
+void ms_UpdateIdleMode(bool animating, bool timer_running, double timer) {
+    if (animating || (timer_running && !wake_timer.running)) {
+        DisableEventWaiting();
+        if (wake_timer.running) {
+            ms_WakeCancel();
+        }
+        return;
+    }
+    EnableEventWaiting();
+    if (!wake_timer.running) {
+        return;
+    }
+    if (timer_running) {
+        ms_WakeAfter(floor(timer) + 1 - timer + WAKE_MARGIN);
+    } else {
+        ms_WakeCancel();
+    }
 }
 
 void ms_DrawItem(ms_MenuItem* item, bool selected, bool active) {
@@ -536,10 +1287,10 @@ void ms_DrawItem(ms_MenuItem* item, bool selected, bool active) {
     DrawText(item->name, (MENU_WIDTH-item->text_size)/2, item->y, MENU_FONT_SIZE, font_color);
 }
 
-void ms_InitMenuItems(ms_MenuItem items[3], int beginn_Y) {
-    char* names[] = { "Beginner", "Intermediate", "Expert"};
-    Color colors[] = { GREEN, BLUE, RED };
-    for (size_t i = 0; i < 3; i++) {
+void ms_InitMenuItems(ms_MenuItem items[MENU_ITEMS], int beginn_Y) {
+    char* names[MENU_ITEMS] = { "Beginner", "Intermediate", "Expert", "Custom", "Endless" };
+    Color colors[MENU_ITEMS] = { GREEN, BLUE, RED, PURPLE, ORANGE };
+    for (size_t i = 0; i < ARRAY_LEN(names); i++) {
         items[i].name = names[i];
         items[i].text_size = MeasureText(names[i], MENU_FONT_SIZE);
         items[i].normal = colors[i];
@@ -549,44 +1300,13 @@ void ms_InitMenuItems(ms_MenuItem items[3], int beginn_Y) {
     }
 }
 
-ms_Cell* ms_RevealCell(ms_Pos *pos) {
-    ms_Cell *cell = ms_AtPos(pos);
-    if (cell->revealed || cell->flagged) {
-        return NULL;
-    }
-    cell->revealed = true;
-    return cell;
-}
-
-/*Flag a cell if possible.
- * Returns how the mine_count need to change.
- * Update the mine_count with `mine_count += ms_FlagCell()`.
- *  - 0  invalid cell, dont change mine_count
- *  - +1 flagged a cell, decrease mine_count
- *  - -1 unflagged a cell, increase mine_count*/
-int ms_FlagCell(ms_Pos *pos) {
-    ms_Cell *cell = ms_AtPos(pos);
-    if (cell->revealed) {
-        return 0;
-    }
-    cell->flagged = !cell->flagged;
-    return cell->flagged ? -1 : 1;
-}
-
-void ms_InitGame(int rows, int columns, int mines) {
-    memset(game.game_data, 0, sizeof(game.game_data));
-    game.rows = rows;
-    game.cols = columns;
-    game.mines_left = mines;
-    game.first_click_done = false;
-}
-
 void ms_InitBeginnerGame() {
     config.width = 2 * PADDING + BEGINNER_COLUMNS * BEGINNER_GRID_SIZE;
     config.height = 2 * PADDING + BEGINNER_ROWS * BEGINNER_GRID_SIZE;
     config.grid_size = BEGINNER_GRID_SIZE;
     config.font_size = BEGINNER_FONT_SIZE;
-    ms_InitGame(BEGINNER_ROWS, BEGINNER_COLUMNS, BEGINNER_MINE_COUNT);
+    ms_InitDifficulty(&game, ms_BEGINNER, ms_RngSeedFromTime());
+    ms_SetupBoardView();
 }
 
 void ms_InitIntermediateGame() {
@@ -594,7 +1314,8 @@ void ms_InitIntermediateGame() {
     config.height = 2 * PADDING + INTERMEDIATE_ROWS * INTERMEDIATE_GRID_SIZE;
     config.grid_size = INTERMEDIATE_GRID_SIZE;
     config.font_size = INTERMEDIATE_FONT_SIZE;
-    ms_InitGame(INTERMEDIATE_ROWS, INTERMEDIATE_COLUMNS, INTERMEDIATE_MINE_COUNT);
+    ms_InitDifficulty(&game, ms_INTERMEDIATE, ms_RngSeedFromTime());
+    ms_SetupBoardView();
 }
 
 void ms_InitExpertGame() {
@@ -602,34 +1323,84 @@ void ms_InitExpertGame() {
     config.height = 2 * PADDING + EXPERT_ROWS * EXPERT_GRID_SIZE;
     config.grid_size = EXPERT_GRID_SIZE;
     config.font_size = EXPERT_FONT_SIZE;
-    ms_InitGame(EXPERT_ROWS, EXPERT_COLUMNS, EXPERT_MINE_COUNT);
+    ms_InitDifficulty(&game, ms_EXPERT, ms_RngSeedFromTime());
+    ms_SetupBoardView();
 }
 
-int ms_GetGameStatusStartY() {
-    return GAME_START_Y + config.height + PADDING;
+void ms_InitCustomGame() {
+    config.width = 2 * PADDING + custom.cols * CUSTOM_GRID_SIZE;
+    config.height = 2 * PADDING + custom.rows * CUSTOM_GRID_SIZE;
+    config.grid_size = CUSTOM_GRID_SIZE;
+    config.font_size = CUSTOM_FONT_SIZE;
+    ms_InitGame(&game, custom.rows, custom.cols, custom.mines, ms_RngSeedFromTime());
+    game.band_pool = &band_pool;
+    ms_SetupBoardView();
 }
 
-bool ms_PosEqual(ms_Pos *p1, ms_Pos *p2) {
-    return p1->x == p2->x && p1->y == p2->y;
+/*Starts a new game of the menu entry chosen last: the endless board or a
+ * board of `difficulty`.*/
+void ms_InitSelectedGame(ms_Difficulty difficulty) {
+    if (endless) {
+        ms_InitEndlessGame();
+        return;
+    }
+    switch (difficulty) {
+        case ms_BEGINNER: ms_InitBeginnerGame(); break;
+        case ms_INTERMEDIATE: ms_InitIntermediateGame(); break;
+        case ms_EXPERT: ms_InitExpertGame(); break;
+        case ms_CUSTOM: ms_InitCustomGame(); break;
+        default: assert(0 && "unreachable");
+    }
 }
 
-// Returns true if `pos` is the origin or one of the 8 surrounding cells
-bool ms_PosIsNeighbour(ms_Pos *origin, ms_Pos *pos) {
-    int dx = abs(origin->x-pos->x);
-    int dy = abs(origin->y-pos->y);
-    return (dx <= 1 && dy <= 1);
+/*Opens a new endless world around cell (0, 0). Its chunks are drawn straight
+ * from the world every frame, so only the glyphs are cached.*/
+void ms_InitEndlessGame() {
+    config.width = 2 * PADDING + ENDLESS_COLUMNS * ENDLESS_GRID_SIZE;
+    config.height = 2 * PADDING + ENDLESS_ROWS * ENDLESS_GRID_SIZE;
+    config.grid_size = ENDLESS_GRID_SIZE;
+    config.font_size = ENDLESS_FONT_SIZE;
+    bool ok = ms_WorldInit(&world, ms_RngSeedFromTime(), MS_WORLD_DEFAULT_MINES, MS_WORLD_DEFAULT_CHUNKS);
+    assert(ok && "endless world setup failed");
+    ms_RecorderStop(&recorder);
+    ms_FitToMonitor();
+    ms_LoadGlyphs();
+    ms_ResetCamera();
 }
 
-ms_Cell *ms_AtPos(ms_Pos *pos) {
-    return &game.game_data[pos->y * game.cols + pos->x];
+/*Sizes the window for the new board, shows its top-left corner and starts
+ * the probability and hint engines, the undo steps and the replay over.*/
+void ms_SetupBoardView() {
+    ms_RecorderStop(&recorder);
+    undo_count = 0;
+    no_guess_missed = false;
+    prob_ready = false;
+    hints_ready = false;
+    hint.kind = ms_HINT_NONE;
+    if (debug_view == ms_DebugProbabilities) {
+        ms_ShowProbabilities();
+    }
+    ms_FitToMonitor();
+    ms_LoadBoardCache();
+    ms_ResetCamera();
 }
 
-inline ms_Cell *ms_AtXY(int x, int y) {
-    return &game.game_data[y * game.cols + x];
+/*Shrinks the board area so the game window fits on the current monitor,
+ * the rest of the board is reached through the camera.*/
+void ms_FitToMonitor() {
+    int monitor = GetCurrentMonitor();
+    int max_width = GetMonitorWidth(monitor) - 2 * PADDING - MONITOR_MARGIN;
+    int max_height = GetMonitorHeight(monitor) - GAME_MENU_HEIGHT - GAME_STATUS_HEIGHT - 2 * PADDING - MONITOR_MARGIN;
+    if (max_width > 0 && config.width > max_width) {
+        config.width = max_width;
+    }
+    if (max_height > 0 && config.height > max_height) {
+        config.height = max_height;
+    }
 }
 
-inline ms_Pos ms_PosXY(int x, int y) {
-    return (ms_Pos) { .x = x, .y = y };
+int ms_GetGameStatusStartY() {
+    return GAME_START_Y + config.height + PADDING;
 }
 
 int ms_GetTotalGameWindowWidth() {
@@ -0,0 +1,558 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "minesweeper.h"
+#include "count.h"
+#include "preset.h"
+#include "band.h"
+#include "snapshot.h"
+
+
+static int ms_Stride(int columns) {
+    return (columns + 63) / 64;
+}
+
+/*Returns how many bytes of arena a rows x columns board needs.*/
+size_t ms_GameBytes(int rows, int columns) {
+    size_t words = (size_t)rows * ms_Stride(columns);
+    size_t tiles = (words + MS_TILE_WORDS - 1) / MS_TILE_WORDS;
+    return ms_ArenaAlignUp(words * sizeof(uint64_t))
+        + 2 * ms_PlaneBytes(rows, ms_Stride(columns))
+        + ms_ArenaAlignUp(4 * words * sizeof(uint64_t))
+        + ms_ArenaAlignUp(MS_COUNT_SCRATCH_WORDS(ms_Stride(columns)) * sizeof(uint64_t))
+        + ms_ArenaAlignUp(2 * tiles * sizeof(uint32_t));
+}
+
+/*(Re)initialises `game` for a rows x columns board with `mines` mines.
+ * The mines are placed from `seed` on the first click, so (rows, columns, mines,
+ * first click, seed) always rebuilds the same board.
+ * The arena is only reallocated when the new board is bigger than the old one.
+ * Returns false if the dimensions are invalid or memory runs out.*/
+bool ms_InitGame(ms_Game *game, int rows, int columns, int mines, uint64_t seed) {
+    if (rows <= 0 || columns <= 0 || rows > MS_MAX_SIDE || columns > MS_MAX_SIDE) {
+        return false;
+    }
+    size_t cells = (size_t)rows * columns;
+    // the first click keeps up to 9 cells free of mines
+    if (mines < 0 || (size_t)mines + 9 > cells) {
+        return false;
+    }
+    if (!ms_ArenaReserve(&game->arena, ms_GameBytes(rows, columns))) {
+        return false;
+    }
+    int stride = ms_Stride(columns);
+    size_t words = (size_t)rows * stride;
+    game->mines = ms_ArenaAlloc(&game->arena, words * sizeof(uint64_t));
+    game->revealed = ms_PlaneAlloc(&game->arena, rows, stride);
+    game->flagged = ms_PlaneAlloc(&game->arena, rows, stride);
+    game->counts = ms_ArenaAlloc(&game->arena, 4 * words * sizeof(uint64_t));
+    game->count_scratch = ms_ArenaAlloc(&game->arena, MS_COUNT_SCRATCH_WORDS(stride) * sizeof(uint64_t));
+    game->journal.tiles = (words + MS_TILE_WORDS - 1) / MS_TILE_WORDS;
+    game->journal.stamps = ms_ArenaAlloc(&game->arena, 2 * game->journal.tiles * sizeof(uint32_t));
+    memset(game->arena.base, 0, game->arena.used);
+    game->rows = rows;
+    game->cols = columns;
+    game->stride = stride;
+    for (int k = 0; k < 9; k++) {
+        game->neighbour_offsets[k] = (k / 3 - 1) * columns + (k % 3 - 1);
+    }
+    game->preset = ms_PresetForSize(rows, columns);
+    game->mine_count = mines;
+    game->mines_left = mines;
+    game->banded_mines = ms_BandedPlacement(rows, columns, mines);
+    // no mines until the first click: every cell counts as safe until then
+    game->hidden_safe = cells;
+    game->flagged_mines = 0;
+    game->revealed_mines = 0;
+    game->first_click_done = false;
+    game->state = ms_PLAYING;
+    game->seed = seed;
+    ms_RngSeed(&game->rng, seed);
+    // snapshots of the previous board no longer apply
+    game->journal.epoch = 0;
+    game->journal.count = 0;
+    game->journal.generation++;
+    return true;
+}
+
+void ms_FreeGame(ms_Game *game) {
+    ms_ArenaFree(&game->arena);
+    free(game->delta);
+    free(game->spans);
+    free(game->journal.saved);
+    free(game->journal.saved_tiles);
+    game->journal = (ms_Journal) { .generation = game->journal.generation };
+    game->mines = NULL;
+    game->revealed = NULL;
+    game->flagged = NULL;
+    game->counts = NULL;
+    game->count_scratch = NULL;
+    game->delta = NULL;
+    game->delta_count = 0;
+    game->delta_cap = 0;
+    game->spans = NULL;
+    game->span_cap = 0;
+    game->rows = 0;
+    game->cols = 0;
+}
+
+/*Makes room for `n` elements of `size` bytes in a heap buffer.*/
+void *ms_Grow(void *buffer, size_t *cap, size_t n, size_t size) {
+    if (n > *cap) {
+        size_t new_cap = *cap ? *cap : 256;
+        while (new_cap < n) {
+            new_cap *= 2;
+        }
+        buffer = realloc(buffer, new_cap * size);
+        assert(buffer && "out of memory");
+        *cap = new_cap;
+    }
+    return buffer;
+}
+
+/*Bytes of arena a bordered bitplane takes, guards included.*/
+size_t ms_PlaneBytes(int rows, int stride) {
+    return ms_ArenaAlignUp(((size_t)rows * stride + 2 * MS_PLANE_GUARD(stride)) * sizeof(uint64_t));
+}
+
+/*Carves a bordered bitplane out of `arena` and returns its row 0. The guards
+ * are whatever the arena holds; callers clear the plane with its guards.
+ * Returns NULL if the arena is exhausted.*/
+uint64_t *ms_PlaneAlloc(ms_Arena *arena, int rows, int stride) {
+    uint64_t *plane = ms_ArenaAlloc(arena, ms_PlaneBytes(rows, stride));
+    return plane ? plane + MS_PLANE_GUARD(stride) : NULL;
+}
+
+static void ms_SyncMines(ms_Game *game);
+
+/*Journals the tile of word `i` of a plane before it is written, unless it was
+ * already saved since the last snapshot.*/
+static inline void ms_JournalTouch(ms_Game *game, ms_JournalPlane plane, size_t i) {
+    size_t tile = plane * game->journal.tiles + i / MS_TILE_WORDS;
+    if (game->journal.epoch && game->journal.stamps[tile] != game->journal.epoch) {
+        ms_JournalSave(game, tile);
+    }
+}
+
+static void ms_SetBit(uint64_t *plane, ms_Game *game, int x, int y) {
+    plane[ms_WordIndex(game, x, y)] |= ms_BitMask(x);
+}
+
+/*Reveals a cell that is not revealed yet, records it in the delta and
+ * updates the win bookkeeping.*/
+static void ms_MarkRevealed(ms_Game *game, int x, int y) {
+    size_t i = ms_WordIndex(game, x, y);
+    uint64_t bit = ms_BitMask(x);
+    ms_JournalTouch(game, ms_JOURNAL_REVEALED, i);
+    game->revealed[i] |= bit;
+    if (game->mines[i] & bit) {
+        game->revealed_mines++;
+    } else {
+        game->hidden_safe--;
+    }
+    game->delta = ms_Grow(game->delta, &game->delta_cap, game->delta_count + 1, sizeof(uint32_t));
+    game->delta[game->delta_count++] = (uint32_t)((size_t)y * game->cols + x);
+}
+
+/*Looks up the board size of a preset. Returns false for ms_CUSTOM, whose size
+ * the caller picks.*/
+bool ms_DifficultySize(ms_Difficulty difficulty, int *rows, int *columns, int *mines) {
+    switch (difficulty) {
+        case ms_BEGINNER:
+            *rows = BEGINNER_ROWS;
+            *columns = BEGINNER_COLUMNS;
+            *mines = BEGINNER_MINE_COUNT;
+            return true;
+        case ms_INTERMEDIATE:
+            *rows = INTERMEDIATE_ROWS;
+            *columns = INTERMEDIATE_COLUMNS;
+            *mines = INTERMEDIATE_MINE_COUNT;
+            return true;
+        case ms_EXPERT:
+            *rows = EXPERT_ROWS;
+            *columns = EXPERT_COLUMNS;
+            *mines = EXPERT_MINE_COUNT;
+            return true;
+        case ms_CUSTOM:
+            break;
+    }
+    return false;
+}
+
+void ms_InitDifficulty(ms_Game *game, ms_Difficulty difficulty, uint64_t seed) {
+    int rows, columns, mines;
+    bool preset = ms_DifficultySize(difficulty, &rows, &columns, &mines);
+    // custom boards go through ms_InitGame with the caller's size
+    assert(preset && "custom boards have no preset");
+    ms_InitGame(game, rows, columns, mines, seed);
+}
+
+/*Maps the n-th allowed cell to its board cell, skipping the excluded cells.*/
+static size_t ms_AllowedCell(size_t *excluded, int excluded_count, size_t n) {
+    for (int e = 0; e < excluded_count; e++) {
+        if (n >= excluded[e]) {
+            n++;
+        }
+    }
+    return n;
+}
+
+/*Places the mines anywhere but on the first click and its neighbours, then
+ * computes the neighbour counts.
+ *
+ * Uses Floyd's sampling algorithm over the allowed cells: for j in
+ * [n-k, n) draw t in [0, j] and take t, or j if t is already taken. That picks
+ * a uniformly random k-subset with exactly k draws, whatever the density, and
+ * the mine bitplane doubles as the "taken" set, so it needs no extra memory.*/
+void ms_InitGameData(ms_Game *game, ms_Pos *first_click_pos) {
+    if (game->banded_mines) {
+        ms_PlaceMinesBanded(game, *first_click_pos);
+        ms_SyncMines(game);
+        return;
+    }
+    // the excluded 3x3 block around the first click, in ascending cell order
+    size_t excluded[9];
+    int excluded_count = 0;
+    size_t first = (size_t)first_click_pos->y * game->cols + first_click_pos->x;
+    for (unsigned bits = ms_WindowInside(game, first_click_pos->x, first_click_pos->y); bits; bits &= bits - 1) {
+        excluded[excluded_count++] = first + game->neighbour_offsets[__builtin_ctz(bits)];
+    }
+
+    size_t allowed = (size_t)game->rows * game->cols - excluded_count;
+    for (size_t j = allowed - game->mine_count; j < allowed; j++) {
+        size_t cell = ms_AllowedCell(excluded, excluded_count, ms_RngBelow(&game->rng, j + 1));
+        if (ms_IsMine(game, cell % game->cols, cell / game->cols)) {
+            // j itself can't be taken yet: earlier rounds only drew below j
+            cell = ms_AllowedCell(excluded, excluded_count, j);
+        }
+        ms_SetBit(game->mines, game, cell % game->cols, cell / game->cols);
+    }
+    ms_SyncMines(game);
+}
+
+/*Recomputes the neighbour counts and the win bookkeeping after the mines
+ * changed. Flags may already sit on cells that just became mines.*/
+static void ms_SyncMines(ms_Game *game) {
+    ms_CountNeighbours(game);
+
+    size_t words = (size_t)game->rows * game->stride;
+    size_t revealed_safe = 0;
+    game->flagged_mines = 0;
+    game->revealed_mines = 0;
+    for (size_t i = 0; i < words; i++) {
+        game->flagged_mines += __builtin_popcountll(game->mines[i] & game->flagged[i]);
+        game->revealed_mines += __builtin_popcountll(game->mines[i] & game->revealed[i]);
+        revealed_safe += __builtin_popcountll(~game->mines[i] & game->revealed[i]);
+    }
+    game->hidden_safe = (size_t)game->rows * game->cols - game->mine_count - revealed_safe;
+}
+
+/*Mirrors the mines left to right and/or top to bottom. A no-guess board found
+ * for one click serves every mirror image of that click this way.*/
+void ms_MirrorMines(ms_Game *game, bool flip_x, bool flip_y) {
+    for (int y = 0; flip_y && y < game->rows / 2; y++) {
+        uint64_t *top = &game->mines[(size_t)y * game->stride];
+        uint64_t *bottom = &game->mines[(size_t)(game->rows - 1 - y) * game->stride];
+        for (int w = 0; w < game->stride; w++) {
+            uint64_t word = top[w];
+            top[w] = bottom[w];
+            bottom[w] = word;
+        }
+    }
+    for (int y = 0; flip_x && y < game->rows; y++) {
+        for (int x = 0; x < game->cols / 2; x++) {
+            int mirror = game->cols - 1 - x;
+            if (ms_IsMine(game, x, y) != ms_IsMine(game, mirror, y)) {
+                game->mines[ms_WordIndex(game, x, y)] ^= ms_BitMask(x);
+                game->mines[ms_WordIndex(game, mirror, y)] ^= ms_BitMask(mirror);
+            }
+        }
+    }
+    ms_SyncMines(game);
+}
+
+/*Points the board at a mines plane in the game's layout instead of placing
+ * mines, e.g. a record of a mapped corpus. Nothing writes to the plane, which
+ * has to outlive the board or its next ms_InitGame. `game` must be freshly
+ * initialised with the plane's size and mine count; its first click counts as
+ * done, the click itself is still up to the caller.*/
+void ms_AttachMines(ms_Game *game, const uint64_t *mines) {
+    game->mines = (uint64_t *)mines;
+    ms_SyncMines(game);
+    game->first_click_done = true;
+}
+
+/*Reveals the cell unless it is already revealed or flagged.
+ * Returns true if the cell got revealed by this call.*/
+bool ms_RevealCell(ms_Game *game, ms_Pos *pos) {
+    size_t i = ms_WordIndex(game, pos->x, pos->y);
+    uint64_t bit = ms_BitMask(pos->x);
+    if ((game->revealed[i] | game->flagged[i]) & bit) {
+        return false;
+    }
+    ms_MarkRevealed(game, pos->x, pos->y);
+    return true;
+}
+
+/*Flag a cell if possible.
+ * Returns how the mine_count need to change.
+ * Update the mine_count with `mine_count += ms_FlagCell()`.
+ *  - 0  invalid cell, dont change mine_count
+ *  - +1 flagged a cell, decrease mine_count
+ *  - -1 unflagged a cell, increase mine_count*/
+int ms_FlagCell(ms_Game *game, ms_Pos *pos) {
+    size_t i = ms_WordIndex(game, pos->x, pos->y);
+    uint64_t bit = ms_BitMask(pos->x);
+    if (game->revealed[i] & bit) {
+        return 0;
+    }
+    ms_JournalTouch(game, ms_JOURNAL_FLAGGED, i);
+    game->flagged[i] ^= bit;
+    bool flagged = game->flagged[i] & bit;
+    if (game->mines[i] & bit) {
+        game->flagged_mines += flagged ? 1 : -1;
+    }
+    return flagged ? -1 : 1;
+}
+
+/*True for a zero cell that ms_ExpandZeros still has to open up.*/
+static bool ms_IsClosedZero(ms_Game *game, int x, int y) {
+    size_t i = ms_WordIndex(game, x, y);
+    uint64_t bit = ms_BitMask(x);
+    return !((game->revealed[i] | game->flagged[i] | game->mines[i]) & bit) && ms_CountAt(game, x, y) == 0;
+}
+
+/*Reveals the maximal run of closed zero cells through (x, y), which has to be
+ * one, and pushes it as a span.*/
+static void ms_PushZeroSpan(ms_Game *game, size_t *top, int x, int y) {
+    int x0 = x, x1 = x;
+    ms_MarkRevealed(game, x, y);
+    while (x0 > 0 && ms_IsClosedZero(game, x0 - 1, y)) {
+        ms_MarkRevealed(game, --x0, y);
+    }
+    while (x1 + 1 < game->cols && ms_IsClosedZero(game, x1 + 1, y)) {
+        ms_MarkRevealed(game, ++x1, y);
+    }
+    game->spans = ms_Grow(game->spans, &game->span_cap, *top + 1, sizeof(ms_Span));
+    game->spans[(*top)++] = (ms_Span) { .y = y, .x0 = x0, .x1 = x1 };
+}
+
+/*Opens up the zero region around `pos`: reveals every unflagged neighbour of
+ * the zero cells reachable from `pos`, following zero cells that are not
+ * revealed yet.
+ *
+ * Scanline fill: zero cells are handled as horizontal runs, and the revealed
+ * bitplane doubles as the visited set, so every cell is looked at a constant
+ * number of times and the only extra memory is the heap-allocated span stack.
+ * The neighbours of a run cell still to open are read as one window of the
+ * revealed and flagged planes.
+ * Preset boards take the whole-row kernel of preset.h instead, which reveals
+ * the same cells in row order.
+ * Returns the cells this call revealed; they are also appended to the game
+ * delta.*/
+ms_RevealDelta ms_ExpandZeros(ms_Game *game, ms_Pos pos) {
+    size_t first = game->delta_count;
+    size_t top = 0;
+
+    if (game->preset != ms_CUSTOM) {
+        // the preset kernel finds the region with whole-row masks
+        uint64_t reveal[MS_PRESET_MAX_ROWS];
+        ms_PresetKernelTable[game->preset].zero_region(game, pos, reveal);
+        for (int y = 0; y < game->rows; y++) {
+            for (uint64_t bits = reveal[y]; bits; bits &= bits - 1) {
+                ms_MarkRevealed(game, __builtin_ctzll(bits), y);
+            }
+        }
+        return (ms_RevealDelta) { .cells = game->delta + first, .count = game->delta_count - first };
+    }
+
+    if (!ms_IsRevealed(game, pos.x, pos.y)) {
+        ms_MarkRevealed(game, pos.x, pos.y);
+    }
+    game->spans = ms_Grow(game->spans, &game->span_cap, 1, sizeof(ms_Span));
+    game->spans[top++] = (ms_Span) { .y = pos.y, .x0 = pos.x, .x1 = pos.x };
+
+    while (top > 0) {
+        ms_Span span = game->spans[--top];
+        // windows three cells apart tile the rows around the run, the last
+        // one ends on it so the cell after the run is read too
+        for (int x = span.x0;; x = x + 3 < span.x1 ? x + 3 : span.x1) {
+            for (unsigned bits = ms_WindowHidden(game, x, span.y); bits;) {
+                int k = __builtin_ctz(bits);
+                int nx = x + k % 3 - 1;
+                int ny = span.y + k / 3 - 1;
+                bits &= bits - 1;
+                if (ms_ValueAt(game, nx, ny) == 0) {
+                    ms_PushZeroSpan(game, &top, nx, ny);
+                    // the run may have taken more of the window
+                    bits &= ms_WindowHidden(game, x, span.y);
+                } else {
+                    ms_MarkRevealed(game, nx, ny);
+                }
+            }
+            if (x == span.x1) {
+                break;
+            }
+        }
+    }
+
+    return (ms_RevealDelta) { .cells = game->delta + first, .count = game->delta_count - first };
+}
+
+/*Cells revealed since the last ms_ResetDelta.*/
+ms_RevealDelta ms_GameDelta(const ms_Game *game) {
+    return (ms_RevealDelta) { .cells = game->delta, .count = game->delta_count };
+}
+
+void ms_ResetDelta(ms_Game *game) {
+    game->delta_count = 0;
+}
+
+/*Returns true if game is won, false if not.
+ * The game is won once every cell is either revealed or a flagged mine, which
+ * the reveal/flag bookkeeping tracks without touching the board.*/
+bool ms_CheckGameWon(ms_Game *game) {
+    return game->hidden_safe == 0
+        && game->flagged_mines + game->revealed_mines == game->mine_count;
+}
+
+/*Number of cells that are neither revealed nor flagged, from the bookkeeping.
+ * Only meaningful after the first click.*/
+size_t ms_HiddenCount(const ms_Game *game) {
+    size_t cells = (size_t)game->rows * game->cols;
+    size_t revealed = cells - game->mine_count - game->hidden_safe + game->revealed_mines;
+    size_t flags = game->mine_count - game->mines_left;
+    return cells - revealed - flags;
+}
+
+/*Same answer as ms_CheckGameWon, computed from the bitplanes.
+ * Used to cross-check the incremental bookkeeping.*/
+bool ms_ScanGameWon(ms_Game *game) {
+    if (game->preset != ms_CUSTOM) {
+        return ms_PresetKernelTable[game->preset].scan_won(game);
+    }
+    for (int y = 0; y < game->rows; y++) {
+        for (int w = 0; w < game->stride; w++) {
+            size_t i = (size_t)y * game->stride + w;
+            // cells that are neither revealed nor a flagged mine
+            uint64_t open = ~(game->revealed[i] | (game->mines[i] & game->flagged[i]));
+            if (open & ms_RowMask(game, w)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*Plays a left click on `pos`: places the mines on the first click, reveals the
+ * cell, opens up zero regions and updates `game->state`.*/
+ms_GameState ms_ClickCell(ms_Game *game, ms_Pos *pos) {
+    if (game->state != ms_PLAYING) {
+        return game->state;
+    }
+    ms_ResetDelta(game);
+    if (!game->first_click_done) {
+        ms_InitGameData(game, pos);
+        game->first_click_done = true;
+    }
+    if (ms_RevealCell(game, pos)) {
+        int value = ms_ValueAt(game, pos->x, pos->y);
+        if (value == 0) {
+            ms_ExpandZeros(game, *pos);
+        } else if (value == MINE) {
+            game->state = ms_GAME_OVER;
+            return game->state;
+        }
+    }
+    if (ms_CheckGameWon(game)) {
+        game->state = ms_GAME_WON;
+    }
+    return game->state;
+}
+
+/*Plays a right click on `pos`: toggles the flag and keeps `mines_left` and
+ * `game->state` up to date.*/
+ms_GameState ms_MarkCell(ms_Game *game, ms_Pos *pos) {
+    if (game->state != ms_PLAYING) {
+        return game->state;
+    }
+    ms_ResetDelta(game);
+    game->mines_left += ms_FlagCell(game, pos);
+    if (ms_CheckGameWon(game)) {
+        game->state = ms_GAME_WON;
+    }
+    return game->state;
+}
+
+/*Plays a chord on `pos`: if it is a revealed number with exactly that many
+ * flags around it, reveals every other hidden neighbour the way a click
+ * would, opening up zero regions. A wrong flag loses the game. Anything else
+ * is not a valid chord and changes nothing.*/
+ms_GameState ms_ChordCell(ms_Game *game, ms_Pos *pos) {
+    if (game->state != ms_PLAYING) {
+        return game->state;
+    }
+    ms_ResetDelta(game);
+    if (!ms_IsRevealed(game, pos->x, pos->y) || ms_IsMine(game, pos->x, pos->y)) {
+        return game->state;
+    }
+    unsigned inside = ms_WindowInside(game, pos->x, pos->y);
+    int flags = __builtin_popcount(ms_Window(game->flagged, game->stride, pos->x, pos->y) & inside);
+    int value = ms_CountAt(game, pos->x, pos->y);
+    if (value == 0 || flags != value) {
+        return game->state;
+    }
+    bool lost = false;
+    for (unsigned bits = ms_WindowHidden(game, pos->x, pos->y); bits; bits &= bits - 1) {
+        int k = __builtin_ctz(bits);
+        ms_Pos neighbour = { .x = pos->x + k % 3 - 1, .y = pos->y + k / 3 - 1 };
+        // a zero region opened by an earlier neighbour may have taken it
+        if (!ms_RevealCell(game, &neighbour)) {
+            continue;
+        }
+        int neighbour_value = ms_ValueAt(game, neighbour.x, neighbour.y);
+        if (neighbour_value == 0) {
+            ms_ExpandZeros(game, neighbour);
+        } else if (neighbour_value == MINE) {
+            lost = true;
+        }
+    }
+    if (lost) {
+        game->state = ms_GAME_OVER;
+    } else if (ms_CheckGameWon(game)) {
+        game->state = ms_GAME_WON;
+    }
+    return game->state;
+}
+
+bool ms_PosEqual(ms_Pos *p1, ms_Pos *p2) {
+    return p1->x == p2->x && p1->y == p2->y;
+}
+
+// Returns true if `pos` is the origin or one of the 8 surrounding cells
+bool ms_PosIsNeighbour(ms_Pos *origin, ms_Pos *pos) {
+    int dx = abs(origin->x-pos->x);
+    int dy = abs(origin->y-pos->y);
+    return (dx <= 1 && dy <= 1);
+}
+
+bool ms_PosInside(ms_Game *game, ms_Pos *pos) {
+    return pos->y >= 0 && pos->y < game->rows && pos->x >= 0 && pos->x < game->cols;
+}
+
+ms_Cell ms_AtPos(const ms_Game *game, ms_Pos *pos) {
+    return ms_AtXY(game, pos->x, pos->y);
+}
+
+ms_Cell ms_AtXY(const ms_Game *game, int x, int y) {
+    return (ms_Cell) {
+        .value = ms_ValueAt(game, x, y),
+        .flagged = ms_IsFlagged(game, x, y),
+        .revealed = ms_IsRevealed(game, x, y),
+    };
+}
+
+ms_Pos ms_PosXY(int x, int y) {
+    return (ms_Pos) { .x = x, .y = y };
+}
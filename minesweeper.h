@@ -0,0 +1,270 @@
+#ifndef MINESWEEPER_H
+#define MINESWEEPER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "rng.h"
+
+/* Headless minesweeper engine.
+ * Every function works on an explicit ms_Game handle, so a client can run as
+ * many boards side by side as it likes without opening a window. */
+
+#define BEGINNER_ROWS         9
+#define BEGINNER_COLUMNS      9
+#define BEGINNER_MINE_COUNT  10
+
+#define INTERMEDIATE_ROWS        16
+#define INTERMEDIATE_COLUMNS     16
+#define INTERMEDIATE_MINE_COUNT  40
+
+#define EXPERT_ROWS        16
+#define EXPERT_COLUMNS     30
+#define EXPERT_MINE_COUNT  99
+
+#define MS_MAX_SIDE        16384
+
+// words per undo journal tile: one 64-byte line of a bitplane
+#define MS_TILE_WORDS      8
+
+// zero words on either side of a bordered bitplane: at least a row and a
+// word, rounded to a tile so row 0 stays 64-byte aligned
+#define MS_PLANE_GUARD(stride) (((size_t)(stride) + 1 + MS_TILE_WORDS - 1) & ~(size_t)(MS_TILE_WORDS - 1))
+
+// window bit of cell (x, y) itself, see ms_Window
+#define MS_WINDOW_CENTRE  (1u << 4)
+
+#define MINE               -1
+
+
+/* Unpacked view of a single cell, as returned by ms_AtPos/ms_AtXY.
+ * The board itself never stores cells in this form. */
+typedef struct {
+    int  value;
+    bool flagged;
+    bool revealed;
+} ms_Cell;
+
+typedef struct {
+    int x, y;
+} ms_Pos;
+
+/* Cells revealed by a move, as linear indices y*cols + x. */
+typedef struct {
+    const uint32_t *cells;
+    size_t count;
+} ms_RevealDelta;
+
+/* A run of expanded zero cells [x0, x1] on row y, used by ms_ExpandZeros. */
+typedef struct {
+    int y, x0, x1;
+} ms_Span;
+
+typedef enum {
+    ms_PLAYING,
+    ms_GAME_OVER,
+    ms_GAME_WON,
+} ms_GameState;
+
+typedef enum {
+    ms_BEGINNER = 0,
+    ms_INTERMEDIATE,
+    ms_EXPERT,
+    ms_CUSTOM,
+} ms_Difficulty;
+
+typedef struct ms_BandPool ms_BandPool;
+
+/* Undo journal of the revealed and flagged bitplanes (snapshot.h).
+ *
+ * The planes are split into tiles of MS_TILE_WORDS words. While a snapshot is
+ * open (`epoch` != 0), the first write to a tile after each snapshot copies
+ * the tile to `saved` and its index to `saved_tiles`, so undoing a move copies
+ * back only the tiles it touched. `stamps` holds the epoch of the last save of
+ * every tile, the revealed tiles first, then the flagged ones. `generation`
+ * changes with every ms_InitGame, which empties the journal. */
+typedef struct {
+    uint32_t *stamps;
+    size_t tiles;
+    uint32_t epoch;
+    uint32_t generation;
+    uint64_t *saved;
+    uint32_t *saved_tiles;
+    size_t count;
+    size_t saved_cap;
+    size_t saved_tiles_cap;
+} ms_Journal;
+
+/* Board storage is sized at runtime and carved out of `arena`.
+ *
+ * `hidden_safe` counts the safe cells still to be revealed and
+ * `flagged_mines`/`revealed_mines` the mines that are out of play, so
+ * ms_CheckGameWon never has to look at the cells.
+ *
+ * Cells are kept as bitplanes: bit x%64 of word y*stride + x/64 of `mines`,
+ * `revealed` and `flagged` belongs to cell (x, y). Bits past the last column
+ * of a row are always zero. `revealed` and `flagged` are bordered
+ * (ms_PlaneAlloc): MS_PLANE_GUARD zero words before row 0 and after the last
+ * row act as a sentinel border, so the 3x3 block of any cell can be read
+ * without bounds checks (ms_Window). `neighbour_offsets` holds the linear
+ * index offset y*cols + x of every window bit, so the neighbours a window
+ * selects become cell indices by one addition.
+ *
+ * `counts` holds the 4-bit neighbour count of every cell, 16 per word, laid
+ * out so that bitplane word i owns counts[4*i .. 4*i+3]. That is 7 bits per
+ * cell instead of the 8 bytes of an ms_Cell.
+ *
+ * `count_scratch` holds the per-row temporaries of the count kernels (count.h).
+ *
+ * `delta` lists every cell revealed since the last ms_ResetDelta; ms_ClickCell
+ * and ms_MarkCell reset it, so after a move it holds exactly what that move
+ * opened. Pointers into it stay valid until the next reveal.
+ * `spans` is the span stack of ms_ExpandZeros. Both grow on demand.
+ *
+ * `journal` records what the reveals and flags overwrite, for undo.
+ *
+ * `preset` is the preset whose size the board has, ms_CUSTOM for any other
+ * size; it picks the specialised kernels of preset.h. Setting it to ms_CUSTOM
+ * after ms_InitGame forces the generic code, as the benchmarks do.
+ *
+ * `banded_mines` is set by ms_InitGame for large, dense boards, which place
+ * their mines band by band (band.h). `band_pool` is the thread pool large
+ * boards are generated on, or NULL; it is owned by the caller and kept by
+ * ms_InitGame. */
+typedef struct {
+    uint64_t *mines;
+    uint64_t *revealed;
+    uint64_t *flagged;
+    uint64_t *counts;
+    uint64_t *count_scratch;
+    uint32_t *delta;
+    size_t delta_count;
+    size_t delta_cap;
+    ms_Span *spans;
+    size_t span_cap;
+    int rows;
+    int cols;
+    int stride;
+    int neighbour_offsets[9];
+    int mine_count;
+    int mines_left;
+    // win bookkeeping, kept up to date by every reveal and flag
+    size_t hidden_safe;
+    int flagged_mines;
+    int revealed_mines;
+    bool first_click_done;
+    ms_GameState state;
+    uint64_t seed;
+    ms_Rng rng;
+    ms_Difficulty preset;
+    bool banded_mines;
+    ms_BandPool *band_pool;
+    ms_Journal journal;
+    ms_Arena arena;
+} ms_Game;
+
+
+bool ms_InitGame(ms_Game *game, int rows, int columns, int mines, uint64_t seed);
+void ms_InitDifficulty(ms_Game *game, ms_Difficulty difficulty, uint64_t seed);
+bool ms_DifficultySize(ms_Difficulty difficulty, int *rows, int *columns, int *mines);
+void ms_FreeGame(ms_Game *game);
+size_t ms_GameBytes(int rows, int columns);
+void ms_InitGameData(ms_Game *game, ms_Pos *first_click_pos);
+void ms_MirrorMines(ms_Game *game, bool flip_x, bool flip_y);
+void ms_AttachMines(ms_Game *game, const uint64_t *mines);
+
+bool ms_RevealCell(ms_Game *game, ms_Pos *pos);
+int ms_FlagCell(ms_Game *game, ms_Pos *pos);
+ms_RevealDelta ms_ExpandZeros(ms_Game *game, ms_Pos pos);
+ms_RevealDelta ms_GameDelta(const ms_Game *game);
+void ms_ResetDelta(ms_Game *game);
+bool ms_CheckGameWon(ms_Game *game);
+bool ms_ScanGameWon(ms_Game *game);
+size_t ms_HiddenCount(const ms_Game *game);
+
+ms_GameState ms_ClickCell(ms_Game *game, ms_Pos *pos);
+ms_GameState ms_MarkCell(ms_Game *game, ms_Pos *pos);
+ms_GameState ms_ChordCell(ms_Game *game, ms_Pos *pos);
+
+bool ms_PosEqual(ms_Pos *p1, ms_Pos *p2);
+bool ms_PosIsNeighbour(ms_Pos *origin, ms_Pos *pos);
+bool ms_PosInside(ms_Game *game, ms_Pos *pos);
+ms_Cell ms_AtPos(const ms_Game *game, ms_Pos *pos);
+ms_Cell ms_AtXY(const ms_Game *game, int x, int y);
+ms_Pos ms_PosXY(int x, int y);
+
+void *ms_Grow(void *buffer, size_t *cap, size_t n, size_t size);
+size_t ms_PlaneBytes(int rows, int stride);
+uint64_t *ms_PlaneAlloc(ms_Arena *arena, int rows, int stride);
+
+
+static inline size_t ms_WordIndex(const ms_Game *game, int x, int y) {
+    return (size_t)y * game->stride + (x >> 6);
+}
+
+static inline uint64_t ms_BitMask(int x) {
+    return (uint64_t)1 << (x & 63);
+}
+
+static inline bool ms_IsMine(const ms_Game *game, int x, int y) {
+    return game->mines[ms_WordIndex(game, x, y)] & ms_BitMask(x);
+}
+
+static inline bool ms_IsRevealed(const ms_Game *game, int x, int y) {
+    return game->revealed[ms_WordIndex(game, x, y)] & ms_BitMask(x);
+}
+
+static inline bool ms_IsFlagged(const ms_Game *game, int x, int y) {
+    return game->flagged[ms_WordIndex(game, x, y)] & ms_BitMask(x);
+}
+
+/*Number of mines around (x, y), ignoring whether (x, y) is a mine itself.*/
+static inline int ms_CountAt(const ms_Game *game, int x, int y) {
+    size_t i = ms_WordIndex(game, x, y) * 4 + ((x & 63) >> 4);
+    return (game->counts[i] >> ((x & 15) * 4)) & 0xF;
+}
+
+/*Cell value as the game shows it: MINE or the neighbour count.*/
+static inline int ms_ValueAt(const ms_Game *game, int x, int y) {
+    return ms_IsMine(game, x, y) ? MINE : ms_CountAt(game, x, y);
+}
+
+/*The 3x3 block of bordered `plane` around (x, y) as 9 bits: bit 3*(dy+1) +
+ * (dx+1) is cell (x+dx, y+dy). Bits of cells off the board are meaningless,
+ * mask them with ms_WindowInside.*/
+static inline unsigned ms_Window(const uint64_t *plane, int stride, int x, int y) {
+    // bit x-1 of the row, offset by a word so it is never negative
+    int p = x + 63;
+    int shift = p & 63;
+    const uint64_t *row = plane + (ptrdiff_t)(y - 1) * stride + (p >> 6) - 1;
+    unsigned window = 0;
+    for (int r = 0; r < 3; r++, row += stride) {
+        uint64_t bits = (row[0] >> shift) | ((row[1] << 1) << (63 - shift));
+        window |= (unsigned)(bits & 7) << (3 * r);
+    }
+    return window;
+}
+
+/*Window bits of the cells around (x, y), itself included, that are on the
+ * board. Computed with compares, not branches.*/
+static inline unsigned ms_WindowInside(const ms_Game *game, int x, int y) {
+    unsigned columns = 07 ^ (unsigned)(x == 0) ^ ((unsigned)(x == game->cols - 1) << 2);
+    unsigned rows = 0777 ^ ((unsigned)(y == 0) * 07) ^ ((unsigned)(y == game->rows - 1) * 0700);
+    return columns * 0111 & rows;
+}
+
+/*Window bits of the hidden cells around (x, y).*/
+static inline unsigned ms_WindowHidden(const ms_Game *game, int x, int y) {
+    return ms_WindowInside(game, x, y)
+        & ~(ms_Window(game->revealed, game->stride, x, y) | ms_Window(game->flagged, game->stride, x, y));
+}
+
+/*Mask of the bits of word `w` in a bitplane row that belong to real cells.*/
+static inline uint64_t ms_RowMask(const ms_Game *game, int w) {
+    int rest = game->cols - w * 64;
+    return rest >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << rest) - 1;
+}
+
+#endif // MINESWEEPER_H
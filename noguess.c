@@ -0,0 +1,241 @@
+#include <stdlib.h>
+
+#include "noguess.h"
+
+
+/*Number of click classes of a board: one per cell of its top-left quarter,
+ * middle row and column included.*/
+int ms_ClickClassCount(int rows, int columns) {
+    return ((rows + 1) / 2) * ((columns + 1) / 2);
+}
+
+int ms_ClickClassIndex(int rows, int columns, ms_Pos pos) {
+    int x = pos.x < columns - 1 - pos.x ? pos.x : columns - 1 - pos.x;
+    int y = pos.y < rows - 1 - pos.y ? pos.y : rows - 1 - pos.y;
+    return y * ((columns + 1) / 2) + x;
+}
+
+/*The top-left member of a click class, the click its seeds are searched for.*/
+ms_Pos ms_ClickClassPos(int rows, int columns, int index) {
+    (void)rows;
+    int half = (columns + 1) / 2;
+    return ms_PosXY(index % half, index / half);
+}
+
+/*Returns true if the solver clears the board of `seed` from `first` without
+ * guessing. `scratch` and `solver` are reused between calls.*/
+bool ms_IsNoGuess(ms_Game *scratch, ms_Solver *solver, int rows, int columns, int mines,
+                  ms_Pos first, uint64_t seed)
+{
+    if (!ms_InitGame(scratch, rows, columns, mines, seed) || !ms_SolverInit(solver, scratch)) {
+        return false;
+    }
+    ms_ClickCell(scratch, &first);
+    ms_RevealDelta delta = ms_GameDelta(scratch);
+    ms_SolverUpdate(solver, scratch, delta.cells, delta.count);
+    return ms_SolverPlay(solver, scratch) == ms_GAME_WON;
+}
+
+/*Draws seeds from `rng` until one gives a no-guess board for `first`.
+ * Gives up after MS_NOGUESS_MAX_ATTEMPTS seeds or once `stop` (may be NULL)
+ * is set. Returns true and sets `seed` on success.*/
+bool ms_FindNoGuessSeed(ms_Game *scratch, ms_Solver *solver, int rows, int columns, int mines,
+                        ms_Pos first, ms_Rng *rng, _Atomic bool *stop, uint64_t *seed)
+{
+    for (int attempt = 0; attempt < MS_NOGUESS_MAX_ATTEMPTS; attempt++) {
+        if (stop && atomic_load_explicit(stop, memory_order_relaxed)) {
+            return false;
+        }
+        uint64_t candidate = ms_RngNext(rng);
+        if (ms_IsNoGuess(scratch, solver, rows, columns, mines, first, candidate)) {
+            *seed = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*Places the mines of a no-guess `seed` for the first click `first`. The seed
+ * must have been found for the click class representative of `first`; `game`
+ * must be freshly initialised with the board size the seed was found for.*/
+void ms_PlaceNoGuess(ms_Game *game, ms_Pos *first, uint64_t seed) {
+    ms_Pos origin = ms_ClickClassPos(game->rows, game->cols,
+                                     ms_ClickClassIndex(game->rows, game->cols, *first));
+    game->seed = seed;
+    ms_RngSeed(&game->rng, seed);
+    ms_InitGameData(game, &origin);
+    ms_MirrorMines(game, first->x != origin.x, first->y != origin.y);
+    game->first_click_done = true;
+}
+
+/*Whether every ring of the worker is full.*/
+static bool ms_PoolFull(ms_BoardPool *pool, int index) {
+    for (int r = index; r < pool->ring_count; r += pool->thread_count) {
+        ms_SeedRing *ring = &pool->rings[r];
+        if (atomic_load_explicit(&ring->tail, memory_order_relaxed)
+            - atomic_load_explicit(&ring->head, memory_order_acquire) < MS_POOL_RING_SIZE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*Blocks until ms_PoolTake frees a slot of the worker's rings or the pool
+ * stops. The rings are checked again under the lock, so a take that came in
+ * between is not missed.*/
+static void ms_PoolSleep(ms_BoardPool *pool, int index) {
+    pthread_mutex_lock(&pool->lock);
+    while (!atomic_load(&pool->stop) && ms_PoolFull(pool, index)) {
+        pthread_cond_wait(&pool->wake, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/*Worker loop: keeps topping up the emptiest of its rings.*/
+static void *ms_PoolWork(void *arg) {
+    ms_PoolWorker *worker = arg;
+    ms_BoardPool *pool = worker->pool;
+    ms_Game scratch = {0};
+    ms_Solver solver = {0};
+    ms_Rng rng;
+    ms_RngSeed(&rng, pool->seed + worker->index);
+
+    while (!atomic_load_explicit(&pool->stop, memory_order_relaxed)) {
+        int best = -1;
+        size_t best_fill = MS_POOL_RING_SIZE;
+        for (int r = worker->index; r < pool->ring_count; r += pool->thread_count) {
+            ms_SeedRing *ring = &pool->rings[r];
+            size_t fill = atomic_load_explicit(&ring->tail, memory_order_relaxed)
+                        - atomic_load_explicit(&ring->head, memory_order_acquire);
+            if (fill < best_fill) {
+                best = r;
+                best_fill = fill;
+            }
+        }
+        if (best < 0) {
+            ms_PoolSleep(pool, worker->index);
+            continue;
+        }
+
+        ms_Difficulty difficulty = ms_BEGINNER;
+        while (best >= pool->ring_base[difficulty + 1]) {
+            difficulty++;
+        }
+        int rows, columns, mines;
+        ms_DifficultySize(difficulty, &rows, &columns, &mines);
+        ms_Pos first = ms_ClickClassPos(rows, columns, best - pool->ring_base[difficulty]);
+
+        uint64_t seed;
+        if (ms_FindNoGuessSeed(&scratch, &solver, rows, columns, mines, first, &rng, &pool->stop, &seed)) {
+            ms_SeedRing *ring = &pool->rings[best];
+            size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            ring->seeds[tail & (MS_POOL_RING_SIZE - 1)] = seed;
+            atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+        }
+    }
+
+    ms_SolverFree(&solver);
+    ms_FreeGame(&scratch);
+    return NULL;
+}
+
+/*Starts `threads` workers that fill a ring for every click class of every
+ * preset. Returns false if the rings or threads could not be created.*/
+bool ms_PoolStart(ms_BoardPool *pool, int threads, uint64_t seed) {
+    if (threads < 1) threads = 1;
+    if (threads > MS_POOL_MAX_THREADS) threads = MS_POOL_MAX_THREADS;
+
+    pool->ring_count = 0;
+    for (ms_Difficulty d = ms_BEGINNER; d < ms_CUSTOM; d++) {
+        int rows, columns, mines;
+        ms_DifficultySize(d, &rows, &columns, &mines);
+        pool->ring_base[d] = pool->ring_count;
+        pool->ring_count += ms_ClickClassCount(rows, columns);
+    }
+    pool->ring_base[ms_CUSTOM] = pool->ring_count;
+
+    pool->rings = aligned_alloc(_Alignof(ms_SeedRing), pool->ring_count * sizeof(ms_SeedRing));
+    if (!pool->rings) {
+        return false;
+    }
+    for (int r = 0; r < pool->ring_count; r++) {
+        atomic_init(&pool->rings[r].head, 0);
+        atomic_init(&pool->rings[r].tail, 0);
+    }
+    pool->seed = seed;
+    atomic_init(&pool->stop, false);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    for (int i = 0; i < threads; i++) {
+        pool->workers[i] = (ms_PoolWorker) { .pool = pool, .index = i };
+    }
+    // the workers read thread_count, so it has to be final before they start
+    pool->thread_count = threads;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&pool->workers[i].thread, NULL, ms_PoolWork, &pool->workers[i]) != 0) {
+            pool->thread_count = i;
+            ms_PoolStop(pool);
+            return false;
+        }
+    }
+    return true;
+}
+
+void ms_PoolStop(ms_BoardPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->stop, true);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->rings);
+    pool->rings = NULL;
+    pool->ring_count = 0;
+    pool->thread_count = 0;
+}
+
+/*Takes a ready seed for a first click at `pos` on a preset board. Returns
+ * false if the ring of its click class is empty.*/
+bool ms_PoolTake(ms_BoardPool *pool, ms_Difficulty difficulty, ms_Pos pos, uint64_t *seed) {
+    int rows, columns, mines;
+    if (!pool->rings || !ms_DifficultySize(difficulty, &rows, &columns, &mines)) {
+        return false;
+    }
+    ms_SeedRing *ring = &pool->rings[pool->ring_base[difficulty] + ms_ClickClassIndex(rows, columns, pos)];
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&ring->tail, memory_order_acquire)) {
+        return false;
+    }
+    *seed = ring->seeds[head & (MS_POOL_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    // the worker of this ring may be asleep with all its rings full
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    return true;
+}
+
+/*Places a no-guess board for the first click at `first`, taken from the pool.
+ * `pool` may be NULL. Returns false for custom boards or if the ring of the
+ * click's class is empty, in which case the first click places a random board
+ * as usual: searching here would hold up the click for as long as the search
+ * takes.*/
+bool ms_InitNoGuess(ms_BoardPool *pool, ms_Game *game, ms_Difficulty difficulty, ms_Pos *first) {
+    int rows, columns, mines;
+    if (game->first_click_done || !ms_DifficultySize(difficulty, &rows, &columns, &mines) ||
+        rows != game->rows || columns != game->cols || mines != game->mine_count)
+    {
+        return false;
+    }
+    uint64_t seed;
+    if (!pool || !ms_PoolTake(pool, difficulty, *first, &seed)) {
+        return false;
+    }
+    ms_PlaceNoGuess(game, first, seed);
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef NOGUESS_H
+#define NOGUESS_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+#include "solver.h"
+
+/* No-guess boards.
+ * A board is no-guess if the solver (solver.h) clears it from the first click
+ * without ever guessing. Such boards are found by rejection sampling over
+ * seeds, which at expert density takes too many attempts to do on the first
+ * click, so a pool of worker threads keeps a few ready seeds for every
+ * (difficulty, click class).
+ *
+ * A click class groups a click with its left-right and top-bottom mirror
+ * images. Seeds are searched for the class's top-left member and the board is
+ * mirrored onto the actual click (ms_MirrorMines). Every class has its own
+ * single-producer single-consumer ring of seeds, filled by one worker and
+ * drained by the game, so seeds change hands without a lock. A worker whose
+ * rings are all full sleeps on `wake` until ms_PoolTake frees a slot. */
+
+#define MS_POOL_RING_SIZE       4     // power of two
+#define MS_POOL_MAX_THREADS     16
+#define MS_NOGUESS_MAX_ATTEMPTS 100000
+
+typedef struct {
+    _Alignas(64) _Atomic size_t head;   // next seed to take, written by the game
+    _Alignas(64) _Atomic size_t tail;   // next free slot, written by the worker
+    uint64_t seeds[MS_POOL_RING_SIZE];
+} ms_SeedRing;
+
+typedef struct ms_BoardPool ms_BoardPool;
+
+typedef struct {
+    ms_BoardPool *pool;
+    int index;
+    pthread_t thread;
+} ms_PoolWorker;
+
+/* Ring r belongs to the preset d with ring_base[d] <= r < ring_base[d + 1]
+ * and is filled by worker r % thread_count. */
+struct ms_BoardPool {
+    ms_SeedRing *rings;
+    int ring_count;
+    int ring_base[ms_CUSTOM + 1];
+    ms_PoolWorker workers[MS_POOL_MAX_THREADS];
+    int thread_count;
+    uint64_t seed;
+    _Atomic bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+};
+
+int ms_ClickClassCount(int rows, int columns);
+int ms_ClickClassIndex(int rows, int columns, ms_Pos pos);
+ms_Pos ms_ClickClassPos(int rows, int columns, int index);
+
+bool ms_IsNoGuess(ms_Game *scratch, ms_Solver *solver, int rows, int columns, int mines,
+                  ms_Pos first, uint64_t seed);
+bool ms_FindNoGuessSeed(ms_Game *scratch, ms_Solver *solver, int rows, int columns, int mines,
+                        ms_Pos first, ms_Rng *rng, _Atomic bool *stop, uint64_t *seed);
+void ms_PlaceNoGuess(ms_Game *game, ms_Pos *first, uint64_t seed);
+
+bool ms_PoolStart(ms_BoardPool *pool, int threads, uint64_t seed);
+void ms_PoolStop(ms_BoardPool *pool);
+bool ms_PoolTake(ms_BoardPool *pool, ms_Difficulty difficulty, ms_Pos pos, uint64_t *seed);
+bool ms_InitNoGuess(ms_BoardPool *pool, ms_Game *game, ms_Difficulty difficulty, ms_Pos *first);
+
+#endif // NOGUESS_H
@@ -0,0 +1,153 @@
+#include "preset.h"
+#include "count.h"
+
+
+/*Cells next to a set cell of a row, the row's own set cells included.*/
+static inline uint64_t ms_RowSpread(uint64_t row) {
+    return row | (row << 1) | (row >> 1);
+}
+
+/*Neighbour counts of a board with one word per row: the bit-sliced adder of
+ * count.c on whole rows, spread into nibbles.*/
+static inline __attribute__((always_inline))
+void ms_PresetCount(const uint64_t *mines, uint64_t *counts, const int rows, const int cols) {
+    const uint64_t mask = ((uint64_t)1 << cols) - 1;
+    for (int y = 0; y < rows; y++) {
+        uint64_t a = y > 0 ? mines[y - 1] : 0;
+        uint64_t c = mines[y];
+        uint64_t b = y + 1 < rows ? mines[y + 1] : 0;
+
+        // u = above + below, t = above + row + below
+        uint64_t u0 = a ^ b;
+        uint64_t u1 = a & b;
+        uint64_t t0 = u0 ^ c;
+        uint64_t t1 = u1 | (u0 & c);
+
+        // s = t(x-1) + t(x+1)
+        uint64_t l0 = t0 << 1, l1 = t1 << 1;
+        uint64_t r0 = t0 >> 1, r1 = t1 >> 1;
+        uint64_t carry = l0 & r0;
+        uint64_t s0 = l0 ^ r0;
+        uint64_t s1 = l1 ^ r1 ^ carry;
+        uint64_t s2 = (l1 & r1) | (carry & (l1 ^ r1));
+
+        // n = s + u
+        uint64_t c0 = s0 & u0;
+        uint64_t n0 = (s0 ^ u0) & mask;
+        uint64_t n1 = (s1 ^ u1 ^ c0) & mask;
+        uint64_t c1 = (s1 & u1) | (c0 & (s1 ^ u1));
+        uint64_t n2 = (s2 ^ c1) & mask;
+        uint64_t n3 = (s2 & c1) & mask;
+
+        for (int k = 0; k < 4; k++) {
+            int shift = 16 * k;
+            counts[4 * y + k] = ms_Spread16(n0 >> shift)
+                              | ms_Spread16(n1 >> shift) << 1
+                              | ms_Spread16(n2 >> shift) << 2
+                              | ms_Spread16(n3 >> shift) << 3;
+        }
+    }
+}
+
+/*The zero region around `pos` as whole-row masks: grows the region through
+ * hidden cells without a mine in their 3x3 block until nothing changes, then
+ * reveals every hidden neighbour of it, plus `pos` itself. The same cells the
+ * scanline fill of ms_ExpandZeros reveals. Passes only visit the rows next to
+ * the region so far, so a small region costs a few rows, not the board.*/
+static inline __attribute__((always_inline))
+void ms_PresetZeroRegion(const ms_Game *game, ms_Pos pos, uint64_t *reveal, const int rows, const int cols) {
+    const uint64_t mask = ((uint64_t)1 << cols) - 1;
+    uint64_t closed[MS_PRESET_MAX_ROWS];
+    uint64_t zero[MS_PRESET_MAX_ROWS];
+    uint64_t region[MS_PRESET_MAX_ROWS + 2] = {0};
+    // region[y + 1] belongs to row y, with an empty row on either side
+    uint64_t *r = region + 1;
+    for (int y = 0; y < rows; y++) {
+        uint64_t block = ms_RowSpread(game->mines[y]);
+        block |= y > 0 ? ms_RowSpread(game->mines[y - 1]) : 0;
+        block |= y + 1 < rows ? ms_RowSpread(game->mines[y + 1]) : 0;
+        closed[y] = ~(game->revealed[y] | game->flagged[y]) & mask;
+        zero[y] = closed[y] & ~block;
+        reveal[y] = 0;
+    }
+    r[pos.y] = ms_BitMask(pos.x);
+
+    int lo = pos.y, hi = pos.y;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        int from = lo > 0 ? lo - 1 : 0;
+        int to = hi + 1 < rows ? hi + 1 : rows - 1;
+        for (int y = from; y <= to; y++) {
+            uint64_t grown = r[y] | (ms_RowSpread(r[y - 1] | r[y] | r[y + 1]) & zero[y]);
+            if (grown == r[y]) {
+                continue;
+            }
+            // runs of zero cells fill along the row in the same pass
+            uint64_t run;
+            do {
+                run = grown;
+                grown |= ms_RowSpread(grown) & zero[y];
+            } while (grown != run);
+            r[y] = grown;
+            changed = true;
+            lo = y < lo ? y : lo;
+            hi = y > hi ? y : hi;
+        }
+    }
+
+    int from = lo > 0 ? lo - 1 : 0;
+    int to = hi + 1 < rows ? hi + 1 : rows - 1;
+    for (int y = from; y <= to; y++) {
+        reveal[y] = ms_RowSpread(r[y - 1] | r[y] | r[y + 1]) & closed[y];
+    }
+    reveal[pos.y] |= ms_BitMask(pos.x) & ~game->revealed[pos.y];
+}
+
+static inline __attribute__((always_inline))
+bool ms_PresetScanWon(const ms_Game *game, const int rows, const int cols) {
+    const uint64_t mask = ((uint64_t)1 << cols) - 1;
+    for (int y = 0; y < rows; y++) {
+        if (~(game->revealed[y] | (game->mines[y] & game->flagged[y])) & mask) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#define MS_PRESET_KERNELS(name, ROWS, COLS)                                                  \
+    _Static_assert((COLS) < 64 && (ROWS) <= MS_PRESET_MAX_ROWS, #name " rows must fit a word"); \
+    static void ms_Count##name(ms_Game *game) {                                               \
+        ms_PresetCount(game->mines, game->counts, ROWS, COLS);                               \
+    }                                                                                        \
+    static void ms_ZeroRegion##name(const ms_Game *game, ms_Pos pos, uint64_t *reveal) {      \
+        ms_PresetZeroRegion(game, pos, reveal, ROWS, COLS);                                  \
+    }                                                                                        \
+    static bool ms_ScanWon##name(const ms_Game *game) {                                      \
+        return ms_PresetScanWon(game, ROWS, COLS);                                           \
+    }
+
+MS_PRESET_KERNELS(Beginner, BEGINNER_ROWS, BEGINNER_COLUMNS)
+MS_PRESET_KERNELS(Intermediate, INTERMEDIATE_ROWS, INTERMEDIATE_COLUMNS)
+MS_PRESET_KERNELS(Expert, EXPERT_ROWS, EXPERT_COLUMNS)
+
+#define MS_PRESET_ENTRY(name) { ms_Count##name, ms_ZeroRegion##name, ms_ScanWon##name }
+
+const ms_PresetKernels ms_PresetKernelTable[ms_CUSTOM] = {
+    [ms_BEGINNER]     = MS_PRESET_ENTRY(Beginner),
+    [ms_INTERMEDIATE] = MS_PRESET_ENTRY(Intermediate),
+    [ms_EXPERT]       = MS_PRESET_ENTRY(Expert),
+};
+
+/*The preset a rows x columns board has the size of, or ms_CUSTOM. The mine
+ * count does not matter to the kernels.*/
+ms_Difficulty ms_PresetForSize(int rows, int columns) {
+    for (ms_Difficulty d = ms_BEGINNER; d < ms_CUSTOM; d++) {
+        int preset_rows, preset_columns, mines;
+        ms_DifficultySize(d, &preset_rows, &preset_columns, &mines);
+        if (rows == preset_rows && columns == preset_columns) {
+            return d;
+        }
+    }
+    return ms_CUSTOM;
+}
@@ -0,0 +1,35 @@
+#ifndef PRESET_H
+#define PRESET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+
+/* Kernels specialised for the preset board sizes.
+ * Every preset is at most 64 columns wide, so a row of a bitplane is a single
+ * word and the kernels work on whole rows: the neighbours of a row are two
+ * shifts and the rows above and below, with no bounds checks per cell. Each
+ * kernel body is instantiated per preset with the rows and columns as
+ * compile-time constants, so the compiler unrolls the row loops and folds the
+ * column masks.
+ *
+ * ms_InitGame sets `game->preset` to the preset the board size matches, and
+ * ms_CountNeighbours, ms_ExpandZeros and ms_ScanGameWon dispatch through this
+ * table; boards of any other size (ms_CUSTOM) run the generic code. */
+
+#define MS_PRESET_MAX_ROWS 16
+
+typedef struct {
+    // the counts plane from the mines plane, as ms_CountNeighbours
+    void (*count)(ms_Game *game);
+    // the cells ms_ExpandZeros(game, pos) reveals, one mask per row
+    void (*zero_region)(const ms_Game *game, ms_Pos pos, uint64_t *reveal);
+    bool (*scan_won)(const ms_Game *game);
+} ms_PresetKernels;
+
+extern const ms_PresetKernels ms_PresetKernelTable[ms_CUSTOM];
+
+ms_Difficulty ms_PresetForSize(int rows, int columns);
+
+#endif // PRESET_H
@@ -0,0 +1,614 @@
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prob.h"
+
+
+// series entries below this fraction of the series maximum are dropped
+#define MS_PROB_NEGLIGIBLE 1e-30
+
+/* Search state of the cells that see exactly the same numbers. A cell sees at
+ * most 8 numbers and a group lies within the 3x3 block of each of them. */
+typedef struct ms_ProbGroup {
+    int size;
+    int mines;
+    int constraint_count;
+    int constraints[8];
+} ms_ProbGroup;
+
+/* Search state of one number. */
+typedef struct ms_ProbConstraint {
+    int remaining;
+    int mines;
+    int unassigned;
+} ms_ProbConstraint;
+
+static uint32_t ms_ProbCell(const ms_Game *game, int x, int y) {
+    return (uint32_t)y * game->cols + x;
+}
+
+static bool ms_ProbInside(const ms_Game *game, int x, int y) {
+    return x >= 0 && x < game->cols && y >= 0 && y < game->rows;
+}
+
+static void ms_ProbKill(ms_ProbEngine *engine, uint32_t slot);
+
+/*Sets the engine up for `game`, which may already be in progress. Memory is
+ * reused when the new board is not bigger than the last one. Returns false if
+ * memory runs out.*/
+bool ms_ProbInit(ms_ProbEngine *engine, const ms_Game *game) {
+    for (size_t i = 0; i < engine->component_cap; i++) {
+        if (engine->components[i].alive) {
+            ms_ProbKill(engine, i);
+        }
+    }
+    if (!ms_FrontierInit(&engine->frontier, game)) {
+        return false;
+    }
+    size_t plane = ms_ArenaAlignUp((size_t)game->rows * game->cols * sizeof(uint32_t));
+    if (!ms_ArenaReserve(&engine->arena, 2 * plane)) {
+        return false;
+    }
+    engine->component = ms_ArenaAlloc(&engine->arena, plane);
+    engine->index = ms_ArenaAlloc(&engine->arena, plane);
+    memset(engine->arena.base, 0, engine->arena.used);
+    engine->seed_count = 0;
+    engine->interior = NAN;
+    engine->interior_count = 0;
+    engine->dirty = true;
+    engine->rebuild = false;
+    engine->searched = 0;
+    return true;
+}
+
+void ms_ProbFree(ms_ProbEngine *engine) {
+    for (size_t i = 0; i < engine->component_cap; i++) {
+        free(engine->components[i].cells);
+        free(engine->components[i].weight);
+    }
+    free(engine->components);
+    free(engine->seeds);
+    free(engine->vars);
+    free(engine->constraints);
+    free(engine->groups);
+    free(engine->numbers);
+    free(engine->series);
+    free(engine->suffix);
+    free(engine->order);
+    ms_FrontierFree(&engine->frontier);
+    ms_ArenaFree(&engine->arena);
+    *engine = (ms_ProbEngine) {0};
+}
+
+/*Drops a component. Its numbers become seeds and are searched again on the
+ * next ms_ProbCompute.*/
+static void ms_ProbKill(ms_ProbEngine *engine, uint32_t slot) {
+    ms_ProbComponent *c = &engine->components[slot];
+    engine->seeds = ms_Grow(engine->seeds, &engine->seed_cap,
+                            engine->seed_count + c->constraint_count, sizeof(uint32_t));
+    for (int i = 0; i < c->var_count + c->constraint_count; i++) {
+        engine->component[c->cells[i]] = 0;
+        if (i >= c->var_count) {
+            engine->seeds[engine->seed_count++] = c->cells[i];
+        }
+    }
+    free(c->cells);
+    free(c->weight);
+    *c = (ms_ProbComponent) {0};
+}
+
+/*Feeds the cells a move revealed or (un)flagged to the engine. Every component
+ * with a cell within one cell of a changed cell is dropped, the others keep
+ * their search results.*/
+void ms_ProbUpdate(ms_ProbEngine *engine, const ms_Game *game, const uint32_t *cells, size_t count) {
+    ms_FrontierTouchCells(&engine->frontier, game, cells, count);
+    engine->dirty = true;
+    if (count > (size_t)game->rows * game->stride) {
+        // the frontier was rebuilt instead, so are the components
+        engine->rebuild = true;
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int x = cells[i] % game->cols;
+        int y = cells[i] / game->cols;
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+            for (int nx = x - 1; nx <= x + 1; nx++) {
+                if (!ms_ProbInside(game, nx, ny)) {
+                    continue;
+                }
+                uint32_t id = engine->component[ms_ProbCell(game, nx, ny)];
+                if (id) {
+                    ms_ProbKill(engine, id - 1);
+                }
+            }
+        }
+    }
+}
+
+static uint32_t ms_ProbNewSlot(ms_ProbEngine *engine) {
+    for (size_t i = 0; i < engine->component_cap; i++) {
+        if (!engine->components[i].alive) {
+            return i;
+        }
+    }
+    size_t old_cap = engine->component_cap;
+    engine->components = ms_Grow(engine->components, &engine->component_cap, old_cap + 1, sizeof(ms_ProbComponent));
+    for (size_t i = old_cap; i < engine->component_cap; i++) {
+        engine->components[i] = (ms_ProbComponent) {0};
+    }
+    return old_cap;
+}
+
+static double ms_Binomial(int n, int k) {
+    double result = 1;
+    for (int i = 1; i <= k; i++) {
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
+
+/*Enumerates the mine counts of groups [g, group_count), adding every layout
+ * that fits all numbers to the component's series. Returns false once the node
+ * budget is used up.*/
+static bool ms_ProbSearch(ms_ProbEngine *engine, int g, int mines, double weight, int max_mines) {
+    if (++engine->nodes > MS_PROB_NODE_BUDGET) {
+        return false;
+    }
+    if (g == engine->group_count) {
+        size_t width = engine->var_count + 1;
+        engine->weight[mines] += weight;
+        for (int i = 0; i < engine->group_count; i++) {
+            engine->group_mines[i * width + mines] += weight * engine->groups[i].mines;
+        }
+        return true;
+    }
+    ms_ProbGroup *group = &engine->groups[g];
+    int m;
+    for (m = 0; m <= group->size && mines + m <= max_mines; m++) {
+        bool fits = true;
+        for (int i = 0; i < group->constraint_count; i++) {
+            ms_ProbConstraint *c = &engine->numbers[group->constraints[i]];
+            c->mines += m;
+            c->unassigned -= group->size;
+            fits = fits && c->mines <= c->remaining && c->mines + c->unassigned >= c->remaining;
+        }
+        group->mines = m;
+        bool within_budget = !fits || ms_ProbSearch(engine, g + 1, mines + m,
+                                                    weight * ms_Binomial(group->size, m), max_mines);
+        for (int i = 0; i < group->constraint_count; i++) {
+            ms_ProbConstraint *c = &engine->numbers[group->constraints[i]];
+            c->mines -= m;
+            c->unassigned += group->size;
+        }
+        if (!within_budget) {
+            return false;
+        }
+    }
+    engine->cut = engine->cut || m <= group->size;
+    return true;
+}
+
+/*Collects the numbers next to the frontier cell `cell` as indices into the
+ * component's numbers, ascending. Two cells are in the same group iff these
+ * match.*/
+static int ms_ProbSeenBy(const ms_ProbEngine *engine, const ms_Game *game, uint32_t id, uint32_t cell, int *out) {
+    int x = cell % game->cols;
+    int y = cell / game->cols;
+    int count = 0;
+    for (int ny = y - 1; ny <= y + 1; ny++) {
+        for (int nx = x - 1; nx <= x + 1; nx++) {
+            if (!ms_ProbInside(game, nx, ny)) {
+                continue;
+            }
+            uint32_t n = ms_ProbCell(game, nx, ny);
+            if (engine->component[n] == id && engine->index[n] >= (uint32_t)engine->var_count) {
+                out[count++] = engine->index[n] - engine->var_count;
+            }
+        }
+    }
+    for (int i = 1; i < count; i++) {
+        for (int j = i; j > 0 && out[j - 1] > out[j]; j--) {
+            int t = out[j];
+            out[j] = out[j - 1];
+            out[j - 1] = t;
+        }
+    }
+    return count;
+}
+
+static void ms_ProbAddVar(ms_ProbEngine *engine, uint32_t id, uint32_t cell) {
+    engine->component[cell] = id;
+    engine->vars = ms_Grow(engine->vars, &engine->vars_cap, engine->var_count + 1, sizeof(uint32_t));
+    engine->vars[engine->var_count++] = cell;
+}
+
+static void ms_ProbAddConstraint(ms_ProbEngine *engine, uint32_t id, uint32_t cell) {
+    engine->component[cell] = id;
+    engine->constraints = ms_Grow(engine->constraints, &engine->constraints_cap,
+                                  engine->constraint_count + 1, sizeof(uint32_t));
+    engine->constraints[engine->constraint_count++] = cell;
+}
+
+/*Collects the numbers and hidden cells linked to the frontier cell `start`.*/
+static void ms_ProbCollect(ms_ProbEngine *engine, const ms_Game *game, uint32_t id, uint32_t start) {
+    engine->var_count = 0;
+    engine->constraint_count = 0;
+    ms_ProbAddConstraint(engine, id, start);
+    for (int k = 0; k < engine->constraint_count; k++) {
+        int x = engine->constraints[k] % game->cols;
+        int y = engine->constraints[k] / game->cols;
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+            for (int nx = x - 1; nx <= x + 1; nx++) {
+                if (!ms_ProbInside(game, nx, ny) || !ms_IsHidden(game, nx, ny) ||
+                    engine->component[ms_ProbCell(game, nx, ny)])
+                {
+                    continue;
+                }
+                ms_ProbAddVar(engine, id, ms_ProbCell(game, nx, ny));
+                for (int my = ny - 1; my <= ny + 1; my++) {
+                    for (int mx = nx - 1; mx <= nx + 1; mx++) {
+                        if (ms_ProbInside(game, mx, my) && ms_FrontierHas(&engine->frontier, mx, my) &&
+                            !engine->component[ms_ProbCell(game, mx, my)])
+                        {
+                            ms_ProbAddConstraint(engine, id, ms_ProbCell(game, mx, my));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    for (int v = 0; v < engine->var_count; v++) {
+        engine->index[engine->vars[v]] = v;
+    }
+    for (int k = 0; k < engine->constraint_count; k++) {
+        engine->index[engine->constraints[k]] = engine->var_count + k;
+    }
+}
+
+/*Sets up the numbers and groups of the collected component for the search.*/
+static void ms_ProbPrepare(ms_ProbEngine *engine, const ms_Game *game, uint32_t id, ms_ProbComponent *c) {
+    engine->numbers = ms_Grow(engine->numbers, &engine->numbers_cap, engine->constraint_count,
+                              sizeof(ms_ProbConstraint));
+    for (int k = 0; k < engine->constraint_count; k++) {
+        int x = engine->constraints[k] % game->cols;
+        int y = engine->constraints[k] / game->cols;
+        ms_ProbConstraint *number = &engine->numbers[k];
+        *number = (ms_ProbConstraint) { .remaining = ms_CountAt(game, x, y) };
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+            for (int nx = x - 1; nx <= x + 1; nx++) {
+                if (!ms_ProbInside(game, nx, ny) || (nx == x && ny == y)) {
+                    continue;
+                }
+                if (ms_IsFlagged(game, nx, ny)) {
+                    number->remaining--;
+                } else if (!ms_IsRevealed(game, nx, ny)) {
+                    number->unassigned++;
+                }
+            }
+        }
+    }
+
+    // a cell is found while its first number in discovery order is expanded,
+    // so the cells of a group are at most 8 apart in `vars`
+    engine->groups = ms_Grow(engine->groups, &engine->groups_cap, engine->var_count, sizeof(ms_ProbGroup));
+    engine->group_count = 0;
+    for (int v = 0; v < engine->var_count; v++) {
+        ms_ProbGroup key = {0};
+        key.constraint_count = ms_ProbSeenBy(engine, game, id, engine->vars[v], key.constraints);
+        int g = engine->group_count - 1;
+        for (; g >= 0 && g >= engine->group_count - 8; g--) {
+            ms_ProbGroup *group = &engine->groups[g];
+            if (group->constraint_count == key.constraint_count &&
+                memcmp(group->constraints, key.constraints, key.constraint_count * sizeof(int)) == 0)
+            {
+                break;
+            }
+        }
+        if (g < 0 || g < engine->group_count - 8) {
+            g = engine->group_count++;
+            engine->groups[g] = key;
+        }
+        engine->groups[g].size++;
+        c->group_of[v] = g;
+    }
+    c->group_count = engine->group_count;
+    for (int g = 0; g < c->group_count; g++) {
+        c->group_size[g] = engine->groups[g].size;
+    }
+}
+
+/*Builds and searches the component of the frontier cell `start`.*/
+static void ms_ProbBuild(ms_ProbEngine *engine, const ms_Game *game, uint32_t start) {
+    uint32_t slot = ms_ProbNewSlot(engine);
+    uint32_t id = slot + 1;
+    ms_ProbCollect(engine, game, id, start);
+
+    int var_count = engine->var_count;
+    int constraint_count = engine->constraint_count;
+    ms_ProbComponent *c = &engine->components[slot];
+    *c = (ms_ProbComponent) {
+        .alive = true,
+        .var_count = var_count,
+        .constraint_count = constraint_count,
+        .limit = INT_MAX,
+    };
+    c->cells = malloc((size_t)(var_count + constraint_count) * sizeof(uint32_t)
+                      + (size_t)var_count * (2 * sizeof(int) + sizeof(float)));
+    assert(c->cells && "out of memory");
+    c->group_of = (int *)(c->cells + var_count + constraint_count);
+    c->group_size = c->group_of + var_count;
+    c->var_prob = (float *)(c->group_size + var_count);
+    memcpy(c->cells, engine->vars, var_count * sizeof(uint32_t));
+    memcpy(c->cells + var_count, engine->constraints, constraint_count * sizeof(uint32_t));
+    ms_ProbPrepare(engine, game, id, c);
+
+    size_t width = var_count + 1;
+    c->weight = calloc(width * (1 + c->group_count), sizeof(double));
+    assert(c->weight && "out of memory");
+    c->group_mines = c->weight + width;
+    engine->weight = c->weight;
+    engine->group_mines = c->group_mines;
+    engine->nodes = 0;
+    engine->cut = false;
+    int max_mines = game->mines_left > 0 ? game->mines_left : 0;
+    c->exact = ms_ProbSearch(engine, 0, 0, 1.0, max_mines);
+    c->limit = engine->cut ? max_mines : INT_MAX;
+    engine->searched++;
+
+    double peak = 0;
+    c->min_mines = var_count + 1;
+    c->max_mines = -1;
+    for (int k = 0; k <= var_count; k++) {
+        if (c->weight[k] > 0) {
+            peak = c->weight[k] > peak ? c->weight[k] : peak;
+            c->min_mines = k < c->min_mines ? k : c->min_mines;
+            c->max_mines = k;
+        }
+    }
+    if (peak == 0 || !isfinite(peak)) {
+        // no layout fits (a flag is wrong) or the weights overflowed
+        c->exact = false;
+        return;
+    }
+    for (size_t i = 0; i < width * (1 + c->group_count); i++) {
+        c->weight[i] /= peak;
+    }
+}
+
+/*Appends `len` zeroed doubles to the series buffer and returns their offset.*/
+static size_t ms_ProbPush(ms_ProbEngine *engine, size_t len) {
+    engine->series = ms_Grow(engine->series, &engine->series_cap, engine->series_count + len, sizeof(double));
+    size_t offset = engine->series_count;
+    memset(engine->series + offset, 0, len * sizeof(double));
+    engine->series_count += len;
+    return offset;
+}
+
+/*Rescales a series to a maximum of 1 and trims negligible entries off both
+ * ends. An all-zero series ends up empty.*/
+static void ms_ProbNormalize(ms_ProbEngine *engine, ms_ProbSeries *s) {
+    double *v = engine->series + s->offset;
+    double peak = 0;
+    for (int i = 0; i < s->len; i++) {
+        peak = v[i] > peak ? v[i] : peak;
+    }
+    if (peak == 0 || !isfinite(peak)) {
+        s->len = 0;
+        return;
+    }
+    for (int i = 0; i < s->len; i++) {
+        v[i] /= peak;
+    }
+    int first = 0, last = s->len - 1;
+    while (v[first] < MS_PROB_NEGLIGIBLE) first++;
+    while (v[last] < MS_PROB_NEGLIGIBLE) last--;
+    s->lo += first;
+    s->offset += first;
+    s->len = last - first + 1;
+}
+
+static double ms_ProbSeriesAt(const ms_ProbEngine *engine, const ms_ProbSeries *s, int t) {
+    return t >= s->lo && t < s->lo + s->len ? engine->series[s->offset + t - s->lo] : 0;
+}
+
+/*Marks every exact component and the interior as unknown; the numbers and
+ * flags on the board contradict each other.*/
+static void ms_ProbContradiction(ms_ProbEngine *engine, size_t exact_count) {
+    for (size_t i = 0; i < exact_count; i++) {
+        ms_ProbComponent *c = &engine->components[engine->order[i]];
+        for (int v = 0; v < c->var_count; v++) {
+            c->var_prob[v] = NAN;
+        }
+    }
+    engine->interior = NAN;
+}
+
+/*Weights of the interior by the number of mines t on the frontier: the
+ * interior holds the other `left - t` mines in C(interior, left - t) ways.*/
+static bool ms_ProbInterior(ms_ProbEngine *engine, ms_ProbSeries *s, long interior, int left) {
+    s->lo = left - interior > 0 ? left - interior : 0;
+    s->len = left - s->lo + 1;
+    s->offset = ms_ProbPush(engine, s->len);
+    double *v = engine->series + s->offset;
+    double peak = -INFINITY;
+    for (int i = 0; i < s->len; i++) {
+        int rest = left - (s->lo + i);
+        v[i] = -lgamma(rest + 1.0) - lgamma(interior - rest + 1.0);
+        peak = v[i] > peak ? v[i] : peak;
+    }
+    for (int i = 0; i < s->len; i++) {
+        v[i] = exp(v[i] - peak);
+    }
+    ms_ProbNormalize(engine, s);
+    return s->len > 0;
+}
+
+/*Combines the exact components and the interior into per-cell probabilities.
+ * suffix[i] holds the weights of the components after the i-th together with
+ * the interior, by the mines they hold; a forward series carries the
+ * components before it.*/
+static void ms_ProbCombine(ms_ProbEngine *engine, const ms_Game *game) {
+    size_t exact_count = 0;
+    size_t frontier_cells = 0;
+    int widest = 1;
+    for (size_t i = 0; i < engine->component_cap; i++) {
+        ms_ProbComponent *c = &engine->components[i];
+        if (c->alive && c->exact) {
+            engine->order = ms_Grow(engine->order, &engine->order_cap, exact_count + 1, sizeof(uint32_t));
+            engine->order[exact_count++] = i;
+            frontier_cells += c->var_count;
+            widest = c->var_count + 1 > widest ? c->var_count + 1 : widest;
+        }
+    }
+    int left = game->mines_left;
+    long interior = (long)ms_HiddenCount(game) - (long)frontier_cells;
+    engine->interior_count = interior > 0 ? interior : 0;
+    engine->series_count = 0;
+    engine->suffix = ms_Grow(engine->suffix, &engine->suffix_cap, exact_count + 1, sizeof(ms_ProbSeries));
+    if (left < 0 || interior < 0 || !ms_ProbInterior(engine, &engine->suffix[exact_count], interior, left)) {
+        ms_ProbContradiction(engine, exact_count);
+        return;
+    }
+
+    for (size_t i = exact_count; i-- > 1;) {
+        const ms_ProbComponent *c = &engine->components[engine->order[i]];
+        const ms_ProbSeries *next = &engine->suffix[i + 1];
+        ms_ProbSeries *cur = &engine->suffix[i];
+        cur->lo = next->lo - c->max_mines > 0 ? next->lo - c->max_mines : 0;
+        cur->len = next->lo + next->len - c->min_mines - cur->lo;
+        if (cur->len <= 0) {
+            ms_ProbContradiction(engine, exact_count);
+            return;
+        }
+        cur->offset = ms_ProbPush(engine, cur->len);
+        for (int t = 0; t < cur->len; t++) {
+            double sum = 0;
+            for (int k = c->min_mines; k <= c->max_mines; k++) {
+                sum += c->weight[k] * ms_ProbSeriesAt(engine, next, cur->lo + t + k);
+            }
+            engine->series[cur->offset + t] = sum;
+        }
+        ms_ProbNormalize(engine, cur);
+    }
+
+    // the forward series ping-pongs between two buffers of `left + 1`
+    // entries, it never holds more mines than are left
+    size_t rest = ms_ProbPush(engine, widest);
+    size_t span = left + 1;
+    ms_ProbSeries forward = { .lo = 0, .len = 1, .offset = ms_ProbPush(engine, 2 * span) };
+    size_t spare = forward.offset + span;
+    engine->series[forward.offset] = 1;
+    for (size_t i = 0; i < exact_count; i++) {
+        ms_ProbComponent *c = &engine->components[engine->order[i]];
+        const ms_ProbSeries *next = &engine->suffix[i + 1];
+        size_t width = c->var_count + 1;
+        double *rest_of = engine->series + rest;
+
+        // rest_of[k]: weight of everything but this component if it holds k
+        double total = 0;
+        for (int k = c->min_mines; k <= c->max_mines; k++) {
+            rest_of[k] = 0;
+            for (int t = 0; t < forward.len; t++) {
+                rest_of[k] += engine->series[forward.offset + t] * ms_ProbSeriesAt(engine, next, forward.lo + t + k);
+            }
+            total += c->weight[k] * rest_of[k];
+        }
+        if (total == 0) {
+            ms_ProbContradiction(engine, exact_count);
+            return;
+        }
+        // groups are numbered in the order of their first cell, so group g
+        // never comes after cell g and the cells can be filled in backwards
+        for (int g = 0; g < c->group_count; g++) {
+            double mines = 0;
+            for (int k = c->min_mines; k <= c->max_mines; k++) {
+                mines += c->group_mines[g * width + k] * rest_of[k];
+            }
+            c->var_prob[g] = mines / total / c->group_size[g];
+        }
+        for (int v = c->var_count - 1; v >= 0; v--) {
+            c->var_prob[v] = c->var_prob[c->group_of[v]];
+        }
+
+        ms_ProbSeries out = { .lo = forward.lo + c->min_mines, .offset = spare };
+        out.len = forward.len + c->max_mines - c->min_mines;
+        if (out.lo + out.len > (int)span) {
+            out.len = span - out.lo;
+        }
+        memset(engine->series + spare, 0, span * sizeof(double));
+        for (int t = 0; t < forward.len; t++) {
+            for (int k = c->min_mines; k <= c->max_mines && t + k - c->min_mines < out.len; k++) {
+                engine->series[spare + t + k - c->min_mines] += engine->series[forward.offset + t] * c->weight[k];
+            }
+        }
+        ms_ProbNormalize(engine, &out);
+        // move the trimmed series back to the start of its buffer
+        memmove(engine->series + spare, engine->series + out.offset, out.len * sizeof(double));
+        out.offset = spare;
+        spare = forward.offset;
+        forward = out;
+    }
+
+    const ms_ProbSeries *last = &engine->suffix[exact_count];
+    double weight = 0, mines = 0;
+    for (int t = 0; t < forward.len; t++) {
+        double w = engine->series[forward.offset + t] * ms_ProbSeriesAt(engine, last, forward.lo + t);
+        weight += w;
+        mines += w * (left - forward.lo - t);
+    }
+    engine->interior = weight > 0 && interior > 0 ? mines / weight / interior : NAN;
+}
+
+/*Brings the probabilities up to date with the moves fed to ms_ProbUpdate,
+ * searching only the components that changed.*/
+void ms_ProbCompute(ms_ProbEngine *engine, const ms_Game *game) {
+    if (!engine->dirty) {
+        return;
+    }
+    for (size_t i = 0; i < engine->component_cap; i++) {
+        ms_ProbComponent *c = &engine->components[i];
+        // an unflag can raise the mines left past what the search allowed
+        if (c->alive && (engine->rebuild || c->limit < game->mines_left)) {
+            ms_ProbKill(engine, i);
+        }
+    }
+    engine->rebuild = false;
+
+    uint32_t cell;
+    while (ms_FrontierPop(&engine->frontier, &cell)) {
+        engine->seeds = ms_Grow(engine->seeds, &engine->seed_cap, engine->seed_count + 1, sizeof(uint32_t));
+        engine->seeds[engine->seed_count++] = cell;
+    }
+    for (size_t i = 0; i < engine->seed_count; i++) {
+        uint32_t seed = engine->seeds[i];
+        if (ms_FrontierHas(&engine->frontier, seed % game->cols, seed / game->cols) &&
+            !engine->component[seed])
+        {
+            ms_ProbBuild(engine, game, seed);
+        }
+    }
+    engine->seed_count = 0;
+    ms_ProbCombine(engine, game);
+    engine->dirty = false;
+}
+
+/*Probability that the cell at (x, y) is a mine as of the last ms_ProbCompute:
+ * 0 for revealed cells, 1 for flagged ones and NAN where the board
+ * contradicts itself.*/
+float ms_ProbAt(const ms_ProbEngine *engine, const ms_Game *game, int x, int y) {
+    if (ms_IsRevealed(game, x, y)) {
+        return 0;
+    }
+    if (ms_IsFlagged(game, x, y)) {
+        return 1;
+    }
+    uint32_t cell = ms_ProbCell(game, x, y);
+    uint32_t id = engine->component[cell];
+    if (id && engine->components[id - 1].exact) {
+        return engine->components[id - 1].var_prob[engine->index[cell]];
+    }
+    return engine->interior;
+}
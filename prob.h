@@ -0,0 +1,112 @@
+#ifndef PROB_H
+#define PROB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+#include "frontier.h"
+
+/* Exact mine probabilities.
+ *
+ * The hidden cells next to a revealed number split into independent
+ * components (cells linked through shared numbers). Within a component, cells
+ * next to exactly the same numbers form a group; the search only decides how
+ * many mines each group holds and weighs that by C(group size, mines). That
+ * yields, per component and per total mine count k, the number of layouts
+ * and the expected mines of every group.
+ *
+ * The components are then combined with the hidden cells off the frontier,
+ * which share the remaining mines C(interior, mines left - frontier mines)
+ * ways. Every weight series is rescaled to a maximum of 1 as it is built, so
+ * the result is exact up to float rounding, whatever the board size.
+ *
+ * Only the components around the cells a move changed are searched again;
+ * combining the per-component series is cheap next to the searches.
+ * A component whose search exceeds MS_PROB_NODE_BUDGET is left out and its
+ * cells are treated like interior cells.
+ *
+ * The engine stores a component id and an index per cell, 8 bytes per cell. */
+
+#define MS_PROB_NODE_BUDGET 200000
+
+typedef struct {
+    bool alive;
+    bool exact;
+    int var_count;
+    int constraint_count;
+    int group_count;
+    int min_mines;
+    int max_mines;
+    // the search skipped layouts with more mines than this, INT_MAX if none
+    int limit;
+    // var cells followed by constraint cells
+    uint32_t *cells;
+    int *group_of;
+    int *group_size;
+    // weight[k]: layouts with k mines; group_mines[g * (var_count + 1) + k]:
+    // expected mines in group g over those layouts, both scaled
+    double *weight;
+    double *group_mines;
+    float *var_prob;
+} ms_ProbComponent;
+
+/* A weight series over mine counts [lo, lo + len). */
+typedef struct {
+    int lo;
+    int len;
+    size_t offset;
+} ms_ProbSeries;
+
+typedef struct {
+    ms_Frontier frontier;
+    // per cell: slot + 1 of the component the cell is in (0 if none) and
+    // its index within the component's cells
+    uint32_t *component;
+    uint32_t *index;
+    ms_ProbComponent *components;
+    size_t component_cap;
+    uint32_t *seeds;
+    size_t seed_count;
+    size_t seed_cap;
+    // scratch: the cells, numbers and groups of the component being built,
+    // the series being combined and the exact components in order
+    uint32_t *vars;
+    int var_count;
+    size_t vars_cap;
+    uint32_t *constraints;
+    int constraint_count;
+    size_t constraints_cap;
+    struct ms_ProbGroup *groups;
+    int group_count;
+    size_t groups_cap;
+    struct ms_ProbConstraint *numbers;
+    size_t numbers_cap;
+    double *weight;
+    double *group_mines;
+    size_t nodes;
+    bool cut;
+    double *series;
+    size_t series_count;
+    size_t series_cap;
+    ms_ProbSeries *suffix;
+    size_t suffix_cap;
+    uint32_t *order;
+    size_t order_cap;
+    // mine probability of a hidden cell off the frontier
+    float interior;
+    size_t interior_count;
+    bool dirty;
+    bool rebuild;
+    size_t searched;
+    ms_Arena arena;
+} ms_ProbEngine;
+
+bool ms_ProbInit(ms_ProbEngine *engine, const ms_Game *game);
+void ms_ProbFree(ms_ProbEngine *engine);
+void ms_ProbUpdate(ms_ProbEngine *engine, const ms_Game *game, const uint32_t *cells, size_t count);
+void ms_ProbCompute(ms_ProbEngine *engine, const ms_Game *game);
+float ms_ProbAt(const ms_ProbEngine *engine, const ms_Game *game, int x, int y);
+
+#endif // PROB_H
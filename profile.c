@@ -0,0 +1,162 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "profile.h"
+
+const char *ms_PhaseNames[ms_PHASE_COUNT] = {
+    [ms_PHASE_INPUT]      = "input",
+    [ms_PHASE_UPDATE]     = "update",
+    [ms_PHASE_DRAW_BOARD] = "draw_board",
+    [ms_PHASE_DRAW_UI]    = "draw_ui",
+    [ms_PHASE_PRESENT]    = "present",
+    [ms_PHASE_OTHER]      = "other",
+};
+
+static uint64_t ms_ProfileNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/*Charges the time since the last mark to the innermost open phase.*/
+static void ms_ProfileCharge(ms_Profiler *profiler, uint64_t now) {
+    ms_ProfilePhase phase = profiler->depth ? profiler->stack[profiler->depth - 1] : ms_PHASE_OTHER;
+    uint64_t ns = profiler->current.ns[phase] + (now - profiler->mark);
+    profiler->current.ns[phase] = ns > UINT32_MAX ? UINT32_MAX : ns;
+    profiler->mark = now;
+}
+
+bool ms_ProfilerInit(ms_Profiler *profiler) {
+    *profiler = (ms_Profiler) {0};
+    profiler->frames = calloc(MS_PROFILE_FRAMES, sizeof(ms_FrameSample));
+    if (!profiler->frames) {
+        return false;
+    }
+    atomic_init(&profiler->head, 0);
+    profiler->mark = ms_ProfileNow();
+    return true;
+}
+
+void ms_ProfilerFree(ms_Profiler *profiler) {
+    free(profiler->frames);
+    *profiler = (ms_Profiler) {0};
+}
+
+void ms_ProfileBegin(ms_Profiler *profiler, ms_ProfilePhase phase) {
+    assert(profiler->depth < MS_PROFILE_DEPTH && "phases nested too deep");
+    ms_ProfileCharge(profiler, ms_ProfileNow());
+    profiler->stack[profiler->depth++] = phase;
+}
+
+void ms_ProfileEnd(ms_Profiler *profiler) {
+    assert(profiler->depth > 0 && "ms_ProfileEnd without ms_ProfileBegin");
+    ms_ProfileCharge(profiler, ms_ProfileNow());
+    profiler->depth--;
+}
+
+/*Closes the current frame, publishes it and starts the next one. Phases still
+ * open carry over into the next frame.*/
+void ms_ProfileFrame(ms_Profiler *profiler) {
+    ms_ProfileCharge(profiler, ms_ProfileNow());
+    uint64_t head = atomic_load_explicit(&profiler->head, memory_order_relaxed);
+    profiler->current.index = head;
+    profiler->frames[head & (MS_PROFILE_FRAMES - 1)] = profiler->current;
+    atomic_store_explicit(&profiler->head, head + 1, memory_order_release);
+    memset(profiler->current.ns, 0, sizeof(profiler->current.ns));
+}
+
+/*Copies up to `max` of the most recent frames to `out`, oldest first, and
+ * returns how many were copied.*/
+size_t ms_ProfileSnapshot(ms_Profiler *profiler, ms_FrameSample *out, size_t max) {
+    uint64_t head = atomic_load_explicit(&profiler->head, memory_order_acquire);
+    size_t count = head < MS_PROFILE_FRAMES ? head : MS_PROFILE_FRAMES;
+    if (count > max) {
+        count = max;
+    }
+    uint64_t first = head - count;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = profiler->frames[(first + i) & (MS_PROFILE_FRAMES - 1)];
+    }
+    // the writer may have moved on meanwhile, reusing the slots of the
+    // oldest frames for frames up to and including the one it is writing
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t now = atomic_load_explicit(&profiler->head, memory_order_relaxed);
+    uint64_t valid = now + 1 > MS_PROFILE_FRAMES ? now + 1 - MS_PROFILE_FRAMES : 0;
+    if (first >= valid) {
+        return count;
+    }
+    size_t dropped = valid - first >= count ? count : valid - first;
+    memmove(out, out + dropped, (count - dropped) * sizeof(*out));
+    return count - dropped;
+}
+
+uint32_t ms_ProfileFrameTime(const ms_FrameSample *frame) {
+    uint64_t total = 0;
+    for (int p = 0; p < ms_PHASE_COUNT; p++) {
+        total += frame->ns[p];
+    }
+    return total > UINT32_MAX ? UINT32_MAX : total;
+}
+
+static int ms_CompareU32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*Min, average, 99th percentile and max of every phase over `frames`, and of
+ * the whole frame in stats[ms_PHASE_COUNT]. `scratch` holds `count` values.*/
+void ms_ProfileSummarize(const ms_FrameSample *frames, size_t count, ms_ProfileStats stats[ms_PHASE_COUNT + 1],
+                         uint32_t *scratch)
+{
+    memset(stats, 0, (ms_PHASE_COUNT + 1) * sizeof(*stats));
+    if (count == 0) {
+        return;
+    }
+    for (int p = 0; p <= ms_PHASE_COUNT; p++) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            scratch[i] = p < ms_PHASE_COUNT ? frames[i].ns[p] : ms_ProfileFrameTime(&frames[i]);
+            sum += scratch[i];
+        }
+        qsort(scratch, count, sizeof(*scratch), ms_CompareU32);
+        stats[p] = (ms_ProfileStats) {
+            .min = scratch[0],
+            .avg = sum / count,
+            .p99 = scratch[(count - 1) * 99 / 100],
+            .max = scratch[count - 1],
+        };
+    }
+}
+
+/*Writes every frame still in the ring as one CSV row of nanoseconds per
+ * phase.*/
+bool ms_ProfileWriteCsv(ms_Profiler *profiler, const char *path) {
+    ms_FrameSample *frames = malloc(MS_PROFILE_FRAMES * sizeof(*frames));
+    FILE *file = fopen(path, "w");
+    if (!frames || !file) {
+        free(frames);
+        if (file) {
+            fclose(file);
+        }
+        return false;
+    }
+    size_t count = ms_ProfileSnapshot(profiler, frames, MS_PROFILE_FRAMES);
+    fprintf(file, "frame");
+    for (int p = 0; p < ms_PHASE_COUNT; p++) {
+        fprintf(file, ",%s_ns", ms_PhaseNames[p]);
+    }
+    fprintf(file, ",frame_ns\n");
+    for (size_t i = 0; i < count; i++) {
+        fprintf(file, "%llu", (unsigned long long)frames[i].index);
+        for (int p = 0; p < ms_PHASE_COUNT; p++) {
+            fprintf(file, ",%u", frames[i].ns[p]);
+        }
+        fprintf(file, ",%u\n", ms_ProfileFrameTime(&frames[i]));
+    }
+    free(frames);
+    return fclose(file) == 0;
+}
@@ -0,0 +1,73 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Frame profiler.
+ * The frame is split into phases, each timed between ms_ProfileBegin and
+ * ms_ProfileEnd. Phases nest: a phase begun inside another one pauses it, so
+ * every nanosecond of a frame is charged to exactly one phase (time outside
+ * any phase goes to ms_PHASE_OTHER). ms_ProfileFrame closes the frame and
+ * publishes its phase times to a ring of the most recent frames.
+ *
+ * The ring has a single writer, the thread running the frame loop, and never
+ * blocks it: the oldest frame is overwritten when the ring is full. Readers on
+ * any thread copy frames out with ms_ProfileSnapshot, which drops the frames
+ * the writer overwrote while they were being copied instead of taking a
+ * lock. */
+
+#define MS_PROFILE_FRAMES 65536   // power of two, about 18 minutes at 60 fps
+#define MS_PROFILE_DEPTH  8
+
+typedef enum {
+    ms_PHASE_INPUT = 0,
+    ms_PHASE_UPDATE,
+    ms_PHASE_DRAW_BOARD,
+    ms_PHASE_DRAW_UI,
+    ms_PHASE_PRESENT,
+    ms_PHASE_OTHER,
+    ms_PHASE_COUNT,
+} ms_ProfilePhase;
+
+/* Nanoseconds spent in each phase during one frame. */
+typedef struct {
+    uint64_t index;
+    uint32_t ns[ms_PHASE_COUNT];
+} ms_FrameSample;
+
+typedef struct {
+    uint32_t min;
+    uint32_t avg;
+    uint32_t p99;
+    uint32_t max;
+} ms_ProfileStats;
+
+typedef struct {
+    ms_FrameSample *frames;
+    _Alignas(64) _Atomic uint64_t head;   // frames published so far
+    // writer side: the frame being timed and the stack of open phases
+    ms_FrameSample current;
+    ms_ProfilePhase stack[MS_PROFILE_DEPTH];
+    int depth;
+    uint64_t mark;
+} ms_Profiler;
+
+extern const char *ms_PhaseNames[ms_PHASE_COUNT];
+
+bool ms_ProfilerInit(ms_Profiler *profiler);
+void ms_ProfilerFree(ms_Profiler *profiler);
+
+void ms_ProfileBegin(ms_Profiler *profiler, ms_ProfilePhase phase);
+void ms_ProfileEnd(ms_Profiler *profiler);
+void ms_ProfileFrame(ms_Profiler *profiler);
+
+size_t ms_ProfileSnapshot(ms_Profiler *profiler, ms_FrameSample *out, size_t max);
+void ms_ProfileSummarize(const ms_FrameSample *frames, size_t count, ms_ProfileStats stats[ms_PHASE_COUNT + 1],
+                         uint32_t *scratch);
+uint32_t ms_ProfileFrameTime(const ms_FrameSample *frame);
+bool ms_ProfileWriteCsv(ms_Profiler *profiler, const char *path);
+
+#endif // PROFILE_H
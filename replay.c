@@ -0,0 +1,239 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "replay.h"
+#include "noguess.h"
+#include "snapshot.h"
+
+
+// longest varint of a 64-bit value
+#define MS_VARINT_MAX 10
+
+/*Writes `value` as a LEB128 varint and returns its length.*/
+size_t ms_PutVarint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+/*Reads a varint at `*pos` and advances it. Returns false if the data ends
+ * inside the varint or it is longer than MS_VARINT_MAX bytes.*/
+bool ms_GetVarint(const uint8_t *data, size_t size, size_t *pos, uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 7 * MS_VARINT_MAX && *pos < size; shift += 7) {
+        uint8_t byte = data[(*pos)++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t ms_ZigZag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t ms_UnZigZag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/*Creates the replay file at `path` and writes the header for `game`, which
+ * must not have had its first click yet. Returns false if the file can not be
+ * written.*/
+bool ms_RecorderStart(ms_Recorder *recorder, const char *path, const ms_Game *game) {
+    *recorder = (ms_Recorder) {0};
+    recorder->file = fopen(path, "wb");
+    if (!recorder->file) {
+        return false;
+    }
+    uint8_t header[4 + 5 * MS_VARINT_MAX];
+    size_t n = 4;
+    memcpy(header, MS_REPLAY_MAGIC, 4);
+    n += ms_PutVarint(header + n, MS_REPLAY_VERSION);
+    n += ms_PutVarint(header + n, game->rows);
+    n += ms_PutVarint(header + n, game->cols);
+    n += ms_PutVarint(header + n, game->mine_count);
+    n += ms_PutVarint(header + n, game->seed);
+    recorder->bytes = n;
+    return fwrite(header, 1, n, recorder->file) == n && fflush(recorder->file) == 0;
+}
+
+/*Appends one move. Times must not go backwards.*/
+bool ms_RecordMove(ms_Recorder *recorder, ms_ReplayMove move) {
+    if (!recorder->file) {
+        return false;
+    }
+    uint8_t record[3 * MS_VARINT_MAX];
+    uint32_t elapsed = move.time > recorder->last_time ? move.time - recorder->last_time : 0;
+    size_t n = ms_PutVarint(record, (uint64_t)elapsed << 2 | move.kind);
+    n += ms_PutVarint(record + n, ms_ZigZag((int64_t)move.cell - recorder->last_cell));
+    if (move.kind == ms_MOVE_NOGUESS) {
+        n += ms_PutVarint(record + n, move.seed);
+    }
+    recorder->last_time += elapsed;
+    recorder->last_cell = move.cell;
+    recorder->bytes += n;
+    return fwrite(record, 1, n, recorder->file) == n && fflush(recorder->file) == 0;
+}
+
+void ms_RecorderStop(ms_Recorder *recorder) {
+    if (recorder->file) {
+        fclose(recorder->file);
+    }
+    *recorder = (ms_Recorder) {0};
+}
+
+/*Reads the header of a replay held in memory; `data` has to stay valid while
+ * the replay is read. Returns false if it is not a replay this build reads.*/
+bool ms_ReplayAttach(ms_Replay *replay, const void *data, size_t size) {
+    *replay = (ms_Replay) { .data = data, .size = size };
+    if (size < 4 || memcmp(data, MS_REPLAY_MAGIC, 4) != 0) {
+        return false;
+    }
+    uint64_t version, rows, cols, mines, seed;
+    replay->pos = 4;
+    if (!ms_GetVarint(replay->data, size, &replay->pos, &version) || version != MS_REPLAY_VERSION ||
+        !ms_GetVarint(replay->data, size, &replay->pos, &rows) || rows > MS_MAX_SIDE ||
+        !ms_GetVarint(replay->data, size, &replay->pos, &cols) || cols > MS_MAX_SIDE ||
+        !ms_GetVarint(replay->data, size, &replay->pos, &mines) || mines > rows * cols ||
+        !ms_GetVarint(replay->data, size, &replay->pos, &seed))
+    {
+        return false;
+    }
+    replay->rows = rows;
+    replay->cols = cols;
+    replay->mines = mines;
+    replay->seed = seed;
+    replay->moves_begin = replay->pos;
+    return true;
+}
+
+/*Maps the replay file at `path` and reads its header.*/
+bool ms_ReplayOpen(ms_Replay *replay, const char *path) {
+    *replay = (ms_Replay) {0};
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // the mapping keeps the file alive
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    bool valid = ms_ReplayAttach(replay, data, st.st_size);
+    replay->mapped = true;
+    if (!valid) {
+        ms_ReplayClose(replay);
+    }
+    return valid;
+}
+
+void ms_ReplayClose(ms_Replay *replay) {
+    if (replay->mapped) {
+        munmap((void *)replay->data, replay->size);
+    }
+    *replay = (ms_Replay) {0};
+}
+
+void ms_ReplayRewind(ms_Replay *replay) {
+    replay->pos = replay->moves_begin;
+    replay->last_cell = 0;
+    replay->last_time = 0;
+}
+
+/*Decodes the next move. Returns false at the end of the replay, at a move cut
+ * short or at a move outside the board.*/
+bool ms_ReplayNext(ms_Replay *replay, ms_ReplayMove *move) {
+    size_t pos = replay->pos;
+    uint64_t tag, delta, seed = 0;
+    if (!ms_GetVarint(replay->data, replay->size, &pos, &tag) ||
+        !ms_GetVarint(replay->data, replay->size, &pos, &delta) ||
+        (tag & 3) > ms_MOVE_UNDO ||
+        ((tag & 3) == ms_MOVE_NOGUESS && !ms_GetVarint(replay->data, replay->size, &pos, &seed)))
+    {
+        return false;
+    }
+    int64_t cell = (int64_t)replay->last_cell + ms_UnZigZag(delta);
+    if (cell < 0 || cell >= (int64_t)replay->rows * replay->cols) {
+        return false;
+    }
+    replay->pos = pos;
+    replay->last_cell = cell;
+    replay->last_time += tag >> 2;
+    *move = (ms_ReplayMove) {
+        .kind = tag & 3,
+        .cell = cell,
+        .time = replay->last_time,
+        .seed = seed,
+    };
+    return true;
+}
+
+/*Plays the whole replay on `game` from the start, leaving the final state of
+ * the recorded game. `moves` (may be NULL) receives the number of moves
+ * played. Returns false if the header describes no valid board.
+ *
+ * Undo steps are snapshots taken the way the game takes them: before every
+ * move, except a click right after its no-guess placement, and dropped again
+ * when the move changed nothing.*/
+bool ms_ReplayPlay(ms_Replay *replay, ms_Game *game, size_t *moves) {
+    if (!ms_InitGame(game, replay->rows, replay->cols, replay->mines, replay->seed)) {
+        return false;
+    }
+    ms_ReplayRewind(replay);
+    ms_Snapshot *undo = NULL;
+    size_t undo_count = 0, undo_cap = 0;
+    size_t played = 0;
+    ms_ReplayMove move;
+    ms_MoveKind last = ms_MOVE_UNDO;
+    // a lost game goes on only if the next move takes the loss back
+    while (ms_ReplayNext(replay, &move) && (game->state == ms_PLAYING || move.kind == ms_MOVE_UNDO)) {
+        ms_Pos pos = ms_PosXY(move.cell % game->cols, move.cell / game->cols);
+        if (move.kind != ms_MOVE_UNDO && !(move.kind == ms_MOVE_REVEAL && last == ms_MOVE_NOGUESS)) {
+            undo = ms_Grow(undo, &undo_cap, undo_count + 1, sizeof(*undo));
+            undo[undo_count++] = ms_TakeSnapshot(game);
+        }
+        switch (move.kind) {
+            case ms_MOVE_REVEAL: ms_ClickCell(game, &pos); break;
+            case ms_MOVE_FLAG: ms_MarkCell(game, &pos); break;
+            case ms_MOVE_NOGUESS:
+                if (!game->first_click_done) {
+                    ms_PlaceNoGuess(game, &pos, move.seed);
+                }
+                break;
+            case ms_MOVE_UNDO:
+                if (undo_count > 0) {
+                    ms_RestoreSnapshot(game, &undo[--undo_count]);
+                }
+                break;
+        }
+        if (move.kind != ms_MOVE_UNDO && move.kind != ms_MOVE_NOGUESS &&
+            !ms_SnapshotChanged(game, &undo[undo_count - 1]))
+        {
+            undo_count--;
+        }
+        last = move.kind;
+        played++;
+    }
+    free(undo);
+    if (moves) {
+        *moves = played;
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "minesweeper.h"
+
+/* Replay log of one game.
+ *
+ * A replay is the magic "MSRP" followed by varints: format version, rows,
+ * columns, mines and the seed the board was initialised with. The moves come
+ * after that, appended as they are played, each one
+ *
+ *     varint  (milliseconds since the previous move << 2) | kind
+ *     varint  zigzag(cell - cell of the previous move)
+ *     varint  seed                        (ms_MOVE_NOGUESS only)
+ *
+ * so a typical move takes 2-3 bytes. ms_MOVE_NOGUESS records that the board
+ * was placed by ms_PlaceNoGuess for a first click at `cell`; it comes right
+ * before that click. ms_MOVE_UNDO takes back the last move that changed the
+ * board, a no-guess placement together with its click; its cell is that of
+ * the move before.
+ *
+ * Replays are read through a memory mapping and played back with the same
+ * ms_ClickCell/ms_MarkCell calls the game makes, so a replay rebuilds the
+ * exact final state. A replay cut short (the game crashed while writing) plays
+ * up to its last complete move. */
+
+#define MS_REPLAY_MAGIC   "MSRP"
+#define MS_REPLAY_VERSION 1
+
+typedef enum {
+    ms_MOVE_REVEAL = 0,
+    ms_MOVE_FLAG,
+    ms_MOVE_NOGUESS,
+    ms_MOVE_UNDO,
+} ms_MoveKind;
+
+typedef struct {
+    ms_MoveKind kind;
+    uint32_t cell;
+    // milliseconds since the start of the game
+    uint32_t time;
+    uint64_t seed;
+} ms_ReplayMove;
+
+/* Appends moves to a replay file; the file is flushed after every move. */
+typedef struct {
+    FILE *file;
+    uint32_t last_cell;
+    uint32_t last_time;
+    size_t bytes;
+} ms_Recorder;
+
+/* A replay being read: `data` is the mapped file, `pos` the next move. */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    size_t moves_begin;
+    bool mapped;
+    int rows;
+    int cols;
+    int mines;
+    uint64_t seed;
+    uint32_t last_cell;
+    uint32_t last_time;
+} ms_Replay;
+
+bool ms_RecorderStart(ms_Recorder *recorder, const char *path, const ms_Game *game);
+bool ms_RecordMove(ms_Recorder *recorder, ms_ReplayMove move);
+void ms_RecorderStop(ms_Recorder *recorder);
+
+bool ms_ReplayOpen(ms_Replay *replay, const char *path);
+bool ms_ReplayAttach(ms_Replay *replay, const void *data, size_t size);
+void ms_ReplayClose(ms_Replay *replay);
+void ms_ReplayRewind(ms_Replay *replay);
+bool ms_ReplayNext(ms_Replay *replay, ms_ReplayMove *move);
+bool ms_ReplayPlay(ms_Replay *replay, ms_Game *game, size_t *moves);
+
+size_t ms_PutVarint(uint8_t *out, uint64_t value);
+bool ms_GetVarint(const uint8_t *data, size_t size, size_t *pos, uint64_t *value);
+
+#endif // REPLAY_H
@@ -0,0 +1,49 @@
+#include <time.h>
+
+#include "rng.h"
+
+
+uint64_t ms_SplitMix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void ms_RngSeed(ms_Rng *rng, uint64_t seed) {
+    uint64_t state = seed;
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = ms_SplitMix64(&state);
+    }
+}
+
+/*Advances the generator by 2^128 steps, as if ms_RngNext was called that
+ * often. Generators jumped a different number of times from one seed draw
+ * sequences that never overlap.*/
+void ms_RngJump(ms_Rng *rng) {
+    static const uint64_t jump[] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL,
+    };
+    uint64_t s[4] = {0};
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (jump[i] & (1ULL << b)) {
+                for (int j = 0; j < 4; j++) {
+                    s[j] ^= rng->s[j];
+                }
+            }
+            ms_RngNext(rng);
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        rng->s[j] = s[j];
+    }
+}
+
+/*Seed for interactive games: changes every nanosecond.*/
+uint64_t ms_RngSeedFromTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t state = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    return ms_SplitMix64(&state);
+}
@@ -0,0 +1,49 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/* xoshiro256** seeded through splitmix64.
+ * Small, fast and owned by whoever uses it: every board carries its own
+ * generator, so boards can be generated on any thread and rebuilt exactly
+ * from their seed. */
+
+typedef struct {
+    uint64_t s[4];
+} ms_Rng;
+
+void ms_RngSeed(ms_Rng *rng, uint64_t seed);
+void ms_RngJump(ms_Rng *rng);
+uint64_t ms_RngSeedFromTime();
+
+uint64_t ms_SplitMix64(uint64_t *state);
+
+static inline uint64_t ms_RngRotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t ms_RngNext(ms_Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = ms_RngRotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = ms_RngRotl(s[3], 45);
+    return result;
+}
+
+/*Uniform integer in [0, bound), without modulo bias.*/
+static inline uint64_t ms_RngBelow(ms_Rng *rng, uint64_t bound) {
+    uint64_t threshold = -bound % bound;
+    for (;;) {
+        uint64_t r = ms_RngNext(rng);
+        if (r >= threshold) {
+            return r % bound;
+        }
+    }
+}
+
+#endif // RNG_H
@@ -0,0 +1,100 @@
+#include <string.h>
+
+#include "snapshot.h"
+
+
+/*First word of journal tile `tile`: the revealed plane's tiles come first,
+ * then the flagged plane's.*/
+static uint64_t *ms_TileWords(ms_Game *game, size_t tile) {
+    uint64_t *plane = tile < game->journal.tiles ? game->revealed : game->flagged;
+    return plane + (tile % game->journal.tiles) * MS_TILE_WORDS;
+}
+
+/*Starts a new epoch, so every tile is saved again before its next write.*/
+static void ms_JournalNextEpoch(ms_Game *game) {
+    ms_Journal *journal = &game->journal;
+    if (++journal->epoch == 0) {
+        memset(journal->stamps, 0, 2 * journal->tiles * sizeof(uint32_t));
+        journal->epoch = 1;
+    }
+}
+
+/*Appends the current content of `tile` to the journal. Planes are padded to
+ * 64 bytes in the arena, so the last tile of a plane is always whole.*/
+void ms_JournalSave(ms_Game *game, size_t tile) {
+    ms_Journal *journal = &game->journal;
+    journal->saved = ms_Grow(journal->saved, &journal->saved_cap,
+                             (journal->count + 1) * MS_TILE_WORDS, sizeof(uint64_t));
+    journal->saved_tiles = ms_Grow(journal->saved_tiles, &journal->saved_tiles_cap,
+                                   journal->count + 1, sizeof(uint32_t));
+    memcpy(&journal->saved[journal->count * MS_TILE_WORDS], ms_TileWords(game, tile),
+           MS_TILE_WORDS * sizeof(uint64_t));
+    journal->saved_tiles[journal->count++] = tile;
+    journal->stamps[tile] = journal->epoch;
+}
+
+/*Captures the game state in O(1); the cells are saved lazily as moves
+ * overwrite them.*/
+ms_Snapshot ms_TakeSnapshot(ms_Game *game) {
+    ms_JournalNextEpoch(game);
+    return (ms_Snapshot) {
+        .journal_count = game->journal.count,
+        .generation = game->journal.generation,
+        .mines = game->mines,
+        .mines_left = game->mines_left,
+        .hidden_safe = game->hidden_safe,
+        .flagged_mines = game->flagged_mines,
+        .revealed_mines = game->revealed_mines,
+        .first_click_done = game->first_click_done,
+        .state = game->state,
+        .seed = game->seed,
+        .rng = game->rng,
+    };
+}
+
+/*Puts the game back into the state of `snapshot` and empties the delta.
+ * Returns false, changing nothing, if the snapshot belongs to an earlier
+ * board or was discarded by restoring an older one.*/
+bool ms_RestoreSnapshot(ms_Game *game, const ms_Snapshot *snapshot) {
+    ms_Journal *journal = &game->journal;
+    if (snapshot->generation != journal->generation || snapshot->journal_count > journal->count) {
+        return false;
+    }
+    // a tile saved twice holds its older content in the earlier entry
+    while (journal->count > snapshot->journal_count) {
+        journal->count--;
+        memcpy(ms_TileWords(game, journal->saved_tiles[journal->count]),
+               &journal->saved[journal->count * MS_TILE_WORDS], MS_TILE_WORDS * sizeof(uint64_t));
+    }
+    if (game->first_click_done && !snapshot->first_click_done) {
+        // back to a board without mines, as ms_InitGame left it
+        size_t words = (size_t)game->rows * game->stride;
+        game->mines = snapshot->mines;
+        memset(game->mines, 0, words * sizeof(uint64_t));
+        memset(game->counts, 0, 4 * words * sizeof(uint64_t));
+    }
+    game->mines_left = snapshot->mines_left;
+    game->hidden_safe = snapshot->hidden_safe;
+    game->flagged_mines = snapshot->flagged_mines;
+    game->revealed_mines = snapshot->revealed_mines;
+    game->first_click_done = snapshot->first_click_done;
+    game->state = snapshot->state;
+    game->seed = snapshot->seed;
+    game->rng = snapshot->rng;
+    ms_ResetDelta(game);
+    // the restored tiles still carry this epoch's stamp
+    ms_JournalNextEpoch(game);
+    return true;
+}
+
+/*True if the game was played on since `snapshot`: a reveal or flag saved a
+ * tile, or the first click placed the mines.*/
+bool ms_SnapshotChanged(const ms_Game *game, const ms_Snapshot *snapshot) {
+    return game->journal.count > snapshot->journal_count
+        || game->first_click_done != snapshot->first_click_done;
+}
+
+/*Heap bytes held by the journal's saved tiles.*/
+size_t ms_JournalBytes(const ms_Game *game) {
+    return game->journal.count * (MS_TILE_WORDS * sizeof(uint64_t) + sizeof(uint32_t));
+}
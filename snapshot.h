@@ -0,0 +1,51 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+
+/* Board snapshots for undo.
+ *
+ * ms_TakeSnapshot copies no cells: it records the scalar game state and how
+ * long the board's journal is, and starts a new journal epoch. From then on
+ * every reveal and flag saves the tile of the plane it writes, once per tile
+ * and snapshot, so a move costs a copy of the few 64-byte tiles it touched on
+ * top of the move itself. ms_RestoreSnapshot copies the tiles saved since the
+ * snapshot back, newest first, and drops them from the journal.
+ *
+ * Snapshots are restored last in, first out: restoring one discards every
+ * snapshot taken after it, restoring those afterwards is undefined. Taking
+ * them and playing on is free to interleave. A snapshot taken before the first
+ * click also takes back the mines that click placed. ms_InitGame invalidates
+ * every snapshot of the board; ms_RestoreSnapshot refuses those. */
+
+typedef enum {
+    ms_JOURNAL_REVEALED = 0,
+    ms_JOURNAL_FLAGGED,
+} ms_JournalPlane;
+
+typedef struct {
+    size_t journal_count;
+    uint32_t generation;
+    uint64_t *mines;
+    int mines_left;
+    size_t hidden_safe;
+    int flagged_mines;
+    int revealed_mines;
+    bool first_click_done;
+    ms_GameState state;
+    uint64_t seed;
+    ms_Rng rng;
+} ms_Snapshot;
+
+ms_Snapshot ms_TakeSnapshot(ms_Game *game);
+bool ms_RestoreSnapshot(ms_Game *game, const ms_Snapshot *snapshot);
+bool ms_SnapshotChanged(const ms_Game *game, const ms_Snapshot *snapshot);
+size_t ms_JournalBytes(const ms_Game *game);
+
+void ms_JournalSave(ms_Game *game, size_t tile);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,465 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "solver.h"
+
+
+/* Remaining mines and undecided hidden cells around one number. */
+typedef struct {
+    int remaining;
+    int count;
+    uint32_t cells[8];
+} ms_Neighbours;
+
+static bool ms_SolverTest(const uint64_t *plane, const ms_Game *game, int x, int y) {
+    return plane[ms_WordIndex(game, x, y)] & ms_BitMask(x);
+}
+
+static void ms_SolverSet(uint64_t *plane, const ms_Game *game, int x, int y) {
+    plane[ms_WordIndex(game, x, y)] |= ms_BitMask(x);
+}
+
+static void ms_SolverClear(uint64_t *plane, const ms_Game *game, int x, int y) {
+    plane[ms_WordIndex(game, x, y)] &= ~ms_BitMask(x);
+}
+
+/*Sets the solver up for the current state of `game`, which may already be in
+ * progress. Memory is reused when the new board is not bigger than the last
+ * one. Returns false if memory runs out.*/
+bool ms_SolverInit(ms_Solver *solver, const ms_Game *game) {
+    if (!ms_FrontierInit(&solver->frontier, game)) {
+        return false;
+    }
+    // the known planes are bordered like the game's so they can be read as windows
+    size_t plane = ms_ArenaAlignUp((size_t)game->rows * game->stride * sizeof(uint64_t));
+    if (!ms_ArenaReserve(&solver->arena, 2 * ms_PlaneBytes(game->rows, game->stride) + 2 * plane)) {
+        return false;
+    }
+    solver->known_safe = ms_PlaneAlloc(&solver->arena, game->rows, game->stride);
+    solver->known_mine = ms_PlaneAlloc(&solver->arena, game->rows, game->stride);
+    solver->fresh_mark = ms_ArenaAlloc(&solver->arena, plane);
+    solver->seen = ms_ArenaAlloc(&solver->arena, plane);
+    memset(solver->arena.base, 0, solver->arena.used);
+    solver->safe_count = 0;
+    solver->mine_count = 0;
+    solver->fresh_count = 0;
+    solver->seen_count = 0;
+    solver->stats = (ms_SolverStats) {0};
+    return true;
+}
+
+void ms_SolverFree(ms_Solver *solver) {
+    ms_FrontierFree(&solver->frontier);
+    ms_ArenaFree(&solver->arena);
+    free(solver->safe);
+    free(solver->mines);
+    free(solver->fresh);
+    free(solver->seen_cells);
+    free(solver->vars);
+    free(solver->constraints);
+    free(solver->lookup);
+    *solver = (ms_Solver) {0};
+}
+
+/*Feeds the cells a move revealed or (un)flagged to the solver.*/
+void ms_SolverUpdate(ms_Solver *solver, const ms_Game *game, const uint32_t *cells, size_t count) {
+    ms_FrontierTouchCells(&solver->frontier, game, cells, count);
+}
+
+/*Collects what the solver still has to decide around the number at `cell`.
+ * Flags and decided mines count as mines, decided safe cells as revealed.*/
+static void ms_SolverGather(const ms_Solver *solver, const ms_Game *game, uint32_t cell, ms_Neighbours *out) {
+    int x = cell % game->cols;
+    int y = cell / game->cols;
+    unsigned around = ms_WindowInside(game, x, y) & ~MS_WINDOW_CENTRE;
+    unsigned mines = (ms_Window(game->flagged, game->stride, x, y)
+                      | ms_Window(solver->known_mine, game->stride, x, y)) & around;
+    unsigned open = ms_Window(game->revealed, game->stride, x, y)
+                  | ms_Window(solver->known_safe, game->stride, x, y);
+    out->remaining = ms_CountAt(game, x, y) - __builtin_popcount(mines);
+    out->count = 0;
+    for (unsigned bits = around & ~mines & ~open; bits; bits &= bits - 1) {
+        out->cells[out->count++] = cell + game->neighbour_offsets[__builtin_ctz(bits)];
+    }
+}
+
+/*Records a decided cell and queues the numbers around it, which now see one
+ * undecided cell less.*/
+static void ms_SolverConclude(ms_Solver *solver, const ms_Game *game, uint32_t cell, bool mine) {
+    int x = cell % game->cols;
+    int y = cell / game->cols;
+    if (ms_SolverTest(solver->known_safe, game, x, y) || ms_SolverTest(solver->known_mine, game, x, y)) {
+        return;
+    }
+    if (mine) {
+        ms_SolverSet(solver->known_mine, game, x, y);
+        solver->mines = ms_Grow(solver->mines, &solver->mine_cap, solver->mine_count + 1, sizeof(uint32_t));
+        solver->mines[solver->mine_count++] = cell;
+    } else {
+        ms_SolverSet(solver->known_safe, game, x, y);
+        solver->safe = ms_Grow(solver->safe, &solver->safe_cap, solver->safe_count + 1, sizeof(uint32_t));
+        solver->safe[solver->safe_count++] = cell;
+    }
+    for (unsigned bits = ms_WindowInside(game, x, y); bits; bits &= bits - 1) {
+        int k = __builtin_ctz(bits);
+        ms_FrontierQueue(&solver->frontier, x + k % 3 - 1, y + k / 3 - 1);
+    }
+}
+
+static void ms_SolverConcludeAll(ms_Solver *solver, const ms_Game *game, const uint32_t *cells, int count, bool mine) {
+    for (int i = 0; i < count; i++) {
+        ms_SolverConclude(solver, game, cells[i], mine);
+    }
+}
+
+static bool ms_SolverSingle(ms_Solver *solver, const ms_Game *game, const ms_Neighbours *n) {
+    if (n->count == 0 || (n->remaining != 0 && n->remaining != n->count)) {
+        return false;
+    }
+    ms_SolverConcludeAll(solver, game, n->cells, n->count, n->remaining != 0);
+    solver->stats.single += n->count;
+    return true;
+}
+
+/*Cells of `a` that are not in `b`.*/
+static int ms_Difference(const ms_Neighbours *a, const ms_Neighbours *b, uint32_t *out) {
+    int count = 0;
+    for (int i = 0; i < a->count; i++) {
+        bool shared = false;
+        for (int j = 0; j < b->count && !shared; j++) {
+            shared = a->cells[i] == b->cells[j];
+        }
+        if (!shared) {
+            out[count++] = a->cells[i];
+        }
+    }
+    return count;
+}
+
+/*Compares the number at `cell` with every number that shares a hidden cell
+ * with it. With A and B the undecided cells of the two numbers:
+ *  - if B has exactly |B\A| more mines than A, all of B\A are mines and all of
+ *    A\B are safe (the superset rule),
+ *  - if A is a subset of B with as many mines, all of B\A are safe.*/
+static bool ms_SolverPairs(ms_Solver *solver, const ms_Game *game, uint32_t cell, const ms_Neighbours *a) {
+    int x = cell % game->cols;
+    int y = cell / game->cols;
+    for (int ny = y - 2; ny <= y + 2; ny++) {
+        for (int nx = x - 2; nx <= x + 2; nx++) {
+            if (nx < 0 || nx >= game->cols || ny < 0 || ny >= game->rows || (nx == x && ny == y) ||
+                !ms_FrontierHas(&solver->frontier, nx, ny))
+            {
+                continue;
+            }
+            ms_Neighbours b;
+            ms_SolverGather(solver, game, (uint32_t)((size_t)ny * game->cols + nx), &b);
+            if (b.count == 0) {
+                continue;
+            }
+            uint32_t only_a[8], only_b[8];
+            int count_a = ms_Difference(a, &b, only_a);
+            int count_b = ms_Difference(&b, a, only_b);
+            if (count_a + count_b == 0) {
+                continue;
+            }
+
+            if (b.remaining - a->remaining == count_b) {
+                ms_SolverConcludeAll(solver, game, only_b, count_b, true);
+                ms_SolverConcludeAll(solver, game, only_a, count_a, false);
+            } else if (a->remaining - b.remaining == count_a) {
+                ms_SolverConcludeAll(solver, game, only_a, count_a, true);
+                ms_SolverConcludeAll(solver, game, only_b, count_b, false);
+            } else if (count_a == 0 && a->remaining == b.remaining) {
+                ms_SolverConcludeAll(solver, game, only_b, count_b, false);
+            } else if (count_b == 0 && a->remaining == b.remaining) {
+                ms_SolverConcludeAll(solver, game, only_a, count_a, false);
+            } else {
+                continue;
+            }
+            solver->stats.pair += count_a + count_b;
+            // the other pairs of this number may still decide something
+            ms_FrontierQueue(&solver->frontier, x, y);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ms_SolverMarkSeen(ms_Solver *solver, const ms_Game *game, uint32_t cell) {
+    ms_SolverSet(solver->seen, game, cell % game->cols, cell / game->cols);
+    solver->seen_cells = ms_Grow(solver->seen_cells, &solver->seen_cap, solver->seen_count + 1, sizeof(uint32_t));
+    solver->seen_cells[solver->seen_count++] = cell;
+}
+
+static bool ms_SolverSeen(const ms_Solver *solver, const ms_Game *game, uint32_t cell) {
+    return ms_SolverTest(solver->seen, game, cell % game->cols, cell / game->cols);
+}
+
+static void ms_SolverAddConstraint(ms_Solver *solver, const ms_Game *game, uint32_t cell) {
+    ms_SolverMarkSeen(solver, game, cell);
+    solver->constraints = ms_Grow(solver->constraints, &solver->constraint_cap,
+                                  solver->constraint_count + 1, sizeof(ms_SolverConstraint));
+    solver->constraints[solver->constraint_count++] = (ms_SolverConstraint) { .cell = cell };
+}
+
+static int ms_CompareLookup(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int ms_SolverFindVar(const ms_Solver *solver, uint32_t cell) {
+    size_t lo = 0;
+    size_t hi = solver->var_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        uint32_t key = solver->lookup[mid] >> 32;
+        if (key < cell) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (int)(solver->lookup[lo] & 0xFFFFFFFF);
+}
+
+/*Collects the component of `start`: the numbers and undecided cells reachable
+ * through shared cells. Vars are numbered in discovery order, which keeps
+ * neighbouring cells close together for the search.*/
+static void ms_SolverBuildComponent(ms_Solver *solver, const ms_Game *game, uint32_t start) {
+    solver->var_count = 0;
+    solver->constraint_count = 0;
+    ms_SolverAddConstraint(solver, game, start);
+
+    for (size_t k = 0; k < solver->constraint_count; k++) {
+        ms_Neighbours n;
+        ms_SolverGather(solver, game, solver->constraints[k].cell, &n);
+        solver->constraints[k].remaining = n.remaining;
+        for (int i = 0; i < n.count; i++) {
+            if (ms_SolverSeen(solver, game, n.cells[i])) {
+                continue;
+            }
+            ms_SolverMarkSeen(solver, game, n.cells[i]);
+            solver->vars = ms_Grow(solver->vars, &solver->var_cap, solver->var_count + 1, sizeof(ms_SolverVar));
+            solver->vars[solver->var_count++] = (ms_SolverVar) { .cell = n.cells[i] };
+
+            // every frontier number next to a new cell joins the component
+            int x = n.cells[i] % game->cols;
+            int y = n.cells[i] / game->cols;
+            for (int ny = y - 1; ny <= y + 1; ny++) {
+                for (int nx = x - 1; nx <= x + 1; nx++) {
+                    if (nx < 0 || nx >= game->cols || ny < 0 || ny >= game->rows ||
+                        !ms_FrontierHas(&solver->frontier, nx, ny))
+                    {
+                        continue;
+                    }
+                    uint32_t cell = (uint32_t)((size_t)ny * game->cols + nx);
+                    if (!ms_SolverSeen(solver, game, cell)) {
+                        ms_SolverAddConstraint(solver, game, cell);
+                    }
+                }
+            }
+        }
+    }
+
+    solver->lookup = ms_Grow(solver->lookup, &solver->lookup_cap, solver->var_count, sizeof(uint64_t));
+    for (size_t v = 0; v < solver->var_count; v++) {
+        solver->lookup[v] = (uint64_t)solver->vars[v].cell << 32 | v;
+    }
+    qsort(solver->lookup, solver->var_count, sizeof(uint64_t), ms_CompareLookup);
+
+    for (size_t k = 0; k < solver->constraint_count; k++) {
+        ms_SolverConstraint *c = &solver->constraints[k];
+        ms_Neighbours n;
+        ms_SolverGather(solver, game, c->cell, &n);
+        for (int i = 0; i < n.count; i++) {
+            int v = ms_SolverFindVar(solver, n.cells[i]);
+            ms_SolverVar *var = &solver->vars[v];
+            c->vars[c->var_count++] = v;
+            var->constraints[var->constraint_count++] = (int)k;
+        }
+        c->unassigned = c->var_count;
+    }
+}
+
+/*Assigns a value to `var` and reports whether its numbers can still be met.*/
+static bool ms_SolverAssign(ms_Solver *solver, ms_SolverVar *var, bool mine) {
+    bool ok = true;
+    var->mine = mine;
+    for (int i = 0; i < var->constraint_count; i++) {
+        ms_SolverConstraint *c = &solver->constraints[var->constraints[i]];
+        c->unassigned--;
+        c->mines += mine;
+        ok = ok && c->mines <= c->remaining && c->mines + c->unassigned >= c->remaining;
+    }
+    return ok;
+}
+
+static void ms_SolverUnassign(ms_Solver *solver, ms_SolverVar *var) {
+    for (int i = 0; i < var->constraint_count; i++) {
+        ms_SolverConstraint *c = &solver->constraints[var->constraints[i]];
+        c->unassigned++;
+        c->mines -= var->mine;
+    }
+}
+
+/*Enumerates the layouts of vars [i, var_count) with at most `max_mines` more
+ * mines. Returns false if the node budget ran out.*/
+static bool ms_SolverSearch(ms_Solver *solver, size_t i, int max_mines) {
+    if (++solver->nodes > MS_SOLVER_NODE_BUDGET) {
+        return false;
+    }
+    if (i == solver->var_count) {
+        for (size_t v = 0; v < solver->var_count; v++) {
+            solver->vars[v].seen_mine |= solver->vars[v].mine;
+            solver->vars[v].seen_safe |= !solver->vars[v].mine;
+        }
+        return true;
+    }
+    ms_SolverVar *var = &solver->vars[i];
+    for (int mine = 0; mine <= (max_mines > 0); mine++) {
+        bool ok = ms_SolverAssign(solver, var, mine);
+        bool done = !ok || ms_SolverSearch(solver, i + 1, max_mines - mine);
+        ms_SolverUnassign(solver, var);
+        if (!done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*Runs the search on every component that contains a number the rules looked
+ * at since the last pass. Components nobody touched cannot have changed.*/
+static void ms_SolverBacktrack(ms_Solver *solver, const ms_Game *game) {
+    int max_mines = game->mines_left - (int)solver->mine_count;
+    for (size_t f = 0; f < solver->fresh_count; f++) {
+        uint32_t cell = solver->fresh[f];
+        int x = cell % game->cols;
+        int y = cell / game->cols;
+        ms_SolverClear(solver->fresh_mark, game, x, y);
+        if (ms_SolverSeen(solver, game, cell) || !ms_FrontierHas(&solver->frontier, x, y)) {
+            continue;
+        }
+        ms_Neighbours n;
+        ms_SolverGather(solver, game, cell, &n);
+        if (n.count == 0) {
+            continue;
+        }
+
+        ms_SolverBuildComponent(solver, game, cell);
+        solver->nodes = 0;
+        solver->stats.components++;
+        if (!ms_SolverSearch(solver, 0, max_mines)) {
+            solver->stats.aborted++;
+            continue;
+        }
+        for (size_t v = 0; v < solver->var_count; v++) {
+            ms_SolverVar *var = &solver->vars[v];
+            if (var->seen_mine != var->seen_safe) {
+                ms_SolverConclude(solver, game, var->cell, var->seen_mine);
+                solver->stats.backtrack++;
+            }
+        }
+    }
+    solver->fresh_count = 0;
+
+    for (size_t i = 0; i < solver->seen_count; i++) {
+        uint32_t cell = solver->seen_cells[i];
+        ms_SolverClear(solver->seen, game, cell % game->cols, cell / game->cols);
+    }
+    solver->seen_count = 0;
+}
+
+/*Decides every hidden cell once no mines are left, or once every hidden cell
+ * has to be a mine.*/
+static void ms_SolverGlobal(ms_Solver *solver, const ms_Game *game) {
+    size_t hidden = ms_HiddenCount(game);
+    if (hidden == 0 || game->mines_left < 0 ||
+        (game->mines_left != 0 && (size_t)game->mines_left != hidden))
+    {
+        return;
+    }
+    for (int y = 0; y < game->rows; y++) {
+        for (int w = 0; w < game->stride; w++) {
+            size_t i = (size_t)y * game->stride + w;
+            uint64_t bits = ~(game->revealed[i] | game->flagged[i]) & ms_RowMask(game, w);
+            while (bits) {
+                int x = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                ms_SolverConclude(solver, game, (uint32_t)((size_t)y * game->cols + x), game->mines_left != 0);
+                solver->stats.global++;
+            }
+        }
+    }
+}
+
+/*Decides as many cells as it can without playing them and returns how many
+ * decided cells are waiting in `safe` and `mines`.*/
+size_t ms_SolverDeduce(ms_Solver *solver, const ms_Game *game) {
+    if (!game->first_click_done || game->state != ms_PLAYING) {
+        return solver->safe_count + solver->mine_count;
+    }
+    uint32_t cell;
+    while (ms_FrontierPop(&solver->frontier, &cell)) {
+        int x = cell % game->cols;
+        int y = cell / game->cols;
+        if (!ms_SolverTest(solver->fresh_mark, game, x, y)) {
+            ms_SolverSet(solver->fresh_mark, game, x, y);
+            solver->fresh = ms_Grow(solver->fresh, &solver->fresh_cap, solver->fresh_count + 1, sizeof(uint32_t));
+            solver->fresh[solver->fresh_count++] = cell;
+        }
+        ms_Neighbours n;
+        ms_SolverGather(solver, game, cell, &n);
+        if (!ms_SolverSingle(solver, game, &n)) {
+            ms_SolverPairs(solver, game, cell, &n);
+        }
+    }
+    if (solver->safe_count + solver->mine_count == 0) {
+        ms_SolverBacktrack(solver, game);
+    }
+    if (solver->safe_count + solver->mine_count == 0) {
+        ms_SolverGlobal(solver, game);
+    }
+    return solver->safe_count + solver->mine_count;
+}
+
+/*Plays every cell ms_SolverDeduce decided: flags the mines, then reveals the
+ * safe cells. Returns false if nothing could be decided, i.e. the next move
+ * would be a guess.*/
+bool ms_SolverStep(ms_Solver *solver, ms_Game *game) {
+    if (ms_SolverDeduce(solver, game) == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < solver->mine_count; i++) {
+        uint32_t cell = solver->mines[i];
+        ms_Pos pos = ms_PosXY(cell % game->cols, cell / game->cols);
+        ms_SolverClear(solver->known_mine, game, pos.x, pos.y);
+        if (game->state == ms_PLAYING && !ms_IsFlagged(game, pos.x, pos.y)) {
+            ms_MarkCell(game, &pos);
+            ms_SolverUpdate(solver, game, &cell, 1);
+            solver->stats.moves++;
+        }
+    }
+    for (size_t i = 0; i < solver->safe_count; i++) {
+        uint32_t cell = solver->safe[i];
+        ms_Pos pos = ms_PosXY(cell % game->cols, cell / game->cols);
+        ms_SolverClear(solver->known_safe, game, pos.x, pos.y);
+        if (game->state == ms_PLAYING && !ms_IsRevealed(game, pos.x, pos.y)) {
+            ms_ClickCell(game, &pos);
+            ms_RevealDelta delta = ms_GameDelta(game);
+            ms_SolverUpdate(solver, game, delta.cells, delta.count);
+            solver->stats.moves++;
+        }
+    }
+    solver->mine_count = 0;
+    solver->safe_count = 0;
+    return true;
+}
+
+/*Plays until the game is over or the solver would have to guess. Returns the
+ * game state, ms_PLAYING meaning the solver got stuck.*/
+ms_GameState ms_SolverPlay(ms_Solver *solver, ms_Game *game) {
+    while (game->state == ms_PLAYING && ms_SolverStep(solver, game)) {
+    }
+    return game->state;
+}
@@ -0,0 +1,104 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "minesweeper.h"
+#include "frontier.h"
+
+/* Deterministic solver.
+ * It only uses what a player can see: the revealed numbers, the flags (which it
+ * takes to be mines) and the number of mines left. Rules, cheapest first:
+ *
+ *  - single cell: a number whose remaining mines are 0, or equal to its hidden
+ *    neighbours, decides all of them,
+ *  - pairs: two numbers at most two cells apart are compared on the cells only
+ *    one of them sees (subset and superset rule),
+ *  - backtracking: every mine layout of a frontier component consistent with
+ *    its numbers is enumerated, up to MS_SOLVER_NODE_BUDGET search nodes per
+ *    component; cells that are safe (or a mine) in all of them are decided,
+ *  - global: no mines left, or exactly as many mines as hidden cells.
+ *
+ * The rules are driven by the frontier's dirty list, so after a move only the
+ * numbers around the cells it changed are looked at again, and backtracking
+ * only revisits components one of those numbers belongs to. */
+
+#define MS_SOLVER_NODE_BUDGET 100000
+
+/* A hidden frontier cell during backtracking. */
+typedef struct {
+    uint32_t cell;
+    int constraints[8];
+    int constraint_count;
+    int parent;
+    bool mine;
+    bool seen_mine;
+    bool seen_safe;
+} ms_SolverVar;
+
+/* A frontier number during backtracking: `remaining` mines among `vars`. */
+typedef struct {
+    uint32_t cell;
+    int vars[8];
+    int var_count;
+    int remaining;
+    int mines;
+    int unassigned;
+} ms_SolverConstraint;
+
+typedef struct {
+    size_t single;
+    size_t pair;
+    size_t backtrack;
+    size_t global;
+    size_t components;
+    size_t aborted;
+    size_t moves;
+} ms_SolverStats;
+
+/* `known_safe`/`known_mine` mark the cells decided but not played yet, they
+ * are listed in `safe` and `mines`. `fresh` lists the numbers the rules looked
+ * at since the last backtracking pass, `seen` marks the cells a pass already
+ * put into a component. `lookup` maps the cells of the current component to
+ * their var, as (cell << 32 | var) sorted. */
+typedef struct {
+    ms_Frontier frontier;
+    uint64_t *known_safe;
+    uint64_t *known_mine;
+    uint64_t *fresh_mark;
+    uint64_t *seen;
+    uint32_t *safe;
+    size_t safe_count;
+    size_t safe_cap;
+    uint32_t *mines;
+    size_t mine_count;
+    size_t mine_cap;
+    uint32_t *fresh;
+    size_t fresh_count;
+    size_t fresh_cap;
+    uint32_t *seen_cells;
+    size_t seen_count;
+    size_t seen_cap;
+    ms_SolverVar *vars;
+    size_t var_count;
+    size_t var_cap;
+    ms_SolverConstraint *constraints;
+    size_t constraint_count;
+    size_t constraint_cap;
+    uint64_t *lookup;
+    size_t lookup_cap;
+    size_t nodes;
+    ms_SolverStats stats;
+    ms_Arena arena;
+} ms_Solver;
+
+bool ms_SolverInit(ms_Solver *solver, const ms_Game *game);
+void ms_SolverFree(ms_Solver *solver);
+void ms_SolverUpdate(ms_Solver *solver, const ms_Game *game, const uint32_t *cells, size_t count);
+size_t ms_SolverDeduce(ms_Solver *solver, const ms_Game *game);
+bool ms_SolverStep(ms_Solver *solver, ms_Game *game);
+ms_GameState ms_SolverPlay(ms_Solver *solver, ms_Game *game);
+
+#endif // SOLVER_H
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "corpus.h"
+#include "minesweeper.h"
+#include "solver.h"
+
+/* Board corpus writer and reader.
+ *
+ *   corpus -w FILE [-n boards] [-d size] [-s seed]   writes a corpus
+ *   corpus [-S] [-r] FILE                            reads one back
+ *
+ * The writer places board i with seed ms_SplitMix64(seed + i) for a random
+ * first click. The reader maps the file, attaches every board without
+ * copying, plays its first click (and with -S lets the solver play on) and
+ * prints boards per second and a checksum of the outcomes. With -r it
+ * regenerates each board through ms_InitGameData instead, which has to give
+ * the same checksum. */
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void ms_Usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s -w FILE [-n boards] [-d beginner|intermediate|expert|COLSxROWSxMINES] [-s seed]\n"
+            "       %s [-S] [-r] FILE\n", name, name);
+}
+
+static bool ms_ParseSize(const char *arg, int *rows, int *cols, int *mines) {
+    const char *names[] = { "beginner", "intermediate", "expert" };
+    for (ms_Difficulty d = ms_BEGINNER; d < ms_CUSTOM; d++) {
+        if (strcmp(arg, names[d]) == 0) {
+            return ms_DifficultySize(d, rows, cols, mines);
+        }
+    }
+    return sscanf(arg, "%dx%dx%d", cols, rows, mines) == 3;
+}
+
+static int ms_WriteCorpus(const char *path, long boards, int rows, int cols, int mines, uint64_t seed) {
+    ms_CorpusWriter writer;
+    if (!ms_CorpusCreate(&writer, path, rows, cols, mines)) {
+        fprintf(stderr, "%s: could not create corpus\n", path);
+        return 1;
+    }
+    ms_Game game = {0};
+    double t0 = ms_Now();
+    for (long i = 0; i < boards; i++) {
+        uint64_t state = seed + i;
+        ms_InitGame(&game, rows, cols, mines, ms_SplitMix64(&state));
+        ms_Rng rng;
+        ms_RngSeed(&rng, ms_SplitMix64(&state));
+        ms_Pos first = ms_PosXY(ms_RngBelow(&rng, cols), ms_RngBelow(&rng, rows));
+        ms_InitGameData(&game, &first);
+        if (!ms_CorpusAppend(&writer, &game, first)) {
+            fprintf(stderr, "%s: write failed\n", path);
+            ms_CorpusFinish(&writer);
+            ms_FreeGame(&game);
+            return 1;
+        }
+    }
+    size_t record_size = writer.header.record_size;
+    bool ok = ms_CorpusFinish(&writer);
+    double elapsed = ms_Now() - t0;
+    ms_FreeGame(&game);
+    printf("%s: %ld boards of %dx%d, %d mines, %zu bytes per record, %.2f s\n",
+           path, boards, cols, rows, mines, record_size, elapsed);
+    return ok ? 0 : 1;
+}
+
+static int ms_ReadCorpus(const char *path, bool solve, bool regenerate) {
+    ms_Corpus corpus;
+    if (!ms_CorpusOpen(&corpus, path)) {
+        fprintf(stderr, "%s: not a corpus\n", path);
+        return 1;
+    }
+    ms_Game game = {0};
+    ms_Solver solver = {0};
+    uint64_t checksum = 0;
+    size_t won = 0;
+    double t0 = ms_Now();
+    for (size_t i = 0; i < corpus.count; i++) {
+        ms_Pos first;
+        if (regenerate) {
+            const ms_CorpusRecord *record = ms_CorpusAt(&corpus, i);
+            if (record->first_x >= corpus.header->cols || record->first_y >= corpus.header->rows ||
+                !ms_InitGame(&game, corpus.header->rows, corpus.header->cols, corpus.header->mines, record->seed))
+            {
+                fprintf(stderr, "%s: board %zu is invalid\n", path, i);
+                break;
+            }
+            first = ms_PosXY(record->first_x, record->first_y);
+            ms_InitGameData(&game, &first);
+            game.first_click_done = true;
+        } else if (!ms_CorpusLoad(&corpus, i, &game, &first)) {
+            fprintf(stderr, "%s: board %zu is invalid\n", path, i);
+            break;
+        }
+        ms_ClickCell(&game, &first);
+        if (solve) {
+            ms_SolverInit(&solver, &game);
+            ms_RevealDelta delta = ms_GameDelta(&game);
+            ms_SolverUpdate(&solver, &game, delta.cells, delta.count);
+            won += ms_SolverPlay(&solver, &game) == ms_GAME_WON;
+        }
+        uint64_t state = i ^ (uint64_t)game.hidden_safe << 20 ^ (uint64_t)game.state << 60;
+        checksum += ms_SplitMix64(&state);
+    }
+    double elapsed = ms_Now() - t0;
+    printf("%s: %zu boards of %ux%u, %u mines (%s)\n", path, corpus.count,
+           corpus.header->cols, corpus.header->rows, corpus.header->mines,
+           regenerate ? "regenerated" : "mapped");
+    if (solve) {
+        printf("solved      %zu / %zu\n", won, corpus.count);
+    }
+    printf("boards/s    %.0f\n", corpus.count / elapsed);
+    printf("checksum    %016llx\n", (unsigned long long)checksum);
+
+    ms_SolverFree(&solver);
+    // the board points into the mapping, so it goes first
+    ms_FreeGame(&game);
+    ms_CorpusClose(&corpus);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *output = NULL;
+    long boards = 100000;
+    uint64_t seed = 1;
+    bool solve = false, regenerate = false;
+    int rows, cols, mines;
+    ms_DifficultySize(ms_EXPERT, &rows, &cols, &mines);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "w:n:d:s:Sr")) != -1) {
+        switch (opt) {
+            case 'w': output = optarg; break;
+            case 'n': boards = strtol(optarg, NULL, 0); break;
+            case 's': seed = strtoull(optarg, NULL, 0); break;
+            case 'S': solve = true; break;
+            case 'r': regenerate = true; break;
+            case 'd':
+                if (!ms_ParseSize(optarg, &rows, &cols, &mines)) {
+                    ms_Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                ms_Usage(argv[0]);
+                return 1;
+        }
+    }
+    if (output) {
+        ms_Game probe = {0};
+        bool valid = ms_InitGame(&probe, rows, cols, mines, 0);
+        ms_FreeGame(&probe);
+        if (!valid || boards < 0) {
+            ms_Usage(argv[0]);
+            return 1;
+        }
+        return ms_WriteCorpus(output, boards, rows, cols, mines, seed);
+    }
+    if (optind != argc - 1) {
+        ms_Usage(argv[0]);
+        return 1;
+    }
+    return ms_ReadCorpus(argv[optind], solve, regenerate);
+}
@@ -0,0 +1,467 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "minesweeper.h"
+
+/* Load generator for bin/server.
+ * Opens `sessions` games spread over `connections` connections and keeps one
+ * request in flight per session for `duration` seconds: every answer is
+ * followed right away by the session's next move. Sessions play randomly from
+ * what the answers revealed: mostly reveals of hidden cells, some flags and
+ * chords. A finished game is closed and a new one opened in its place.
+ *
+ * Prints requests and moves (reveal, flag, chord) per second and the latency
+ * of moves, from queueing the request to reading its answer. */
+
+#define MS_LOAD_MAX_THREADS 64
+#define MS_LOAD_EVENTS      256
+#define MS_LOAD_READ        65536
+
+typedef enum {
+    ms_CELL_HIDDEN = 0,
+    ms_CELL_FLAGGED,
+    ms_CELL_REVEALED,
+} ms_BotCell;
+
+typedef struct {
+    uint32_t id;
+    // over all connections, picks the board seeds
+    uint32_t index;
+    // what the answers showed so far, one ms_BotCell per cell
+    uint8_t *cells;
+    // revealed cells with a number, candidates for chords
+    uint32_t *numbers;
+    size_t number_count;
+    uint64_t game;
+} ms_BotSession;
+
+/* A request waiting for its answer. */
+typedef struct {
+    uint32_t session;
+    char kind;
+    uint32_t cell;
+    uint64_t sent;
+} ms_Pending;
+
+typedef struct {
+    int fd;
+    char *in;
+    size_t in_len;
+    size_t in_cap;
+    char *out;
+    size_t out_len;
+    size_t out_sent;
+    size_t out_cap;
+    // ring of requests in flight, answered in order
+    ms_Pending *pending;
+    size_t head;
+    size_t tail;
+    size_t pending_cap;
+    ms_BotSession *sessions;
+    size_t session_count;
+} ms_LoadConn;
+
+typedef struct {
+    int rows;
+    int cols;
+    int mines;
+    uint64_t seed;
+    double duration;
+    const char *path;
+    int port;
+} ms_LoadConfig;
+
+typedef struct {
+    pthread_t thread;
+    const ms_LoadConfig *config;
+    ms_LoadConn *conns;
+    size_t conn_count;
+    ms_Rng rng;
+    uint64_t requests;
+    uint64_t moves;
+    uint64_t games;
+    uint64_t errors;
+    // latency of every move in nanoseconds
+    uint32_t *latencies;
+    size_t latency_count;
+    size_t latency_cap;
+    bool failed;
+} ms_LoadWorker;
+
+static uint64_t ms_NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int ms_Connect(const ms_LoadConfig *config) {
+    int fd;
+    if (config->port) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(config->port),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        };
+        if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    } else {
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        if (strlen(config->path) >= sizeof(addr.sun_path)) {
+            return -1;
+        }
+        strcpy(addr.sun_path, config->path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            return -1;
+        }
+    }
+    return fd;
+}
+
+/*Queues a request and remembers what it was for.*/
+static void ms_Send(ms_LoadConn *conn, uint32_t session, char kind, uint32_t cell, const char *line, int len) {
+    conn->out = ms_Grow(conn->out, &conn->out_cap, conn->out_len + len, 1);
+    memcpy(conn->out + conn->out_len, line, len);
+    conn->out_len += len;
+    size_t mask = conn->pending_cap - 1;
+    conn->pending[conn->tail++ & mask] = (ms_Pending) {
+        .session = session, .kind = kind, .cell = cell, .sent = ms_NowNs(),
+    };
+}
+
+static void ms_SendNew(ms_LoadWorker *worker, ms_LoadConn *conn, uint32_t index) {
+    const ms_LoadConfig *config = worker->config;
+    ms_BotSession *session = &conn->sessions[index];
+    memset(session->cells, ms_CELL_HIDDEN, (size_t)config->rows * config->cols);
+    session->number_count = 0;
+    uint64_t state = config->seed + (session->game++ << 32) + session->index;
+    char line[96];
+    int len = snprintf(line, sizeof(line), "N %d %d %d %llu\n", config->cols, config->rows, config->mines,
+                       (unsigned long long)ms_SplitMix64(&state));
+    ms_Send(conn, index, 'N', 0, line, len);
+}
+
+/*Picks the session's next move: a chord or a flag now and then, otherwise a
+ * reveal of a random hidden cell.*/
+static void ms_SendMove(ms_LoadWorker *worker, ms_LoadConn *conn, uint32_t index) {
+    const ms_LoadConfig *config = worker->config;
+    ms_BotSession *session = &conn->sessions[index];
+    uint32_t cells = config->rows * config->cols;
+    uint32_t roll = ms_RngBelow(&worker->rng, 10);
+    char kind = 'R';
+    uint32_t cell = 0;
+    if (roll == 0 && session->number_count) {
+        kind = 'C';
+        cell = session->numbers[ms_RngBelow(&worker->rng, session->number_count)];
+    } else {
+        // a few random tries, then the first hidden cell from a random start
+        cell = ms_RngBelow(&worker->rng, cells);
+        for (int tries = 0; tries < 8 && session->cells[cell] != ms_CELL_HIDDEN; tries++) {
+            cell = ms_RngBelow(&worker->rng, cells);
+        }
+        for (uint32_t i = 0; i < cells && session->cells[cell] != ms_CELL_HIDDEN; i++) {
+            cell = cell + 1 < cells ? cell + 1 : 0;
+        }
+        if (roll == 1) {
+            kind = 'F';
+        }
+    }
+    char line[64];
+    int len = snprintf(line, sizeof(line), "%c %u %u %u\n", kind, session->id, cell % config->cols, cell / config->cols);
+    ms_Send(conn, index, kind, cell, line, len);
+}
+
+/*Reads the cells listed in an R or C answer after "OK state count".*/
+static void ms_ReadDelta(ms_BotSession *session, const char *text, uint32_t cells) {
+    while (*text == ' ') {
+        char *end;
+        uint32_t cell = strtoul(text + 1, &end, 10);
+        if (*end != ':' || cell >= cells) {
+            return;
+        }
+        char value = end[1];
+        session->cells[cell] = ms_CELL_REVEALED;
+        if (value > '0' && value <= '8') {
+            session->numbers[session->number_count++] = cell;
+        }
+        text = end + 2;
+    }
+}
+
+/*Handles one answer and sends the session's next request.*/
+static void ms_HandleAnswer(ms_LoadWorker *worker, ms_LoadConn *conn, char *line, uint64_t now) {
+    ms_Pending pending = conn->pending[conn->head++ & (conn->pending_cap - 1)];
+    ms_BotSession *session = &conn->sessions[pending.session];
+    const ms_LoadConfig *config = worker->config;
+    worker->requests++;
+    if (strncmp(line, "OK", 2) != 0) {
+        worker->errors++;
+        return;
+    }
+    const char *text = line + 2;
+    switch (pending.kind) {
+        case 'N':
+            session->id = strtoul(text, NULL, 10);
+            ms_SendMove(worker, conn, pending.session);
+            return;
+        case 'X':
+            ms_SendNew(worker, conn, pending.session);
+            return;
+        default:
+            break;
+    }
+
+    worker->moves++;
+    worker->latencies = ms_Grow(worker->latencies, &worker->latency_cap, worker->latency_count + 1, sizeof(uint32_t));
+    uint64_t latency = now - pending.sent;
+    worker->latencies[worker->latency_count++] = latency > UINT32_MAX ? UINT32_MAX : latency;
+
+    bool playing = strncmp(text, " playing", 8) == 0;
+    if (pending.kind == 'F') {
+        uint8_t *cell = &session->cells[pending.cell];
+        *cell = *cell == ms_CELL_HIDDEN ? ms_CELL_FLAGGED : ms_CELL_HIDDEN;
+    } else if (playing) {
+        // " playing <count>" and then the cells
+        char *end;
+        strtoul(text + 8, &end, 10);
+        ms_ReadDelta(session, end, config->rows * config->cols);
+    }
+    if (playing) {
+        ms_SendMove(worker, conn, pending.session);
+    } else {
+        worker->games++;
+        char close_line[32];
+        int len = snprintf(close_line, sizeof(close_line), "X %u\n", session->id);
+        ms_Send(conn, pending.session, 'X', 0, close_line, len);
+    }
+}
+
+static bool ms_LoadRead(ms_LoadWorker *worker, ms_LoadConn *conn) {
+    conn->in = ms_Grow(conn->in, &conn->in_cap, conn->in_len + MS_LOAD_READ, 1);
+    ssize_t n = read(conn->fd, conn->in + conn->in_len, conn->in_cap - conn->in_len);
+    if (n <= 0) {
+        return n < 0 && (errno == EAGAIN || errno == EINTR);
+    }
+    uint64_t now = ms_NowNs();
+    conn->in_len += n;
+    size_t start = 0;
+    char *newline;
+    while ((newline = memchr(conn->in + start, '\n', conn->in_len - start))) {
+        *newline = '\0';
+        ms_HandleAnswer(worker, conn, conn->in + start, now);
+        start = newline - conn->in + 1;
+    }
+    memmove(conn->in, conn->in + start, conn->in_len - start);
+    conn->in_len -= start;
+    return true;
+}
+
+static bool ms_LoadFlush(ms_LoadConn *conn) {
+    while (conn->out_sent < conn->out_len) {
+        ssize_t n = write(conn->fd, conn->out + conn->out_sent, conn->out_len - conn->out_sent);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EINTR;
+        }
+        conn->out_sent += n;
+    }
+    conn->out_sent = 0;
+    conn->out_len = 0;
+    return true;
+}
+
+static void *ms_LoadWork(void *arg) {
+    ms_LoadWorker *worker = arg;
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    for (size_t i = 0; i < worker->conn_count; i++) {
+        ms_LoadConn *conn = &worker->conns[i];
+        struct epoll_event event = { .events = EPOLLIN | EPOLLOUT, .data.ptr = conn };
+        epoll_ctl(epoll, EPOLL_CTL_ADD, conn->fd, &event);
+        for (size_t s = 0; s < conn->session_count; s++) {
+            ms_SendNew(worker, conn, s);
+        }
+    }
+    uint64_t end = ms_NowNs() + (uint64_t)(worker->config->duration * 1e9);
+    struct epoll_event events[MS_LOAD_EVENTS];
+    while (ms_NowNs() < end && !worker->failed) {
+        int n = epoll_wait(epoll, events, MS_LOAD_EVENTS, 100);
+        for (int i = 0; i < n; i++) {
+            ms_LoadConn *conn = events[i].data.ptr;
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !ms_LoadRead(worker, conn)) {
+                worker->failed = true;
+            }
+            if (!ms_LoadFlush(conn)) {
+                worker->failed = true;
+            }
+        }
+    }
+    close(epoll);
+    return NULL;
+}
+
+static int ms_CompareU32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void ms_Usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [-s socket | -p port] [-n sessions] [-c connections] [-t threads]\n"
+            "          [-d beginner|intermediate|expert|COLSxROWSxMINES] [-D seconds] [-r seed]\n", name);
+}
+
+static bool ms_ParseSize(ms_LoadConfig *config, const char *arg) {
+    const char *names[] = { "beginner", "intermediate", "expert" };
+    for (ms_Difficulty d = ms_BEGINNER; d < ms_CUSTOM; d++) {
+        if (strcmp(arg, names[d]) == 0) {
+            return ms_DifficultySize(d, &config->rows, &config->cols, &config->mines);
+        }
+    }
+    return sscanf(arg, "%dx%dx%d", &config->cols, &config->rows, &config->mines) == 3;
+}
+
+int main(int argc, char **argv) {
+    ms_LoadConfig config = { .seed = 1, .duration = 5, .path = "minesweeper.sock" };
+    ms_DifficultySize(ms_EXPERT, &config.rows, &config.cols, &config.mines);
+    long sessions = 10000;
+    long connections = 64;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:p:n:c:t:d:D:r:")) != -1) {
+        switch (opt) {
+            case 's': config.path = optarg; break;
+            case 'p': config.port = strtol(optarg, NULL, 0); break;
+            case 'n': sessions = strtol(optarg, NULL, 0); break;
+            case 'c': connections = strtol(optarg, NULL, 0); break;
+            case 't': threads = strtol(optarg, NULL, 0); break;
+            case 'D': config.duration = strtod(optarg, NULL); break;
+            case 'r': config.seed = strtoull(optarg, NULL, 0); break;
+            case 'd':
+                if (!ms_ParseSize(&config, optarg)) {
+                    ms_Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                ms_Usage(argv[0]);
+                return 1;
+        }
+    }
+    ms_Game probe = {0};
+    bool valid = ms_InitGame(&probe, config.rows, config.cols, config.mines, 0);
+    ms_FreeGame(&probe);
+    if (!valid || optind != argc || sessions < 1 || connections < 1 || connections > sessions ||
+        threads < 1 || threads > MS_LOAD_MAX_THREADS || config.duration <= 0)
+    {
+        ms_Usage(argv[0]);
+        return 1;
+    }
+    if (threads > connections) {
+        threads = connections;
+    }
+
+    size_t cells = (size_t)config.rows * config.cols;
+    ms_LoadConn *conns = calloc(connections, sizeof(ms_LoadConn));
+    ms_BotSession *all_sessions = calloc(sessions, sizeof(ms_BotSession));
+    for (long i = 0; i < sessions; i++) {
+        all_sessions[i].index = i;
+        all_sessions[i].cells = malloc(cells);
+        all_sessions[i].numbers = malloc(cells * sizeof(uint32_t));
+    }
+    for (long c = 0; c < connections; c++) {
+        ms_LoadConn *conn = &conns[c];
+        conn->fd = ms_Connect(&config);
+        if (conn->fd < 0) {
+            perror(config.port ? "connect" : config.path);
+            return 1;
+        }
+        // connected blocking, so connect waits for the server, used nonblocking
+        fcntl(conn->fd, F_SETFL, O_NONBLOCK);
+        long begin = sessions * c / connections;
+        long end = sessions * (c + 1) / connections;
+        conn->sessions = all_sessions + begin;
+        conn->session_count = end - begin;
+        // every session has at most two requests in flight (X, then N)
+        conn->pending_cap = 1;
+        while (conn->pending_cap < 2 * conn->session_count) {
+            conn->pending_cap *= 2;
+        }
+        conn->pending = malloc(conn->pending_cap * sizeof(ms_Pending));
+    }
+
+    static ms_LoadWorker workers[MS_LOAD_MAX_THREADS];
+    for (long t = 0; t < threads; t++) {
+        long begin = connections * t / threads;
+        long end = connections * (t + 1) / threads;
+        workers[t].config = &config;
+        workers[t].conns = conns + begin;
+        workers[t].conn_count = end - begin;
+        ms_RngSeed(&workers[t].rng, config.seed + t);
+        pthread_create(&workers[t].thread, NULL, ms_LoadWork, &workers[t]);
+    }
+    uint64_t requests = 0, moves = 0, games = 0, errors = 0;
+    size_t latency_count = 0;
+    bool failed = false;
+    for (long t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        requests += workers[t].requests;
+        moves += workers[t].moves;
+        games += workers[t].games;
+        errors += workers[t].errors;
+        latency_count += workers[t].latency_count;
+        failed = failed || workers[t].failed;
+    }
+    uint32_t *latencies = malloc((latency_count + 1) * sizeof(uint32_t));
+    size_t n = 0;
+    for (long t = 0; t < threads; t++) {
+        memcpy(latencies + n, workers[t].latencies, workers[t].latency_count * sizeof(uint32_t));
+        n += workers[t].latency_count;
+        free(workers[t].latencies);
+    }
+    qsort(latencies, n, sizeof(uint32_t), ms_CompareU32);
+
+    printf("%ld sessions over %ld connections, %ld threads, %dx%d with %d mines, %.1f s\n\n",
+           sessions, connections, threads, config.cols, config.rows, config.mines, config.duration);
+    printf("requests    %llu (%.0f/s), %llu errors\n", (unsigned long long)requests,
+           requests / config.duration, (unsigned long long)errors);
+    printf("moves       %llu (%.0f/s)\n", (unsigned long long)moves, moves / config.duration);
+    printf("games       %llu\n", (unsigned long long)games);
+    if (n) {
+        printf("latency     p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+               latencies[n / 2] / 1e6, latencies[(n - 1) * 99 / 100] / 1e6, latencies[n - 1] / 1e6);
+    }
+    if (failed) {
+        printf("the server closed a connection\n");
+    }
+
+    free(latencies);
+    for (long c = 0; c < connections; c++) {
+        close(conns[c].fd);
+        free(conns[c].in);
+        free(conns[c].out);
+        free(conns[c].pending);
+    }
+    for (long i = 0; i < sessions; i++) {
+        free(all_sessions[i].cells);
+        free(all_sessions[i].numbers);
+    }
+    free(all_sessions);
+    free(conns);
+    return failed ? 1 : 0;
+}
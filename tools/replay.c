@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "minesweeper.h"
+#include "replay.h"
+#include "solver.h"
+
+/* Headless replay player.
+ * Plays replay files as fast as the engine goes and prints the final state of
+ * each with a fingerprint of its revealed and flagged cells, so two runs (or
+ * two engine versions) can be compared move for move.
+ *
+ * With -g it records a corpus instead: games played by the solver, guessing a
+ * random hidden cell whenever it is stuck. The fingerprints printed while
+ * recording match the ones printed when the files are played back. */
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t ms_Fingerprint(const ms_Game *game) {
+    uint64_t hash = 0xcbf29ce484222325ull ^ game->state;
+    size_t words = (size_t)game->rows * game->stride;
+    for (size_t i = 0; i < words; i++) {
+        hash = (hash ^ game->revealed[i]) * 0x100000001b3ull;
+        hash = (hash ^ game->flagged[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static const char *ms_StateName(ms_GameState state) {
+    switch (state) {
+        case ms_PLAYING: return "playing";
+        case ms_GAME_OVER: return "lost";
+        case ms_GAME_WON: return "won";
+    }
+    return "?";
+}
+
+static void ms_Usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [-n repeat] FILE...\n"
+            "       %s -g games -o DIR [-d beginner|intermediate|expert|COLSxROWSxMINES] [-s seed]\n",
+            name, name);
+}
+
+static bool ms_ParseSize(const char *arg, int *rows, int *cols, int *mines) {
+    const char *names[] = { "beginner", "intermediate", "expert" };
+    for (ms_Difficulty d = ms_BEGINNER; d < ms_CUSTOM; d++) {
+        if (strcmp(arg, names[d]) == 0) {
+            return ms_DifficultySize(d, rows, cols, mines);
+        }
+    }
+    return sscanf(arg, "%dx%dx%d", cols, rows, mines) == 3;
+}
+
+/*Plays every file `repeat` times. Returns the number of files that could not
+ * be read.*/
+static int ms_PlayFiles(char **paths, int count, long repeat) {
+    ms_Game game = {0};
+    size_t total_moves = 0, total_bytes = 0, games = 0;
+    int failed = 0;
+    double busy = 0;
+    for (int i = 0; i < count; i++) {
+        ms_Replay replay;
+        if (!ms_ReplayOpen(&replay, paths[i])) {
+            fprintf(stderr, "%s: not a replay\n", paths[i]);
+            failed++;
+            continue;
+        }
+        size_t moves = 0;
+        double t0 = ms_Now();
+        bool valid = true;
+        for (long r = 0; r < repeat && valid; r++) {
+            valid = ms_ReplayPlay(&replay, &game, &moves);
+        }
+        busy += ms_Now() - t0;
+        if (!valid) {
+            fprintf(stderr, "%s: invalid board\n", paths[i]);
+            failed++;
+        } else {
+            printf("%s: %dx%d, %d mines, %zu moves, %zu bytes, %s, %016llx\n",
+                   paths[i], replay.cols, replay.rows, replay.mines, moves, replay.size,
+                   ms_StateName(game.state), (unsigned long long)ms_Fingerprint(&game));
+            total_moves += moves * repeat;
+            total_bytes += replay.size;
+            games += repeat;
+        }
+        ms_ReplayClose(&replay);
+    }
+    if (games) {
+        printf("\n%zu games, %zu moves in %.3f s: %.0f games/s, %.0f moves/s, %.1f bytes/move\n",
+               games, total_moves, busy, games / busy, total_moves / busy,
+               (double)total_bytes * repeat / total_moves);
+    }
+    ms_FreeGame(&game);
+    return failed;
+}
+
+/*Plays one solver game, recording every move.*/
+static bool ms_RecordGame(ms_Recorder *recorder, ms_Game *game, ms_Solver *solver, ms_Rng *rng) {
+    ms_SolverInit(solver, game);
+    bool ok = true;
+    while (game->state == ms_PLAYING && ok) {
+        if (ms_SolverDeduce(solver, game) > 0) {
+            // same order as ms_SolverStep: flags first, then reveals
+            for (size_t i = 0; i < solver->mine_count && game->state == ms_PLAYING; i++) {
+                ms_Pos pos = ms_PosXY(solver->mines[i] % game->cols, solver->mines[i] / game->cols);
+                solver->known_mine[ms_WordIndex(game, pos.x, pos.y)] &= ~ms_BitMask(pos.x);
+                if (!ms_IsFlagged(game, pos.x, pos.y)) {
+                    ms_MarkCell(game, &pos);
+                    ms_SolverUpdate(solver, game, &solver->mines[i], 1);
+                    ok = ok && ms_RecordMove(recorder, (ms_ReplayMove) { .kind = ms_MOVE_FLAG, .cell = solver->mines[i] });
+                }
+            }
+            for (size_t i = 0; i < solver->safe_count && game->state == ms_PLAYING; i++) {
+                ms_Pos pos = ms_PosXY(solver->safe[i] % game->cols, solver->safe[i] / game->cols);
+                solver->known_safe[ms_WordIndex(game, pos.x, pos.y)] &= ~ms_BitMask(pos.x);
+                if (!ms_IsRevealed(game, pos.x, pos.y)) {
+                    ms_ClickCell(game, &pos);
+                    ms_RevealDelta delta = ms_GameDelta(game);
+                    ms_SolverUpdate(solver, game, delta.cells, delta.count);
+                    ok = ok && ms_RecordMove(recorder, (ms_ReplayMove) { .kind = ms_MOVE_REVEAL, .cell = solver->safe[i] });
+                }
+            }
+            solver->safe_count = 0;
+            solver->mine_count = 0;
+            continue;
+        }
+        ms_Pos pos;
+        do {
+            pos = ms_PosXY(ms_RngBelow(rng, game->cols), ms_RngBelow(rng, game->rows));
+        } while (!ms_IsHidden(game, pos.x, pos.y));
+        ms_ClickCell(game, &pos);
+        ms_RevealDelta delta = ms_GameDelta(game);
+        ms_SolverUpdate(solver, game, delta.cells, delta.count);
+        ok = ms_RecordMove(recorder, (ms_ReplayMove) { .kind = ms_MOVE_REVEAL, .cell = pos.y * game->cols + pos.x });
+    }
+    return ok;
+}
+
+static int ms_RecordCorpus(const char *dir, long games, int rows, int cols, int mines, uint64_t seed) {
+    ms_Game game = {0};
+    ms_Solver solver = {0};
+    for (long i = 0; i < games; i++) {
+        uint64_t state = seed + i;
+        ms_Rng rng;
+        ms_InitGame(&game, rows, cols, mines, ms_SplitMix64(&state));
+        ms_RngSeed(&rng, ms_SplitMix64(&state));
+
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/game-%06ld.msr", dir, i);
+        ms_Recorder recorder;
+        if (!ms_RecorderStart(&recorder, path, &game) || !ms_RecordGame(&recorder, &game, &solver, &rng)) {
+            fprintf(stderr, "%s: could not write\n", path);
+            ms_RecorderStop(&recorder);
+            return 1;
+        }
+        printf("%s: %dx%d, %d mines, %zu bytes, %s, %016llx\n", path, cols, rows, mines,
+               recorder.bytes, ms_StateName(game.state), (unsigned long long)ms_Fingerprint(&game));
+        ms_RecorderStop(&recorder);
+    }
+    ms_SolverFree(&solver);
+    ms_FreeGame(&game);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long repeat = 1;
+    long games = 0;
+    const char *dir = NULL;
+    uint64_t seed = 1;
+    int rows, cols, mines;
+    ms_DifficultySize(ms_EXPERT, &rows, &cols, &mines);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:g:o:d:s:")) != -1) {
+        switch (opt) {
+            case 'n': repeat = strtol(optarg, NULL, 0); break;
+            case 'g': games = strtol(optarg, NULL, 0); break;
+            case 'o': dir = optarg; break;
+            case 's': seed = strtoull(optarg, NULL, 0); break;
+            case 'd':
+                if (!ms_ParseSize(optarg, &rows, &cols, &mines)) {
+                    ms_Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                ms_Usage(argv[0]);
+                return 1;
+        }
+    }
+    if (games > 0) {
+        ms_Game probe = {0};
+        bool valid = ms_InitGame(&probe, rows, cols, mines, 0);
+        ms_FreeGame(&probe);
+        if (!dir || !valid) {
+            ms_Usage(argv[0]);
+            return 1;
+        }
+        return ms_RecordCorpus(dir, games, rows, cols, mines, seed);
+    }
+    if (optind >= argc || repeat < 1) {
+        ms_Usage(argv[0]);
+        return 1;
+    }
+    return ms_PlayFiles(argv + optind, argc - optind, repeat) ? 1 : 0;
+}
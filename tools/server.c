@@ -0,0 +1,567 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "minesweeper.h"
+
+/* Game server.
+ * Hosts many game sessions in one process for bots to play over a Unix domain
+ * socket, or TCP on loopback with -p. Every request is one line and gets one
+ * line back, in order:
+ *
+ *   N cols rows mines seed   new session       OK sid
+ *   R sid x y                reveal            OK state count cell:value...
+ *   C sid x y                chord             OK state count cell:value...
+ *   F sid x y                toggle a flag     OK state mines_left
+ *   S sid                    state             OK state mines_left hidden
+ *   B sid                    board             OK one character per cell
+ *   X sid                    close session     OK
+ *
+ * `state` is playing, lost or won. R and C list the cells the move revealed
+ * as linear indices y*cols + x with their value, 0-8 or * for a mine. B shows
+ * the board row by row: . hidden, F flagged, 0-8 or *. A request that can not
+ * be played is answered with ERR and a reason.
+ *
+ * Every worker thread runs its own epoll loop. The listening socket is in all
+ * of them with EPOLLEXCLUSIVE, so the kernel hands each new connection to one
+ * worker, which serves it until it closes. Session ids belong to the
+ * connection that opened them, so a session is only ever touched by one
+ * thread and no request takes a lock.
+ *
+ * Each session's board lives in its own arena (ms_Game.arena). A closed
+ * session keeps it, and the next N on the connection reuses the id and, if
+ * the board fits, the memory. */
+
+#define MS_SERVER_MAX_THREADS 64
+#define MS_SERVER_EVENTS      256
+// how often idle workers look at the stop flag
+#define MS_SERVER_POLL_MS     200
+#define MS_SERVER_READ        65536
+#define MS_SERVER_MAX_LINE    256
+// a connection is not read from while this many answer bytes wait to be sent
+#define MS_SERVER_MAX_PENDING (1 << 20)
+// largest board a session may open
+#define MS_SERVER_MAX_CELLS   (1 << 22)
+
+typedef struct {
+    ms_Game game;
+    bool open;
+} ms_Session;
+
+typedef struct ms_Conn {
+    int fd;
+    // epoll events currently asked for
+    uint32_t events;
+    // bytes read but not handled yet
+    char *in;
+    size_t in_len;
+    size_t in_cap;
+    // answers, written from out_sent on
+    char *out;
+    size_t out_len;
+    size_t out_sent;
+    size_t out_cap;
+    ms_Session *sessions;
+    size_t session_count;
+    size_t session_cap;
+    uint32_t *free_ids;
+    size_t free_count;
+    size_t free_cap;
+    // the worker's open connections
+    struct ms_Conn *prev;
+    struct ms_Conn *next;
+} ms_Conn;
+
+typedef struct {
+    pthread_t thread;
+    int epoll;
+    int listen_fd;
+    ms_Conn *conns;
+    // totals, read once the worker is done
+    uint64_t connections;
+    uint64_t requests;
+    uint64_t moves;
+    uint64_t sessions;
+} ms_ServerWorker;
+
+static _Atomic bool stop = false;
+
+static void ms_Stop(int signal) {
+    (void)signal;
+    atomic_store(&stop, true);
+}
+
+/*Appends a formatted answer to the connection's output.*/
+static void ms_Reply(ms_Conn *conn, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    conn->out = ms_Grow(conn->out, &conn->out_cap, conn->out_len + 64, 1);
+    for (;;) {
+        size_t room = conn->out_cap - conn->out_len;
+        va_list copy;
+        va_copy(copy, args);
+        int n = vsnprintf(conn->out + conn->out_len, room, format, copy);
+        va_end(copy);
+        if ((size_t)n < room) {
+            conn->out_len += n;
+            break;
+        }
+        conn->out = ms_Grow(conn->out, &conn->out_cap, conn->out_len + n + 1, 1);
+    }
+    va_end(args);
+}
+
+static const char *ms_StateName(ms_GameState state) {
+    switch (state) {
+        case ms_PLAYING: return "playing";
+        case ms_GAME_OVER: return "lost";
+        case ms_GAME_WON: return "won";
+    }
+    return "?";
+}
+
+static char ms_ValueChar(int value) {
+    return value == MINE ? '*' : '0' + value;
+}
+
+/*Parses up to `max` unsigned numbers separated by spaces. Returns how many
+ * there were, or -1 if the line holds anything else.*/
+static int ms_ParseArgs(const char *line, unsigned long long *args, int max) {
+    int count = 0;
+    for (;;) {
+        while (*line == ' ') {
+            line++;
+        }
+        if (*line == '\0') {
+            return count;
+        }
+        if (count == max || *line < '0' || *line > '9') {
+            return -1;
+        }
+        char *end;
+        errno = 0;
+        args[count++] = strtoull(line, &end, 10);
+        if (errno || (*end != ' ' && *end != '\0')) {
+            return -1;
+        }
+        line = end;
+    }
+}
+
+static ms_Session *ms_FindSession(ms_Conn *conn, unsigned long long id) {
+    if (id >= conn->session_count || !conn->sessions[id].open) {
+        return NULL;
+    }
+    return &conn->sessions[id];
+}
+
+static void ms_NewSession(ms_ServerWorker *worker, ms_Conn *conn, const unsigned long long *args) {
+    unsigned long long cols = args[0], rows = args[1], mines = args[2];
+    if (cols > MS_MAX_SIDE || rows > MS_MAX_SIDE || cols * rows > MS_SERVER_MAX_CELLS) {
+        ms_Reply(conn, "ERR board too large\n");
+        return;
+    }
+    uint32_t id;
+    if (conn->free_count) {
+        id = conn->free_ids[conn->free_count - 1];
+    } else {
+        id = conn->session_count;
+        conn->sessions = ms_Grow(conn->sessions, &conn->session_cap, id + 1, sizeof(ms_Session));
+        conn->sessions[id] = (ms_Session) {0};
+    }
+    ms_Session *session = &conn->sessions[id];
+    if (mines > INT32_MAX || !ms_InitGame(&session->game, rows, cols, mines, args[3])) {
+        if (id == conn->session_count) {
+            ms_FreeGame(&session->game);
+        }
+        ms_Reply(conn, "ERR invalid board\n");
+        return;
+    }
+    if (id == conn->session_count) {
+        conn->session_count++;
+    } else {
+        conn->free_count--;
+    }
+    session->open = true;
+    worker->sessions++;
+    ms_Reply(conn, "OK %u\n", id);
+}
+
+/*Answers a reveal or chord with the cells it opened.*/
+static void ms_ReplyDelta(ms_Conn *conn, const ms_Game *game) {
+    ms_RevealDelta delta = ms_GameDelta(game);
+    ms_Reply(conn, "OK %s %zu", ms_StateName(game->state), delta.count);
+    for (size_t i = 0; i < delta.count; i++) {
+        uint32_t cell = delta.cells[i];
+        ms_Reply(conn, " %u:%c", cell, ms_ValueChar(ms_ValueAt(game, cell % game->cols, cell / game->cols)));
+    }
+    ms_Reply(conn, "\n");
+}
+
+static void ms_ReplyBoard(ms_Conn *conn, const ms_Game *game) {
+    size_t cells = (size_t)game->rows * game->cols;
+    conn->out = ms_Grow(conn->out, &conn->out_cap, conn->out_len + cells + 5, 1);
+    char *out = conn->out + conn->out_len;
+    out += sprintf(out, "OK ");
+    for (int y = 0; y < game->rows; y++) {
+        for (int x = 0; x < game->cols; x++) {
+            if (ms_IsFlagged(game, x, y)) {
+                *out++ = 'F';
+            } else if (ms_IsRevealed(game, x, y)) {
+                *out++ = ms_ValueChar(ms_ValueAt(game, x, y));
+            } else {
+                *out++ = '.';
+            }
+        }
+    }
+    *out++ = '\n';
+    conn->out_len = out - conn->out;
+}
+
+static void ms_HandleRequest(ms_ServerWorker *worker, ms_Conn *conn, char *line) {
+    worker->requests++;
+    size_t len = strlen(line);
+    if (len && line[len - 1] == '\r') {
+        line[len - 1] = '\0';
+    }
+    char command = line[0];
+    unsigned long long args[4];
+    int count = command ? ms_ParseArgs(line + 1, args, 4) : -1;
+    if (command == 'N') {
+        if (count != 4) {
+            ms_Reply(conn, "ERR usage: N cols rows mines seed\n");
+            return;
+        }
+        ms_NewSession(worker, conn, args);
+        return;
+    }
+
+    int expected = command == 'R' || command == 'C' || command == 'F' ? 3 : 1;
+    if (!strchr("RCFSBX", command) || count != expected) {
+        ms_Reply(conn, "ERR bad request\n");
+        return;
+    }
+    ms_Session *session = ms_FindSession(conn, args[0]);
+    if (!session) {
+        ms_Reply(conn, "ERR no such session\n");
+        return;
+    }
+    ms_Game *game = &session->game;
+    ms_Pos pos = {0};
+    if (expected == 3) {
+        if (args[1] >= (unsigned long long)game->cols || args[2] >= (unsigned long long)game->rows) {
+            ms_Reply(conn, "ERR outside the board\n");
+            return;
+        }
+        pos = ms_PosXY(args[1], args[2]);
+        worker->moves++;
+    }
+    switch (command) {
+        case 'R':
+            ms_ClickCell(game, &pos);
+            ms_ReplyDelta(conn, game);
+            break;
+        case 'C':
+            ms_ChordCell(game, &pos);
+            ms_ReplyDelta(conn, game);
+            break;
+        case 'F':
+            ms_MarkCell(game, &pos);
+            ms_Reply(conn, "OK %s %d\n", ms_StateName(game->state), game->mines_left);
+            break;
+        case 'S':
+            {
+                // before the first click nothing is revealed yet
+                size_t hidden = game->first_click_done ? ms_HiddenCount(game)
+                    : (size_t)game->rows * game->cols - (game->mine_count - game->mines_left);
+                ms_Reply(conn, "OK %s %d %zu\n", ms_StateName(game->state), game->mines_left, hidden);
+            } break;
+        case 'B':
+            ms_ReplyBoard(conn, game);
+            break;
+        case 'X':
+            session->open = false;
+            conn->free_ids = ms_Grow(conn->free_ids, &conn->free_cap, conn->free_count + 1, sizeof(uint32_t));
+            conn->free_ids[conn->free_count++] = args[0];
+            ms_Reply(conn, "OK\n");
+            break;
+    }
+}
+
+/*Answers the complete lines read so far until MS_SERVER_MAX_PENDING answer
+ * bytes wait to be sent; the lines after that stay in `in` until they have
+ * gone out. Returns false on a line too long to be a request.*/
+static bool ms_ConnHandle(ms_ServerWorker *worker, ms_Conn *conn) {
+    size_t start = 0;
+    char *newline;
+    while (conn->out_len < MS_SERVER_MAX_PENDING &&
+           (newline = memchr(conn->in + start, '\n', conn->in_len - start)))
+    {
+        *newline = '\0';
+        ms_HandleRequest(worker, conn, conn->in + start);
+        start = newline - conn->in + 1;
+    }
+    // only the line still waiting for its newline can be too long
+    if (conn->in_len - start > MS_SERVER_MAX_LINE && !memchr(conn->in + start, '\n', conn->in_len - start)) {
+        return false;
+    }
+    memmove(conn->in, conn->in + start, conn->in_len - start);
+    conn->in_len -= start;
+    return true;
+}
+
+/*Reads what is there and answers the complete lines. Returns false once the
+ * connection is done.*/
+static bool ms_ConnRead(ms_ServerWorker *worker, ms_Conn *conn) {
+    conn->in = ms_Grow(conn->in, &conn->in_cap, conn->in_len + MS_SERVER_READ, 1);
+    ssize_t n = read(conn->fd, conn->in + conn->in_len, conn->in_cap - conn->in_len);
+    if (n == 0) {
+        return false;
+    }
+    if (n < 0) {
+        return errno == EAGAIN || errno == EINTR;
+    }
+    conn->in_len += n;
+    return ms_ConnHandle(worker, conn);
+}
+
+/*Writes pending answers and asks epoll for what the connection waits on next.*/
+static bool ms_ConnFlush(ms_ServerWorker *worker, ms_Conn *conn) {
+    while (conn->out_sent < conn->out_len) {
+        ssize_t n = write(conn->fd, conn->out + conn->out_sent, conn->out_len - conn->out_sent);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                break;
+            }
+            return false;
+        }
+        conn->out_sent += n;
+    }
+    if (conn->out_sent == conn->out_len) {
+        conn->out_sent = 0;
+        conn->out_len = 0;
+    }
+    // lines held back while the answers piled up; theirs go out on the next EPOLLOUT
+    if (conn->in_len > 0 && !ms_ConnHandle(worker, conn)) {
+        return false;
+    }
+    // a client that does not read its answers is not read from either
+    uint32_t events = conn->out_len ? EPOLLOUT : 0;
+    if (conn->out_len < MS_SERVER_MAX_PENDING) {
+        events |= EPOLLIN;
+    }
+    if (events != conn->events) {
+        struct epoll_event event = { .events = events, .data.ptr = conn };
+        if (epoll_ctl(worker->epoll, EPOLL_CTL_MOD, conn->fd, &event) != 0) {
+            return false;
+        }
+        conn->events = events;
+    }
+    return true;
+}
+
+static void ms_ConnClose(ms_ServerWorker *worker, ms_Conn *conn) {
+    close(conn->fd);
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        worker->conns = conn->next;
+    }
+    if (conn->next) {
+        conn->next->prev = conn->prev;
+    }
+    for (size_t i = 0; i < conn->session_count; i++) {
+        ms_FreeGame(&conn->sessions[i].game);
+    }
+    free(conn->sessions);
+    free(conn->free_ids);
+    free(conn->in);
+    free(conn->out);
+    free(conn);
+}
+
+static void ms_Accept(ms_ServerWorker *worker) {
+    int fd = accept(worker->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        // another worker got it first
+        return;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    int one = 1;
+    // fails harmlessly on Unix sockets
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    ms_Conn *conn = calloc(1, sizeof(ms_Conn));
+    if (!conn) {
+        close(fd);
+        return;
+    }
+    conn->fd = fd;
+    conn->events = EPOLLIN;
+    struct epoll_event event = { .events = conn->events, .data.ptr = conn };
+    if (epoll_ctl(worker->epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+        close(fd);
+        free(conn);
+        return;
+    }
+    conn->next = worker->conns;
+    if (conn->next) {
+        conn->next->prev = conn;
+    }
+    worker->conns = conn;
+    worker->connections++;
+}
+
+static void *ms_ServerWork(void *arg) {
+    ms_ServerWorker *worker = arg;
+    struct epoll_event events[MS_SERVER_EVENTS];
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        int n = epoll_wait(worker->epoll, events, MS_SERVER_EVENTS, MS_SERVER_POLL_MS);
+        for (int i = 0; i < n; i++) {
+            ms_Conn *conn = events[i].data.ptr;
+            if (!conn) {
+                ms_Accept(worker);
+                continue;
+            }
+            bool open = true;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                open = ms_ConnRead(worker, conn);
+            }
+            if (!open || !ms_ConnFlush(worker, conn)) {
+                ms_ConnClose(worker, conn);
+            }
+        }
+    }
+    while (worker->conns) {
+        ms_ConnClose(worker, worker->conns);
+    }
+    return NULL;
+}
+
+static int ms_Listen(const char *path, int port) {
+    int fd;
+    if (port) {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(port),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        };
+        int one = 1;
+        if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+            bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            return -1;
+        }
+    } else {
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        if (strlen(path) >= sizeof(addr.sun_path)) {
+            return -1;
+        }
+        strcpy(addr.sun_path, path);
+        unlink(path);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            return -1;
+        }
+    }
+    return listen(fd, SOMAXCONN) == 0 ? fd : -1;
+}
+
+static void ms_Usage(const char *name) {
+    fprintf(stderr, "usage: %s [-s socket | -p port] [-t threads]\n", name);
+}
+
+int main(int argc, char **argv) {
+    const char *path = "minesweeper.sock";
+    long port = 0;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:p:t:")) != -1) {
+        switch (opt) {
+            case 's': path = optarg; break;
+            case 'p': port = strtol(optarg, NULL, 0); break;
+            case 't': threads = strtol(optarg, NULL, 0); break;
+            default:
+                ms_Usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc || threads < 1 || threads > MS_SERVER_MAX_THREADS || port < 0 || port > 65535) {
+        ms_Usage(argv[0]);
+        return 1;
+    }
+
+    int listen_fd = ms_Listen(path, port);
+    if (listen_fd < 0) {
+        perror(port ? "listen" : path);
+        return 1;
+    }
+    // the workers start with SIGINT and SIGTERM blocked, so only the main
+    // thread, waiting in sigsuspend, ever takes them
+    struct sigaction action = { .sa_handler = ms_Stop };
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    sigset_t stop_signals, old_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &old_mask);
+
+    static ms_ServerWorker workers[MS_SERVER_MAX_THREADS];
+    for (int i = 0; i < threads; i++) {
+        workers[i].listen_fd = listen_fd;
+        workers[i].epoll = epoll_create1(EPOLL_CLOEXEC);
+        // data.ptr NULL marks the listening socket
+        struct epoll_event event = { .events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = NULL };
+        if (workers[i].epoll < 0 || epoll_ctl(workers[i].epoll, EPOLL_CTL_ADD, listen_fd, &event) != 0) {
+            perror("epoll");
+            return 1;
+        }
+        pthread_create(&workers[i].thread, NULL, ms_ServerWork, &workers[i]);
+    }
+    if (port) {
+        printf("listening on 127.0.0.1:%ld with %ld threads\n", port, threads);
+    } else {
+        printf("listening on %s with %ld threads\n", path, threads);
+    }
+    fflush(stdout);
+
+    while (!atomic_load(&stop)) {
+        sigsuspend(&old_mask);
+    }
+    uint64_t connections = 0, requests = 0, moves = 0, sessions = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        close(workers[i].epoll);
+        connections += workers[i].connections;
+        requests += workers[i].requests;
+        moves += workers[i].moves;
+        sessions += workers[i].sessions;
+    }
+    close(listen_fd);
+    if (!port) {
+        unlink(path);
+    }
+    printf("\n%llu connections, %llu sessions, %llu requests, %llu moves\n",
+           (unsigned long long)connections, (unsigned long long)sessions,
+           (unsigned long long)requests, (unsigned long long)moves);
+    return 0;
+}
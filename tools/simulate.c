@@ -0,0 +1,292 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "minesweeper.h"
+#include "solver.h"
+
+/* Monte Carlo batch simulator.
+ * Plays N games headlessly through the same ms_ClickCell/ms_MarkCell calls the
+ * game uses and reports win rate, mean game length and throughput.
+ *
+ * Game i is fully determined by the base seed and i: the board seed and every
+ * random choice of the strategy come from ms_SplitMix64 of (seed + i). The
+ * totals are sums over games, so they are the same for any thread count.
+ *
+ * Scheduling is range-splitting work stealing: every thread starts with an
+ * equal slice of the game indices and takes games from the front of it. A
+ * thread that runs dry steals the back half of the largest remaining slice.
+ * A slice is one atomic word (begin << 32 | end), so taking and stealing are
+ * a single compare-and-swap each. */
+
+#define MS_SIM_MAX_THREADS 64
+
+typedef enum {
+    ms_STRATEGY_RANDOM,
+    ms_STRATEGY_SOLVER,
+} ms_Strategy;
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t range;
+    pthread_t thread;
+    struct ms_Simulation *sim;
+    int index;
+    // per-thread totals, summed up once all threads are done
+    uint64_t games;
+    uint64_t wins;
+    uint64_t moves;
+    uint64_t checksum;
+    uint64_t steals;
+    double busy;
+} ms_SimWorker;
+
+typedef struct ms_Simulation {
+    int rows;
+    int cols;
+    int mines;
+    uint64_t seed;
+    ms_Strategy strategy;
+    int thread_count;
+    ms_SimWorker workers[MS_SIM_MAX_THREADS];
+} ms_Simulation;
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t ms_Range(uint32_t begin, uint32_t end) {
+    return (uint64_t)begin << 32 | end;
+}
+
+/*Takes the next game from the front of the worker's own slice.*/
+static bool ms_TakeGame(ms_SimWorker *worker, uint32_t *index) {
+    uint64_t range = atomic_load(&worker->range);
+    while ((uint32_t)(range >> 32) < (uint32_t)range) {
+        uint32_t begin = range >> 32;
+        if (atomic_compare_exchange_weak(&worker->range, &range, ms_Range(begin + 1, (uint32_t)range))) {
+            *index = begin;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*Moves the back half of the largest slice of another worker into the thief's
+ * own, empty slice. Returns false once there is nothing left anywhere.*/
+static bool ms_StealGames(ms_Simulation *sim, ms_SimWorker *thief) {
+    for (;;) {
+        ms_SimWorker *victim = NULL;
+        uint64_t victim_range = 0;
+        uint32_t largest = 0;
+        for (int i = 0; i < sim->thread_count; i++) {
+            uint64_t range = atomic_load(&sim->workers[i].range);
+            uint32_t left = (uint32_t)range - (uint32_t)(range >> 32);
+            if ((uint32_t)(range >> 32) < (uint32_t)range && left > largest) {
+                victim = &sim->workers[i];
+                victim_range = range;
+                largest = left;
+            }
+        }
+        if (!victim) {
+            return false;
+        }
+        uint32_t begin = victim_range >> 32;
+        uint32_t end = (uint32_t)victim_range;
+        uint32_t mid = begin + largest / 2;
+        if (atomic_compare_exchange_strong(&victim->range, &victim_range, ms_Range(begin, mid))) {
+            // nobody steals from an empty slice, so a plain store is enough
+            atomic_store(&thief->range, ms_Range(mid, end));
+            thief->steals++;
+            return true;
+        }
+    }
+}
+
+/*Clicks a random cell that is neither revealed nor flagged.*/
+static void ms_RandomClick(ms_Game *game, ms_Rng *rng) {
+    ms_Pos pos;
+    do {
+        pos = ms_PosXY(ms_RngBelow(rng, game->cols), ms_RngBelow(rng, game->rows));
+    } while (!ms_IsHidden(game, pos.x, pos.y));
+    ms_ClickCell(game, &pos);
+}
+
+/*Flags every hidden cell once they all have to be mines; the game is only won
+ * with every mine flagged. Returns the number of flags placed.*/
+static int ms_FlagRest(ms_Game *game) {
+    if (game->mines_left <= 0 || ms_HiddenCount(game) != (size_t)game->mines_left) {
+        return 0;
+    }
+    int flags = 0;
+    for (int y = 0; y < game->rows && game->state == ms_PLAYING; y++) {
+        for (int x = 0; x < game->cols && game->state == ms_PLAYING; x++) {
+            if (ms_IsHidden(game, x, y)) {
+                ms_Pos pos = { .x = x, .y = y };
+                ms_MarkCell(game, &pos);
+                flags++;
+            }
+        }
+    }
+    return flags;
+}
+
+/*Plays game `index` to the end and returns the number of moves it took.
+ * The solver strategy guesses a random cell whenever the solver is stuck.*/
+static uint64_t ms_PlayGame(ms_Simulation *sim, ms_Game *game, ms_Solver *solver, uint32_t index) {
+    uint64_t state = sim->seed + index;
+    uint64_t board_seed = ms_SplitMix64(&state);
+    ms_Rng rng;
+    ms_RngSeed(&rng, ms_SplitMix64(&state));
+
+    ms_InitGame(game, sim->rows, sim->cols, sim->mines, board_seed);
+    if (sim->strategy == ms_STRATEGY_SOLVER) {
+        ms_SolverInit(solver, game);
+    }
+    uint64_t moves = 0;
+    while (game->state == ms_PLAYING) {
+        if (sim->strategy == ms_STRATEGY_SOLVER) {
+            size_t before = solver->stats.moves;
+            if (ms_SolverStep(solver, game)) {
+                moves += solver->stats.moves - before;
+                continue;
+            }
+        }
+        int flags = ms_FlagRest(game);
+        if (flags) {
+            moves += flags;
+            continue;
+        }
+        ms_RandomClick(game, &rng);
+        moves++;
+        if (sim->strategy == ms_STRATEGY_SOLVER) {
+            ms_RevealDelta delta = ms_GameDelta(game);
+            ms_SolverUpdate(solver, game, delta.cells, delta.count);
+        }
+    }
+    return moves;
+}
+
+static void *ms_SimWork(void *arg) {
+    ms_SimWorker *worker = arg;
+    ms_Simulation *sim = worker->sim;
+    ms_Game game = {0};
+    ms_Solver solver = {0};
+
+    double t0 = ms_Now();
+    uint32_t index;
+    while (ms_TakeGame(worker, &index) || (ms_StealGames(sim, worker) && ms_TakeGame(worker, &index))) {
+        uint64_t moves = ms_PlayGame(sim, &game, &solver, index);
+        bool won = game.state == ms_GAME_WON;
+        worker->games++;
+        worker->wins += won;
+        worker->moves += moves;
+        // order independent fingerprint of every game's outcome
+        uint64_t state = index ^ (moves << 32) ^ won;
+        worker->checksum += ms_SplitMix64(&state);
+    }
+    worker->busy = ms_Now() - t0;
+
+    ms_SolverFree(&solver);
+    ms_FreeGame(&game);
+    return NULL;
+}
+
+static void ms_Usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [-d beginner|intermediate|expert|COLSxROWSxMINES] [-n games]\n"
+            "          [-s seed] [-t threads] [-S random|solver]\n", name);
+}
+
+static bool ms_ParseSize(ms_Simulation *sim, const char *arg) {
+    const char *names[] = { "beginner", "intermediate", "expert" };
+    for (ms_Difficulty d = ms_BEGINNER; d < ms_CUSTOM; d++) {
+        if (strcmp(arg, names[d]) == 0) {
+            return ms_DifficultySize(d, &sim->rows, &sim->cols, &sim->mines);
+        }
+    }
+    return sscanf(arg, "%dx%dx%d", &sim->cols, &sim->rows, &sim->mines) == 3;
+}
+
+int main(int argc, char **argv) {
+    ms_Simulation sim = { .seed = 1, .strategy = ms_STRATEGY_SOLVER };
+    ms_DifficultySize(ms_EXPERT, &sim.rows, &sim.cols, &sim.mines);
+    long games = 100000;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:s:t:S:")) != -1) {
+        switch (opt) {
+            case 'd':
+                if (!ms_ParseSize(&sim, optarg)) {
+                    ms_Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'n': games = strtol(optarg, NULL, 0); break;
+            case 's': sim.seed = strtoull(optarg, NULL, 0); break;
+            case 't': threads = strtol(optarg, NULL, 0); break;
+            case 'S':
+                if (strcmp(optarg, "random") == 0) {
+                    sim.strategy = ms_STRATEGY_RANDOM;
+                } else if (strcmp(optarg, "solver") == 0) {
+                    sim.strategy = ms_STRATEGY_SOLVER;
+                } else {
+                    ms_Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                ms_Usage(argv[0]);
+                return 1;
+        }
+    }
+    ms_Game probe = {0};
+    bool valid = ms_InitGame(&probe, sim.rows, sim.cols, sim.mines, 0);
+    ms_FreeGame(&probe);
+    if (!valid || games < 1 || games > UINT32_MAX || threads < 1 || threads > MS_SIM_MAX_THREADS) {
+        ms_Usage(argv[0]);
+        return 1;
+    }
+    sim.thread_count = threads;
+
+    for (int i = 0; i < sim.thread_count; i++) {
+        uint32_t begin = (uint64_t)games * i / sim.thread_count;
+        uint32_t end = (uint64_t)games * (i + 1) / sim.thread_count;
+        atomic_init(&sim.workers[i].range, ms_Range(begin, end));
+        sim.workers[i].sim = &sim;
+        sim.workers[i].index = i;
+    }
+    double t0 = ms_Now();
+    for (int i = 0; i < sim.thread_count; i++) {
+        pthread_create(&sim.workers[i].thread, NULL, ms_SimWork, &sim.workers[i]);
+    }
+    for (int i = 0; i < sim.thread_count; i++) {
+        pthread_join(sim.workers[i].thread, NULL);
+    }
+    double elapsed = ms_Now() - t0;
+
+    uint64_t wins = 0, moves = 0, checksum = 0;
+    printf("%dx%d, %d mines, %s strategy, seed %llu, %ld games, %d threads\n\n",
+           sim.cols, sim.rows, sim.mines, sim.strategy == ms_STRATEGY_SOLVER ? "solver" : "random",
+           (unsigned long long)sim.seed, games, sim.thread_count);
+    printf("%6s %10s %8s %12s\n", "thread", "games", "steals", "games/s");
+    for (int i = 0; i < sim.thread_count; i++) {
+        ms_SimWorker *worker = &sim.workers[i];
+        wins += worker->wins;
+        moves += worker->moves;
+        checksum += worker->checksum;
+        printf("%6d %10llu %8llu %12.0f\n", i, (unsigned long long)worker->games,
+               (unsigned long long)worker->steals, worker->games / worker->busy);
+    }
+    printf("\nwin rate    %.4f (%llu / %ld)\n", (double)wins / games, (unsigned long long)wins, games);
+    printf("mean moves  %.2f\n", (double)moves / games);
+    printf("games/s     %.0f (%.0f per thread)\n", games / elapsed, games / elapsed / sim.thread_count);
+    printf("checksum    %016llx\n", (unsigned long long)checksum);
+    return 0;
+}
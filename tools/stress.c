@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "minesweeper.h"
+
+/* Stress mode for runtime-sized boards.
+ * Generates boards of growing size, opens them with one click in the middle and
+ * then clears every remaining cell, checking the game ends up won. The biggest
+ * board has 4096x4096 = 16M cells, far more than any stack-allocated buffer
+ * could hold. */
+
+typedef struct {
+    int rows;
+    int cols;
+    int mines;
+} ms_StressCase;
+
+static double ms_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool ms_RunStressCase(ms_Game *game, ms_StressCase *sc, uint64_t seed) {
+    double t0 = ms_Now();
+    if (!ms_InitGame(game, sc->rows, sc->cols, sc->mines, seed)) {
+        fprintf(stderr, "could not allocate %dx%d board\n", sc->cols, sc->rows);
+        return false;
+    }
+    ms_Pos first = { .x = sc->cols / 2, .y = sc->rows / 2 };
+    double t1 = ms_Now();
+    ms_InitGameData(game, &first);
+    game->first_click_done = true;
+    double t2 = ms_Now();
+
+    size_t opened = 0;
+    if (ms_RevealCell(game, &first) && ms_ValueAt(game, first.x, first.y) == 0) {
+        opened = ms_ExpandZeros(game, first).count;
+    }
+    double t3 = ms_Now();
+
+    // clear the rest of the board without ever touching a mine
+    for (int y = 0; y < game->rows; y++) {
+        for (int x = 0; x < game->cols; x++) {
+            ms_Pos pos = { .x = x, .y = y };
+            int value = ms_ValueAt(game, x, y);
+            if (value == MINE) {
+                game->mines_left += ms_FlagCell(game, &pos);
+            } else if (ms_RevealCell(game, &pos) && value == 0) {
+                ms_ExpandZeros(game, pos);
+            }
+            ms_ResetDelta(game);
+        }
+    }
+    // the incremental bookkeeping has to agree with a full scan
+    bool won = ms_CheckGameWon(game) && ms_ScanGameWon(game);
+    double t4 = ms_Now();
+
+    printf("%5d x %-5d %9d mines %9.1f MiB | init %8.2f ms | mines %8.2f ms | first click %8.2f ms (%9zu cells) | clear %8.2f ms | %s\n",
+           sc->cols, sc->rows, sc->mines,
+           ms_GameBytes(sc->rows, sc->cols) / (1024.0 * 1024.0),
+           (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t3 - t2) * 1e3, opened, (t4 - t3) * 1e3,
+           won ? "won" : "NOT WON");
+    return won;
+}
+
+int main(int argc, char **argv) {
+    uint64_t seed = argc > 1 ? strtoull(argv[1], NULL, 0) : ms_RngSeedFromTime();
+    printf("seed %llu\n", (unsigned long long)seed);
+
+    ms_StressCase cases[] = {
+        {  1024,  1024,   100000 },
+        {  2048,  2048,   400000 },
+        {  4096,  4096,  1600000 },
+        {  4096,  4096,    20000 },
+        {  4096,  4096,  3000000 },
+    };
+
+    ms_Game game = {0};
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ok = ms_RunStressCase(&game, &cases[i], seed + i) && ok;
+    }
+    ms_FreeGame(&game);
+    return ok ? 0 : 1;
+}
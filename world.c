@@ -0,0 +1,607 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "world.h"
+
+#define MS_STORE_MAGIC       "MSWS"
+#define MS_STORE_VERSION     1
+#define MS_STORE_HEADER_SIZE 16
+// the live records are copied to a fresh store once the stale ones outweigh
+// them and take at least this much
+#define MS_STORE_COMPACT_MIN (1 << 20)
+
+/* Record header in the chunk store, followed by the revealed rows named in
+ * `revealed_rows`, then the flagged rows named in `flagged_rows`, one word
+ * each. Host byte order: the store only lives as long as its world. */
+typedef struct {
+    int32_t cx, cy;
+    uint64_t revealed_rows;
+    uint64_t flagged_rows;
+} ms_ChunkRecord;
+
+#define MS_RECORD_MAX (sizeof(ms_ChunkRecord) + 2 * MS_CHUNK_SIZE * sizeof(uint64_t))
+
+static uint64_t ms_ChunkKey(int cx, int cy) {
+    return (uint64_t)(uint32_t)cx << 32 | (uint32_t)cy;
+}
+
+static uint64_t ms_KeyHash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    return key ^ (key >> 33);
+}
+
+/*Places the mines of chunk (cx, cy): a fixed number per chunk, drawn from a
+ * generator seeded by the world seed and the chunk coordinate, and none in the
+ * 3x3 block of the first click.*/
+static void ms_ChunkMines(const ms_World *world, int cx, int cy, uint64_t mines[MS_CHUNK_SIZE]) {
+    ms_Rng rng;
+    ms_RngSeed(&rng, ms_KeyHash(world->seed ^ ms_KeyHash(ms_ChunkKey(cx, cy))));
+    memset(mines, 0, MS_CHUNK_SIZE * sizeof(uint64_t));
+    for (int placed = 0; placed < world->mines_per_chunk;) {
+        // the top 12 bits pick a cell, taken cells are drawn again
+        uint64_t cell = ms_RngNext(&rng) >> (64 - 2 * MS_CHUNK_SHIFT);
+        uint64_t bit = (uint64_t)1 << (cell & (MS_CHUNK_SIZE - 1));
+        if (!(mines[cell >> MS_CHUNK_SHIFT] & bit)) {
+            mines[cell >> MS_CHUNK_SHIFT] |= bit;
+            placed++;
+        }
+    }
+    if (!world->started) {
+        return;
+    }
+    for (int y = world->start.y - 1; y <= world->start.y + 1; y++) {
+        for (int x = world->start.x - 1; x <= world->start.x + 1; x++) {
+            if (ms_ChunkOf(x) == cx && ms_ChunkOf(y) == cy) {
+                mines[y & (MS_CHUNK_SIZE - 1)] &= ~((uint64_t)1 << (x & (MS_CHUNK_SIZE - 1)));
+            }
+        }
+    }
+}
+
+/*Slot of chunk (cx, cy) in the table, or the empty slot it would go in.*/
+static size_t ms_TableSlot(const ms_World *world, int cx, int cy) {
+    size_t slot = ms_KeyHash(ms_ChunkKey(cx, cy)) & world->table_mask;
+    while (world->table[slot] >= 0) {
+        const ms_Chunk *chunk = &world->chunks[world->table[slot]];
+        if (chunk->cx == cx && chunk->cy == cy) {
+            break;
+        }
+        slot = (slot + 1) & world->table_mask;
+    }
+    return slot;
+}
+
+/*Index of resident chunk (cx, cy), or -1. Leaves the LRU order alone.*/
+static int32_t ms_TableFind(const ms_World *world, int cx, int cy) {
+    return world->table[ms_TableSlot(world, cx, cy)];
+}
+
+/*Empties `slot`, shifting later entries of the probe run back so every
+ * chunk stays reachable from its home slot.*/
+static void ms_TableRemove(ms_World *world, size_t slot) {
+    size_t mask = world->table_mask;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; world->table[next] >= 0; next = (next + 1) & mask) {
+        const ms_Chunk *chunk = &world->chunks[world->table[next]];
+        size_t home = ms_KeyHash(ms_ChunkKey(chunk->cx, chunk->cy)) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            world->table[hole] = world->table[next];
+            hole = next;
+        }
+    }
+    world->table[hole] = -1;
+}
+
+static void ms_LruUnlink(ms_World *world, int32_t index) {
+    ms_Chunk *chunk = &world->chunks[index];
+    if (chunk->prev >= 0) {
+        world->chunks[chunk->prev].next = chunk->next;
+    } else {
+        world->lru_head = chunk->next;
+    }
+    if (chunk->next >= 0) {
+        world->chunks[chunk->next].prev = chunk->prev;
+    } else {
+        world->lru_tail = chunk->prev;
+    }
+}
+
+static void ms_LruPush(ms_World *world, int32_t index) {
+    ms_Chunk *chunk = &world->chunks[index];
+    chunk->prev = -1;
+    chunk->next = world->lru_head;
+    if (world->lru_head >= 0) {
+        world->chunks[world->lru_head].prev = index;
+    } else {
+        world->lru_tail = index;
+    }
+    world->lru_head = index;
+}
+
+/*The three mine bits of row `mid` around column x, with the bits of columns
+ * -1 and 64 in `left` and `right`.*/
+static inline uint64_t ms_ChunkTriple(uint64_t mid, uint64_t left, uint64_t right, int x) {
+    if (x == 0) {
+        return ((mid << 1) | left) & 7;
+    }
+    if (x == MS_CHUNK_SIZE - 1) {
+        return (mid >> (MS_CHUNK_SIZE - 2)) | (right << 2);
+    }
+    return (mid >> (x - 1)) & 7;
+}
+
+/*Counts the mines around every cell of `chunk` and marks its zero cells. The
+ * mines around it come from the neighbouring chunks, resident or generated on
+ * the spot.*/
+static void ms_ChunkCount(ms_World *world, ms_Chunk *chunk) {
+    // rows -1..64 of columns -1 (left), 0..63 (mid) and 64 (right)
+    uint64_t mid[MS_CHUNK_SIZE + 2] = {0};
+    uint64_t left[MS_CHUNK_SIZE + 2] = {0};
+    uint64_t right[MS_CHUNK_SIZE + 2] = {0};
+    uint64_t generated[MS_CHUNK_SIZE];
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            const uint64_t *plane = chunk->mines;
+            if (dx != 0 || dy != 0) {
+                int32_t index = ms_TableFind(world, chunk->cx + dx, chunk->cy + dy);
+                if (index >= 0) {
+                    plane = world->chunks[index].mines;
+                } else {
+                    ms_ChunkMines(world, chunk->cx + dx, chunk->cy + dy, generated);
+                    plane = generated;
+                }
+            }
+            // only the rows of that chunk that touch this one
+            int r0 = dy < 0 ? MS_CHUNK_SIZE - 1 : 0;
+            int r1 = dy > 0 ? 0 : MS_CHUNK_SIZE - 1;
+            for (int r = r0; r <= r1; r++) {
+                int t = r + dy * MS_CHUNK_SIZE + 1;
+                if (dx < 0) {
+                    left[t] = plane[r] >> (MS_CHUNK_SIZE - 1);
+                } else if (dx > 0) {
+                    right[t] = plane[r] & 1;
+                } else {
+                    mid[t] = plane[r];
+                }
+            }
+        }
+    }
+    for (int y = 0; y < MS_CHUNK_SIZE; y++) {
+        uint64_t zeros = 0;
+        for (int x = 0; x < MS_CHUNK_SIZE; x++) {
+            // a mine counts itself, but a mine shows as MINE anyway
+            int count = 0;
+            for (int t = y; t <= y + 2; t++) {
+                count += __builtin_popcountll(ms_ChunkTriple(mid[t], left[t], right[t], x));
+            }
+            chunk->counts[y * MS_CHUNK_SIZE + x] = count;
+            zeros |= (uint64_t)(count == 0) << x;
+        }
+        chunk->zeros[y] = zeros;
+    }
+}
+
+static ms_ChunkRecordRef *ms_IndexFind(ms_World *world, uint64_t key) {
+    size_t mask = world->index_cap - 1;
+    size_t slot = ms_KeyHash(key) & mask;
+    while (world->index[slot].offset && world->index[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+    return &world->index[slot];
+}
+
+/*Slot of `key` in the store index, growing the index to keep it at most half
+ * full. An empty slot has offset 0, which is the store header.*/
+static ms_ChunkRecordRef *ms_IndexInsert(ms_World *world, uint64_t key) {
+    if (2 * (world->index_count + 1) > world->index_cap) {
+        ms_ChunkRecordRef *old = world->index;
+        size_t old_cap = world->index_cap;
+        world->index_cap = old_cap ? 2 * old_cap : 256;
+        world->index = calloc(world->index_cap, sizeof(ms_ChunkRecordRef));
+        assert(world->index && "out of memory");
+        for (size_t i = 0; i < old_cap; i++) {
+            if (old[i].offset) {
+                *ms_IndexFind(world, old[i].key) = old[i];
+            }
+        }
+        free(old);
+    }
+    ms_ChunkRecordRef *ref = ms_IndexFind(world, key);
+    if (!ref->offset) {
+        ref->key = key;
+        world->index_count++;
+    }
+    return ref;
+}
+
+static bool ms_StoreWriteHeader(FILE *store) {
+    uint8_t header[MS_STORE_HEADER_SIZE] = {0};
+    uint32_t version = MS_STORE_VERSION;
+    memcpy(header, MS_STORE_MAGIC, 4);
+    memcpy(header + 4, &version, sizeof(version));
+    return pwrite(fileno(store), header, sizeof(header), 0) == sizeof(header);
+}
+
+/*Copies the live records to a new store and drops the old one.*/
+static void ms_StoreCompact(ms_World *world) {
+    FILE *store = tmpfile();
+    bool ok = store && ms_StoreWriteHeader(store);
+    uint64_t size = MS_STORE_HEADER_SIZE;
+    uint8_t record[MS_RECORD_MAX];
+    for (size_t i = 0; ok && i < world->index_cap; i++) {
+        ms_ChunkRecordRef *ref = &world->index[i];
+        if (!ref->offset) {
+            continue;
+        }
+        ok = pread(fileno(world->store), record, ref->size, ref->offset) == (ssize_t)ref->size &&
+             pwrite(fileno(store), record, ref->size, size) == (ssize_t)ref->size;
+        ref->offset = size;
+        size += ref->size;
+    }
+    assert(ok && "chunk store write failed");
+    fclose(world->store);
+    world->store = store;
+    world->store_size = size;
+    world->stats.compactions++;
+}
+
+/*Appends the revealed and flagged rows of `chunk` to the store and points the
+ * index at them.*/
+static void ms_StoreChunk(ms_World *world, const ms_Chunk *chunk) {
+    uint8_t record[MS_RECORD_MAX];
+    ms_ChunkRecord header = { .cx = chunk->cx, .cy = chunk->cy };
+    uint64_t *words = (uint64_t *)(record + sizeof(header));
+    size_t count = 0;
+    for (int r = 0; r < MS_CHUNK_SIZE; r++) {
+        if (chunk->revealed[r]) {
+            header.revealed_rows |= (uint64_t)1 << r;
+            words[count++] = chunk->revealed[r];
+        }
+    }
+    for (int r = 0; r < MS_CHUNK_SIZE; r++) {
+        if (chunk->flagged[r]) {
+            header.flagged_rows |= (uint64_t)1 << r;
+            words[count++] = chunk->flagged[r];
+        }
+    }
+    memcpy(record, &header, sizeof(header));
+    size_t size = sizeof(header) + count * sizeof(uint64_t);
+    bool ok = pwrite(fileno(world->store), record, size, world->store_size) == (ssize_t)size;
+    assert(ok && "chunk store write failed");
+
+    ms_ChunkRecordRef *ref = ms_IndexInsert(world, ms_ChunkKey(chunk->cx, chunk->cy));
+    if (ref->offset) {
+        world->store_live -= ref->size;
+    }
+    ref->offset = world->store_size;
+    ref->size = size;
+    world->store_size += size;
+    world->store_live += size;
+    world->stats.stored++;
+
+    uint64_t stale = world->store_size - MS_STORE_HEADER_SIZE - world->store_live;
+    if (stale > world->store_live && stale >= MS_STORE_COMPACT_MIN) {
+        ms_StoreCompact(world);
+    }
+}
+
+/*Reads the revealed and flagged rows of `chunk` back from the store. Returns
+ * false if the chunk was never stored.*/
+static bool ms_StoreLoad(ms_World *world, ms_Chunk *chunk) {
+    if (!world->index_cap) {
+        return false;
+    }
+    const ms_ChunkRecordRef *ref = ms_IndexFind(world, ms_ChunkKey(chunk->cx, chunk->cy));
+    if (!ref->offset) {
+        return false;
+    }
+    uint8_t record[MS_RECORD_MAX];
+    bool ok = pread(fileno(world->store), record, ref->size, ref->offset) == (ssize_t)ref->size;
+    assert(ok && "chunk store read failed");
+    ms_ChunkRecord header;
+    memcpy(&header, record, sizeof(header));
+    const uint64_t *words = (const uint64_t *)(record + sizeof(header));
+    for (uint64_t rows = header.revealed_rows; rows; rows &= rows - 1) {
+        chunk->revealed[__builtin_ctzll(rows)] = *words++;
+    }
+    for (uint64_t rows = header.flagged_rows; rows; rows &= rows - 1) {
+        chunk->flagged[__builtin_ctzll(rows)] = *words++;
+    }
+    return true;
+}
+
+/*(Re)initialises `world` as a new endless game, which has to be zeroed or a
+ * world set up before. Returns false if the mine density is out of range or
+ * memory or the chunk store can not be had.*/
+bool ms_WorldInit(ms_World *world, uint64_t seed, int mines_per_chunk, int max_chunks) {
+    if (mines_per_chunk < MS_WORLD_MIN_MINES || mines_per_chunk > MS_WORLD_MAX_MINES || max_chunks < 1) {
+        return false;
+    }
+    ms_WorldFree(world);
+    world->seed = seed;
+    world->mines_per_chunk = mines_per_chunk;
+    world->state = ms_PLAYING;
+    world->max_chunks = max_chunks;
+    world->lru_head = -1;
+    world->lru_tail = -1;
+
+    size_t table_cap = 1;
+    while (table_cap < 2 * (size_t)max_chunks) {
+        table_cap *= 2;
+    }
+    world->table_mask = table_cap - 1;
+    world->chunks = malloc(max_chunks * sizeof(ms_Chunk));
+    world->table = malloc(table_cap * sizeof(int32_t));
+    world->store = tmpfile();
+    if (!world->chunks || !world->table || !world->store || !ms_StoreWriteHeader(world->store)) {
+        ms_WorldFree(world);
+        return false;
+    }
+    memset(world->table, -1, table_cap * sizeof(int32_t));
+    world->store_size = MS_STORE_HEADER_SIZE;
+    return true;
+}
+
+void ms_WorldFree(ms_World *world) {
+    free(world->chunks);
+    free(world->table);
+    free(world->index);
+    free(world->fill);
+    if (world->store) {
+        fclose(world->store);
+    }
+    *world = (ms_World) {0};
+}
+
+/*Heap bytes the world holds: the chunk cache, its table, the store index and
+ * the fill stack. The chunk store itself is on disk.*/
+size_t ms_WorldBytes(const ms_World *world) {
+    return (size_t)world->max_chunks * sizeof(ms_Chunk)
+        + (world->table_mask + 1) * sizeof(int32_t)
+        + world->index_cap * sizeof(ms_ChunkRecordRef)
+        + world->fill_cap * sizeof(ms_ChunkSeeds);
+}
+
+/*Returns chunk (cx, cy), loading it if it is not resident: its mines are
+ * generated and its revealed and flagged planes restored from the store. Makes
+ * room by evicting the least recently used chunk, storing it first if it was
+ * changed. The pointer is valid until the next call that loads a chunk.*/
+ms_Chunk *ms_WorldChunk(ms_World *world, int cx, int cy) {
+    size_t slot = ms_TableSlot(world, cx, cy);
+    int32_t index = world->table[slot];
+    if (index >= 0) {
+        if (index != world->lru_head) {
+            ms_LruUnlink(world, index);
+            ms_LruPush(world, index);
+        }
+        return &world->chunks[index];
+    }
+
+    if (world->chunk_count < world->max_chunks) {
+        index = world->chunk_count++;
+    } else {
+        index = world->lru_tail;
+        ms_Chunk *victim = &world->chunks[index];
+        if (victim->dirty) {
+            ms_StoreChunk(world, victim);
+        } else {
+            world->stats.dropped++;
+        }
+        ms_LruUnlink(world, index);
+        ms_TableRemove(world, ms_TableSlot(world, victim->cx, victim->cy));
+        // removing may have shifted the probe run of the new chunk
+        slot = ms_TableSlot(world, cx, cy);
+    }
+
+    ms_Chunk *chunk = &world->chunks[index];
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->dirty = false;
+    memset(chunk->revealed, 0, sizeof(chunk->revealed));
+    memset(chunk->flagged, 0, sizeof(chunk->flagged));
+    ms_ChunkMines(world, cx, cy, chunk->mines);
+    ms_ChunkCount(world, chunk);
+    if (ms_StoreLoad(world, chunk)) {
+        world->stats.restored++;
+    } else {
+        world->stats.generated++;
+    }
+    world->table[slot] = index;
+    ms_LruPush(world, index);
+    return chunk;
+}
+
+ms_Cell ms_WorldAt(ms_World *world, int x, int y) {
+    const ms_Chunk *chunk = ms_WorldChunk(world, ms_ChunkOf(x), ms_ChunkOf(y));
+    int lx = x & (MS_CHUNK_SIZE - 1);
+    int ly = y & (MS_CHUNK_SIZE - 1);
+    return (ms_Cell) {
+        .value = ms_ChunkValue(chunk, lx, ly),
+        .flagged = (chunk->flagged[ly] >> lx) & 1,
+        .revealed = (chunk->revealed[ly] >> lx) & 1,
+    };
+}
+
+/*Regenerates the resident chunks the first click changed: the ones holding
+ * its 3x3 block lose their mines there, and the counts change one chunk
+ * further out.*/
+static void ms_WorldRebuildStart(ms_World *world) {
+    int x0 = ms_ChunkOf(world->start.x - 2), x1 = ms_ChunkOf(world->start.x + 2);
+    int y0 = ms_ChunkOf(world->start.y - 2), y1 = ms_ChunkOf(world->start.y + 2);
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            int32_t index = ms_TableFind(world, cx, cy);
+            if (index >= 0) {
+                ms_ChunkMines(world, cx, cy, world->chunks[index].mines);
+            }
+        }
+    }
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            int32_t index = ms_TableFind(world, cx, cy);
+            if (index >= 0) {
+                ms_ChunkCount(world, &world->chunks[index]);
+            }
+        }
+    }
+}
+
+static uint64_t *ms_FillPush(ms_World *world, int cx, int cy) {
+    world->fill = ms_Grow(world->fill, &world->fill_cap, world->fill_count + 1, sizeof(ms_ChunkSeeds));
+    ms_ChunkSeeds *item = &world->fill[world->fill_count++];
+    item->cx = cx;
+    item->cy = cy;
+    memset(item->seeds, 0, sizeof(item->seeds));
+    return item->seeds;
+}
+
+/*Queues the cells around the zero cells `zeros` of chunk (cx, cy) that lie in
+ * the neighbouring chunks.*/
+static void ms_FillSpill(ms_World *world, int cx, int cy, const uint64_t zeros[MS_CHUNK_SIZE]) {
+    const int last = MS_CHUNK_SIZE - 1;
+    uint64_t top = zeros[0];
+    uint64_t bottom = zeros[last];
+    // bit r: a zero was opened in column 0 / column 63 of row r
+    uint64_t west = 0, east = 0;
+    for (int r = 0; r < MS_CHUNK_SIZE; r++) {
+        west |= (zeros[r] & 1) << r;
+        east |= (zeros[r] >> last) << r;
+    }
+    if (west) {
+        uint64_t rows = west | (west << 1) | (west >> 1);
+        uint64_t *seeds = ms_FillPush(world, cx - 1, cy);
+        for (; rows; rows &= rows - 1) {
+            seeds[__builtin_ctzll(rows)] = (uint64_t)1 << last;
+        }
+    }
+    if (east) {
+        uint64_t rows = east | (east << 1) | (east >> 1);
+        uint64_t *seeds = ms_FillPush(world, cx + 1, cy);
+        for (; rows; rows &= rows - 1) {
+            seeds[__builtin_ctzll(rows)] = 1;
+        }
+    }
+    if (top) {
+        ms_FillPush(world, cx, cy - 1)[last] = top | (top << 1) | (top >> 1);
+    }
+    if (bottom) {
+        ms_FillPush(world, cx, cy + 1)[0] = bottom | (bottom << 1) | (bottom >> 1);
+    }
+    if (top & 1) {
+        ms_FillPush(world, cx - 1, cy - 1)[last] = (uint64_t)1 << last;
+    }
+    if (top >> last) {
+        ms_FillPush(world, cx + 1, cy - 1)[last] = 1;
+    }
+    if (bottom & 1) {
+        ms_FillPush(world, cx - 1, cy + 1)[0] = (uint64_t)1 << last;
+    }
+    if (bottom >> last) {
+        ms_FillPush(world, cx + 1, cy + 1)[0] = 1;
+    }
+}
+
+/*Opens the hidden, unflagged cells of `seeds` in chunk (cx, cy) and the zero
+ * regions through them, the way ms_ExpandZeros does on a board. Inside a
+ * chunk the region grows a row window at a time until it stops; the zero cells
+ * it opened on the edges then seed the chunks around it, until no chunk has
+ * seeds left.*/
+static void ms_WorldFill(ms_World *world, int cx, int cy, const uint64_t seeds[MS_CHUNK_SIZE]) {
+    memcpy(ms_FillPush(world, cx, cy), seeds, MS_CHUNK_SIZE * sizeof(uint64_t));
+    while (world->fill_count) {
+        ms_ChunkSeeds item = world->fill[--world->fill_count];
+        ms_Chunk *chunk = ms_WorldChunk(world, item.cx, item.cy);
+        uint64_t opened[MS_CHUNK_SIZE];
+        uint64_t front[MS_CHUNK_SIZE];
+        uint64_t any = 0;
+        for (int r = 0; r < MS_CHUNK_SIZE; r++) {
+            opened[r] = item.seeds[r] & ~(chunk->revealed[r] | chunk->flagged[r]);
+            front[r] = opened[r] & chunk->zeros[r];
+            chunk->revealed[r] |= opened[r];
+            any |= opened[r];
+        }
+        if (!any) {
+            continue;
+        }
+        for (uint64_t grown = 1; grown;) {
+            grown = 0;
+            uint64_t above = 0;
+            for (int r = 0; r < MS_CHUNK_SIZE; r++) {
+                uint64_t below = r + 1 < MS_CHUNK_SIZE ? front[r + 1] : 0;
+                uint64_t rows = above | front[r] | below;
+                uint64_t grow = (rows | (rows << 1) | (rows >> 1)) & ~(chunk->revealed[r] | chunk->flagged[r]);
+                chunk->revealed[r] |= grow;
+                opened[r] |= grow;
+                // new zero cells reach the next row in this pass already, the
+                // rest of their block in the next one
+                above = front[r] | (grow & chunk->zeros[r]);
+                front[r] = grow & chunk->zeros[r];
+                grown |= grow;
+            }
+        }
+        size_t count = 0;
+        for (int r = 0; r < MS_CHUNK_SIZE; r++) {
+            count += __builtin_popcountll(opened[r]);
+            opened[r] &= chunk->zeros[r];
+        }
+        world->revealed_count += count;
+        chunk->dirty = true;
+        ms_FillSpill(world, item.cx, item.cy, opened);
+    }
+}
+
+/*Plays a left click on `pos`. The first click of a world fixes its mine-free
+ * start block.*/
+ms_GameState ms_WorldClick(ms_World *world, ms_Pos *pos) {
+    if (world->state != ms_PLAYING) {
+        return world->state;
+    }
+    if (!world->started) {
+        world->start = *pos;
+        world->started = true;
+        ms_WorldRebuildStart(world);
+    }
+    int cx = ms_ChunkOf(pos->x);
+    int cy = ms_ChunkOf(pos->y);
+    int ly = pos->y & (MS_CHUNK_SIZE - 1);
+    uint64_t bit = (uint64_t)1 << (pos->x & (MS_CHUNK_SIZE - 1));
+    ms_Chunk *chunk = ms_WorldChunk(world, cx, cy);
+    if ((chunk->revealed[ly] | chunk->flagged[ly]) & bit) {
+        return world->state;
+    }
+    if (chunk->zeros[ly] & bit) {
+        uint64_t seeds[MS_CHUNK_SIZE] = {0};
+        seeds[ly] = bit;
+        ms_WorldFill(world, cx, cy, seeds);
+        return world->state;
+    }
+    chunk->revealed[ly] |= bit;
+    chunk->dirty = true;
+    world->revealed_count++;
+    if (chunk->mines[ly] & bit) {
+        world->state = ms_GAME_OVER;
+    }
+    return world->state;
+}
+
+/*Plays a right click on `pos`: toggles the flag of a hidden cell.*/
+ms_GameState ms_WorldMark(ms_World *world, ms_Pos *pos) {
+    if (world->state != ms_PLAYING) {
+        return world->state;
+    }
+    int ly = pos->y & (MS_CHUNK_SIZE - 1);
+    uint64_t bit = (uint64_t)1 << (pos->x & (MS_CHUNK_SIZE - 1));
+    ms_Chunk *chunk = ms_WorldChunk(world, ms_ChunkOf(pos->x), ms_ChunkOf(pos->y));
+    if (chunk->revealed[ly] & bit) {
+        return world->state;
+    }
+    chunk->flagged[ly] ^= bit;
+    chunk->dirty = true;
+    world->flag_count += chunk->flagged[ly] & bit ? 1 : -1;
+    return world->state;
+}
@@ -0,0 +1,133 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "minesweeper.h"
+
+/* Endless board, unbounded in every direction.
+ *
+ * The world is cut into chunks of MS_CHUNK_SIZE x MS_CHUNK_SIZE cells, so a
+ * chunk row is one bitplane word. The mines of a chunk come from a hash of the
+ * world seed and the chunk coordinate: a chunk is generated only when it is
+ * revealed or scrolled into view, and generating it again gives the same
+ * mines. The 3x3 block around the first click is kept free of mines, as on a
+ * normal board.
+ *
+ * At most `max_chunks` chunks are resident, found through an open addressing
+ * table and kept in LRU order. When a chunk needs room the least recently used
+ * one goes: a chunk the player never changed is dropped, the seed brings it
+ * back, and a changed one is first written to the chunk store. The store is a
+ * scratch file of records holding only the revealed and flagged rows that are
+ * not empty; loading a chunk reads its planes back from there. So memory stays
+ * bounded by `max_chunks` plus the store index, 24 bytes per changed chunk.
+ *
+ * Clicks and flags work like ms_ClickCell/ms_MarkCell. Zero regions open chunk
+ * by chunk: the zero cells a fill opened on a chunk edge seed the cells around
+ * them in the neighbouring chunks, so a region crosses chunk boundaries like
+ * any other. An endless game can not be won; hitting a mine loses it.
+ *
+ * Cell coordinates are ints. Chunk (cx, cy) holds the cells
+ * [cx * MS_CHUNK_SIZE, (cx + 1) * MS_CHUNK_SIZE) x [cy * ..., (cy + 1) * ...). */
+
+#define MS_CHUNK_SHIFT 6
+#define MS_CHUNK_SIZE  (1 << MS_CHUNK_SHIFT)
+#define MS_CHUNK_CELLS (MS_CHUNK_SIZE * MS_CHUNK_SIZE)
+
+// about the density of an expert board
+#define MS_WORLD_DEFAULT_MINES  800
+// below this the zero cells percolate and a fill would never end
+#define MS_WORLD_MIN_MINES      640
+#define MS_WORLD_MAX_MINES      (MS_CHUNK_CELLS / 2)
+#define MS_WORLD_DEFAULT_CHUNKS 1024
+
+typedef struct {
+    int32_t cx, cy;
+    uint64_t mines[MS_CHUNK_SIZE];
+    uint64_t revealed[MS_CHUNK_SIZE];
+    uint64_t flagged[MS_CHUNK_SIZE];
+    // safe cells without a mine around them
+    uint64_t zeros[MS_CHUNK_SIZE];
+    uint8_t counts[MS_CHUNK_CELLS];
+    // changed since it was loaded or last stored
+    bool dirty;
+    int32_t prev, next;
+} ms_Chunk;
+
+/* Where a changed chunk's latest record sits in the store. */
+typedef struct {
+    uint64_t key;
+    uint64_t offset;
+    uint32_t size;
+} ms_ChunkRecordRef;
+
+/* Zero cells to open in chunk (cx, cy), see ms_WorldFill. */
+typedef struct {
+    int32_t cx, cy;
+    uint64_t seeds[MS_CHUNK_SIZE];
+} ms_ChunkSeeds;
+
+typedef struct {
+    uint64_t generated;
+    uint64_t restored;
+    uint64_t stored;
+    uint64_t dropped;
+    uint64_t compactions;
+} ms_WorldStats;
+
+typedef struct {
+    uint64_t seed;
+    int mines_per_chunk;
+    ms_Pos start;
+    bool started;
+    ms_GameState state;
+    uint64_t revealed_count;
+    int64_t flag_count;
+
+    ms_Chunk *chunks;
+    int chunk_count;
+    int max_chunks;
+    // chunk index per slot, -1 for an empty slot
+    int32_t *table;
+    size_t table_mask;
+    // most recently used first
+    int32_t lru_head;
+    int32_t lru_tail;
+
+    FILE *store;
+    uint64_t store_size;
+    uint64_t store_live;
+    ms_ChunkRecordRef *index;
+    size_t index_count;
+    size_t index_cap;
+
+    ms_ChunkSeeds *fill;
+    size_t fill_count;
+    size_t fill_cap;
+
+    ms_WorldStats stats;
+} ms_World;
+
+bool ms_WorldInit(ms_World *world, uint64_t seed, int mines_per_chunk, int max_chunks);
+void ms_WorldFree(ms_World *world);
+size_t ms_WorldBytes(const ms_World *world);
+
+ms_Chunk *ms_WorldChunk(ms_World *world, int cx, int cy);
+ms_Cell ms_WorldAt(ms_World *world, int x, int y);
+ms_GameState ms_WorldClick(ms_World *world, ms_Pos *pos);
+ms_GameState ms_WorldMark(ms_World *world, ms_Pos *pos);
+
+/*Chunk coordinate of cell coordinate `v`, rounding down for negative cells.*/
+static inline int ms_ChunkOf(int v) {
+    return (v - (v & (MS_CHUNK_SIZE - 1))) / MS_CHUNK_SIZE;
+}
+
+/*Cell value inside a chunk as the game shows it: MINE or the neighbour count.*/
+static inline int ms_ChunkValue(const ms_Chunk *chunk, int lx, int ly) {
+    return (chunk->mines[ly] >> lx) & 1 ? MINE : chunk->counts[ly * MS_CHUNK_SIZE + lx];
+}
+
+#endif // WORLD_H